@@ -1,7 +1,23 @@
+static int32 OutputDitherCVar = 0;
+FAutoConsoleVariableRef CVarOutputDither(
+	TEXT("au.OutputDither"),
+	OutputDitherCVar,
+	TEXT("Adds TPDF dither when converting the final mix to a 16 or 24 bit integer output format.\n")
+	TEXT("0: Off (default), 1: 1 LSB TPDF dither."),
+	ECVF_Default);
+
+static float GetOutputDitherAmount()
+{
+	return OutputDitherCVar > 0 ? 1.0f : 0.0f;
+}
+
 	bool FOutputBuffer::MixNextBuffer()
  	{
+		const int32 NumSamples = RenderBuffer.Num();
+		const uint32 NumOutputBytes = NumSamples * GetSizeForDataFormat(DataFormat);
+
 		// If the circular queue is already full, exit.
-		if (CircularBuffer.Remainder() < static_cast<uint32>(RenderBuffer.Num()))
+		if (CircularBuffer.Remainder() < NumOutputBytes)
 		{
 			return false;
 		}
@@ -15,37 +31,42 @@
 			AudioMixer->OnProcessAudioStream(RenderBuffer);
 		}
 
+		// The output stage writes the final block straight into the circular queue. Unless the queue is mirrored,
+		// the free space can wrap around the end of the queue, in which case the block is staged in FormattedBuffer.
+		TArrayView<uint8> OutputSpan = CircularBuffer.AcquireWrite(NumOutputBytes);
+		const bool bWriteInPlace = OutputSpan.Num() == NumOutputBytes;
+		check(bWriteInPlace || FormattedBuffer.Num() == NumOutputBytes);
+		uint8* OutputData = bWriteInPlace ? OutputSpan.GetData() : FormattedBuffer.GetData();
+
+		const FMixerKernels& Kernels = GetMixerKernels();
+
 		switch (DataFormat)
 		{
 		case EAudioMixerStreamDataFormat::Float:
 		{
-			if (!FMath::IsNearlyEqual(LinearGainScalarForFinalOututCVar, 1.0f))
-			{
-				MultiplyBufferByConstantInPlace(RenderBuffer, LinearGainScalarForFinalOututCVar);
-			}
-			BufferRangeClampFast(RenderBuffer, -1.0f, 1.0f);
-
-			// No conversion is needed, so we push the RenderBuffer directly to the circular queue.
-			CircularBuffer.Push(reinterpret_cast<const uint8*>(RenderBuffer.GetData()), RenderBuffer.Num() * sizeof(float));
+			Kernels.ConvertToFloat(RenderBuffer.GetData(), (float*)OutputData, NumSamples, LinearGainScalarForFinalOututCVar);
 		}
 		break;
 
 		case EAudioMixerStreamDataFormat::Int16:
 		{
-			int16* BufferInt16 = (int16*)FormattedBuffer.GetData();
-			const int32 NumSamples = RenderBuffer.Num();
-			check(FormattedBuffer.Num() / GetSizeForDataFormat(DataFormat) == RenderBuffer.Num());			
-
-			const float ConversionScalar = LinearGainScalarForFinalOututCVar * 32767.0f;
-			MultiplyBufferByConstantInPlace(RenderBuffer, ConversionScalar);
-			BufferRangeClampFast(RenderBuffer, -32767.0f, 32767.0f);
+			// Gain, clamp and conversion happen in a single pass over the render buffer.
+			Kernels.ConvertToInt16(RenderBuffer.GetData(), (int16*)OutputData, NumSamples, LinearGainScalarForFinalOututCVar, GetOutputDitherAmount(), DitherSeed);
+			DitherSeed += NumSamples;
+		}
+		break;
 
-			for (int32 i = 0; i < NumSamples; ++i)
-			{
-				BufferInt16[i] = (int16)RenderBuffer[i];
-			}
+		case EAudioMixerStreamDataFormat::Int24:
+		{
+			Kernels.ConvertToInt24(RenderBuffer.GetData(), OutputData, NumSamples, LinearGainScalarForFinalOututCVar, GetOutputDitherAmount(), DitherSeed);
+			DitherSeed += NumSamples;
+		}
+		break;
 
-			CircularBuffer.Push(reinterpret_cast<const uint8*>(FormattedBuffer.GetData()), FormattedBuffer.Num());
+		case EAudioMixerStreamDataFormat::Int32:
+		{
+			// A float mix has no more than 24 bits of resolution, so there is nothing for dither to do at 32 bits.
+			Kernels.ConvertToInt32(RenderBuffer.GetData(), (int32*)OutputData, NumSamples, LinearGainScalarForFinalOututCVar, 0.0f, 0);
 		}
 		break;
 
@@ -55,6 +76,15 @@
 			break;
 		}
 
+		if (bWriteInPlace)
+		{
+			CircularBuffer.CommitWrite(NumOutputBytes);
+		}
+		else
+		{
+			CircularBuffer.Push(FormattedBuffer.GetData(), NumOutputBytes);
+		}
+
 		static const int32 HeartBeatRate = 500;
 		if ((ExtraAudioMixerDeviceLoggingCVar > 0) && (++CallCounterMixNextBuffer > HeartBeatRate))
 		{
@@ -0,0 +1,175 @@
+#include "audio_mixer_analysis_service.h"
+#include "AudioMixerLog.h"
+#include "HAL/PlatformProcess.h"
+
+namespace Audio
+{
+	namespace AnalysisService
+	{
+		/** How long the analysis thread sleeps between batches. Analysis results are read at most once per game frame, so this only bounds their latency. */
+		static const float PollIntervalSeconds = 0.005f;
+	}
+
+	FSpectrumAnalysisJob::FSpectrumAnalysisJob(const FSpectrumAnalyzerSettings& InSettings, float InSampleRate, int32 InRingBufferFrames)
+		: RingBuffer(FMath::Max(InRingBufferFrames, 1))
+		, Analyzer(InSettings, InSampleRate)
+		, BinWidth(InSampleRate / (float)InSettings.FFTSize)
+		, NumBins((int32)InSettings.FFTSize / 2 + 1)
+		, NumDroppedFrames(0)
+	{
+		// Both result buffers are sized up front so neither side ever reallocates them.
+		for (int32 BufferIndex = 0; BufferIndex < 2; ++BufferIndex)
+		{
+			FSpectrum& Spectrum = Results.GetBufferForInit(BufferIndex);
+			Spectrum.Magnitudes.SetNumZeroed(NumBins);
+			Spectrum.Phases.SetNumZeroed(NumBins);
+		}
+	}
+
+	void FSpectrumAnalysisJob::PushAudio(const float* InAudio, int32 InNumFrames)
+	{
+		if (RingBuffer.Remainder() < (uint32)InNumFrames)
+		{
+			NumDroppedFrames.store(NumDroppedFrames.load(std::memory_order_relaxed) + InNumFrames, std::memory_order_relaxed);
+			return;
+		}
+
+		RingBuffer.Push(InAudio, InNumFrames);
+	}
+
+	bool FSpectrumAnalysisJob::Analyze()
+	{
+		for (;;)
+		{
+			TArrayView<const float> Span = RingBuffer.AcquireRead(RingBuffer.GetCapacity());
+			if (Span.Num() == 0)
+			{
+				break;
+			}
+
+			Analyzer.PushAudio(Span.GetData(), Span.Num());
+			RingBuffer.CommitRead(Span.Num());
+		}
+
+		// Run synchronously: this already is the thread the work was moved to.
+		if (!Analyzer.PerformAnalysisIfPossible(true, false))
+		{
+			return false;
+		}
+
+		FSpectrum& Spectrum = Results.BeginWrite();
+
+		Analyzer.LockOutputBuffer();
+		for (int32 BinIndex = 0; BinIndex < NumBins; ++BinIndex)
+		{
+			const float BinFrequency = BinIndex * BinWidth;
+			Spectrum.Magnitudes[BinIndex] = Analyzer.GetMagnitudeForFrequency(BinFrequency);
+			Spectrum.Phases[BinIndex] = Analyzer.GetPhaseForFrequency(BinFrequency);
+		}
+		Analyzer.UnlockOutputBuffer();
+
+		Results.EndWrite();
+		return true;
+	}
+
+	void FSpectrumAnalysisJob::GetMagnitudesForFrequencies(const TArray<float>& InFrequencies, TArray<float>& OutMagnitudes) const
+	{
+		OutMagnitudes.SetNumUninitialized(InFrequencies.Num());
+
+		Results.Read([this, &InFrequencies, &OutMagnitudes](const FSpectrum& Spectrum)
+		{
+			for (int32 Index = 0; Index < InFrequencies.Num(); ++Index)
+			{
+				const float BinPosition = FMath::Clamp(InFrequencies[Index] / BinWidth, 0.0f, (float)(NumBins - 1));
+				const int32 LowerBin = FMath::Min((int32)BinPosition, NumBins - 2);
+				const float Alpha = BinPosition - LowerBin;
+				OutMagnitudes[Index] = FMath::Lerp(Spectrum.Magnitudes[LowerBin], Spectrum.Magnitudes[LowerBin + 1], Alpha);
+			}
+		});
+	}
+
+	void FSpectrumAnalysisJob::GetPhasesForFrequencies(const TArray<float>& InFrequencies, TArray<float>& OutPhases) const
+	{
+		OutPhases.SetNumUninitialized(InFrequencies.Num());
+
+		// Phase wraps, so it isn't interpolated.
+		Results.Read([this, &InFrequencies, &OutPhases](const FSpectrum& Spectrum)
+		{
+			for (int32 Index = 0; Index < InFrequencies.Num(); ++Index)
+			{
+				const int32 NearestBin = FMath::Clamp(FMath::RoundToInt(InFrequencies[Index] / BinWidth), 0, NumBins - 1);
+				OutPhases[Index] = Spectrum.Phases[NearestBin];
+			}
+		});
+	}
+
+	FMixerAnalysisService::FMixerAnalysisService()
+		: Thread(nullptr)
+		, bStopping(false)
+	{
+	}
+
+	FMixerAnalysisService::~FMixerAnalysisService()
+	{
+		Shutdown();
+	}
+
+	void FMixerAnalysisService::AddJob(const FSpectrumAnalysisJobPtr& InJob)
+	{
+		check(InJob.IsValid());
+
+		{
+			FScopeLock Lock(&JobsCriticalSection);
+			Jobs.AddUnique(InJob);
+		}
+
+		if (!Thread)
+		{
+			bStopping.store(false, std::memory_order_relaxed);
+			Thread = FRunnableThread::Create(this, TEXT("AudioMixerAnalysis"), 0, TPri_BelowNormal);
+		}
+	}
+
+	void FMixerAnalysisService::RemoveJob(const FSpectrumAnalysisJobPtr& InJob)
+	{
+		// Waits for a batch in progress, so the job is no longer in use once this returns.
+		FScopeLock Lock(&JobsCriticalSection);
+		Jobs.Remove(InJob);
+	}
+
+	void FMixerAnalysisService::Shutdown()
+	{
+		if (Thread)
+		{
+			Stop();
+			Thread->WaitForCompletion();
+			delete Thread;
+			Thread = nullptr;
+		}
+
+		FScopeLock Lock(&JobsCriticalSection);
+		Jobs.Reset();
+	}
+
+	uint32 FMixerAnalysisService::Run()
+	{
+		while (!bStopping.load(std::memory_order_acquire))
+		{
+			{
+				FScopeLock Lock(&JobsCriticalSection);
+				for (const FSpectrumAnalysisJobPtr& Job : Jobs)
+				{
+					Job->Analyze();
+				}
+			}
+
+			FPlatformProcess::Sleep(AnalysisService::PollIntervalSeconds);
+		}
+		return 0;
+	}
+
+	void FMixerAnalysisService::Stop()
+	{
+		bStopping.store(true, std::memory_order_release);
+	}
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DSP/SpectrumAnalyzer.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "seqlock.h"
+#include "spsc_circular_buffer.h"
+#include <atomic>
+
+namespace Audio
+{
+	/**
+	 * Spectrum analysis of one submix, run by the FMixerAnalysisService.
+	 *
+	 * The audio render thread pushes the downmixed submix output into a preallocated ring. The
+	 * analysis thread drains the ring into the analyzer, runs the FFT and publishes the magnitude
+	 * and phase of every bin through a lock-free double buffer, which any thread can read.
+	 */
+	class FSpectrumAnalysisJob
+	{
+	public:
+		/**
+		 * @param InSettings Settings of the analyzer.
+		 * @param InSampleRate Sample rate of the analyzed audio.
+		 * @param InRingBufferFrames Frames the ring holds before blocks are dropped.
+		 */
+		FSpectrumAnalysisJob(const FSpectrumAnalyzerSettings& InSettings, float InSampleRate, int32 InRingBufferFrames);
+
+		/** Queues a block of mono audio. Audio render thread only; drops the whole block if the ring is full. */
+		void PushAudio(const float* InAudio, int32 InNumFrames);
+
+		/** Feeds queued audio to the analyzer and publishes new results if an FFT ran. Analysis thread only. */
+		bool Analyze();
+
+		/** Looks up the latest magnitudes, interpolating between bins. Any thread. */
+		void GetMagnitudesForFrequencies(const TArray<float>& InFrequencies, TArray<float>& OutMagnitudes) const;
+
+		/** Looks up the latest phases of the nearest bins. Any thread. */
+		void GetPhasesForFrequencies(const TArray<float>& InFrequencies, TArray<float>& OutPhases) const;
+
+		/** Frames dropped because the analysis thread fell behind. */
+		uint64 GetNumDroppedFrames() const { return NumDroppedFrames.load(std::memory_order_relaxed); }
+
+	private:
+		/** Results of one analysis, one entry per bin. */
+		struct FSpectrum
+		{
+			TArray<float> Magnitudes;
+			TArray<float> Phases;
+		};
+
+		/** Render thread to analysis thread. */
+		TSpscCircularBuffer<float> RingBuffer;
+
+		FSpectrumAnalyzer Analyzer;
+
+		/** Analysis thread to readers. */
+		TLockFreeDoubleBuffer<FSpectrum> Results;
+
+		/** Width of a bin in Hz. */
+		float BinWidth;
+		int32 NumBins;
+
+		std::atomic<uint64> NumDroppedFrames;
+	};
+
+	typedef TSharedPtr<FSpectrumAnalysisJob, ESPMode::ThreadSafe> FSpectrumAnalysisJobPtr;
+
+	/**
+	 * Runs the spectrum analysis of all analyzed submixes of a mixer device on one shared thread.
+	 *
+	 * Each wake-up drains every job's ring and runs the FFTs of all jobs back to back, so the FFT
+	 * cost stays off the audio render thread regardless of how many submixes are analyzed. The
+	 * render thread never touches the service itself, only the rings of the jobs it feeds.
+	 */
+	class FMixerAnalysisService : public FRunnable
+	{
+	public:
+		FMixerAnalysisService();
+		virtual ~FMixerAnalysisService();
+
+		/** Adds a job, starting the analysis thread if it isn't running. Not to be called from the audio render thread. */
+		void AddJob(const FSpectrumAnalysisJobPtr& InJob);
+
+		/** Removes a job. Once this returns, the analysis thread no longer uses it. Not to be called from the audio render thread. */
+		void RemoveJob(const FSpectrumAnalysisJobPtr& InJob);
+
+		/** Stops and joins the analysis thread and drops all jobs. */
+		void Shutdown();
+
+		//~ Begin FRunnable
+		virtual uint32 Run() override;
+		virtual void Stop() override;
+		//~ End FRunnable
+
+	private:
+		/** Jobs added to the service. Guarded by JobsCriticalSection, which the render thread never takes. */
+		TArray<FSpectrumAnalysisJobPtr> Jobs;
+
+		/** Held by the analysis thread while it runs a batch, so RemoveJob can wait for the batch to finish. */
+		FCriticalSection JobsCriticalSection;
+
+		FRunnableThread* Thread;
+		std::atomic<bool> bStopping;
+	};
+}
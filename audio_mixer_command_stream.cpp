@@ -0,0 +1,134 @@
+#include "audio_mixer_command_stream.h"
+
+namespace Audio
+{
+	FMixerParamCommandStream::FMixerParamCommandStream(uint32 InCapacity)
+		: Queue(InCapacity)
+		, NextSequence(0)
+		, OverflowHead(nullptr)
+		, FreeOverflowNodes(nullptr)
+		, bHasOverflow(false)
+	{
+		DequeuedCommands.SetNumUninitialized(DequeueBatchSize);
+		CoalescedCommands.Reserve(MaxCoalesced);
+
+		// Keep the hash table at most half full.
+		HashSlots.Init(INDEX_NONE, FMath::RoundUpToPowerOfTwo(MaxCoalesced * 2));
+		HashMask = HashSlots.Num() - 1;
+	}
+
+	FMixerParamCommandStream::~FMixerParamCommandStream()
+	{
+		for (FOverflowNode* Node : { OverflowHead.load(std::memory_order_acquire), FreeOverflowNodes.load(std::memory_order_acquire) })
+		{
+			while (Node)
+			{
+				FOverflowNode* NextNode = Node->Next;
+				delete Node;
+				Node = NextNode;
+			}
+		}
+	}
+
+	bool FMixerParamCommandStream::Push(uint32 InTargetId, EMixerParam InParam, float InValue, int32 InSampleOffset)
+	{
+		check(InParam < EMixerParam::Count);
+
+		FSequencedCommand Record;
+		FMemory::Memzero(Record);
+		Record.Command.TargetId = InTargetId;
+		Record.Command.SampleOffset = FMath::Max(InSampleOffset, 0);
+		Record.Command.Value = InValue;
+		Record.Command.Param = InParam;
+		Record.Sequence = NextSequence.fetch_add(1, std::memory_order_relaxed);
+
+		if (!bHasOverflow.load(std::memory_order_seq_cst) && Queue.TryEnqueue(Record))
+		{
+			return true;
+		}
+
+		FOverflowNode* Node = AllocateOverflowNode();
+		Node->Record = Record;
+		Node->Next = OverflowHead.load(std::memory_order_relaxed);
+		while (!OverflowHead.compare_exchange_weak(Node->Next, Node, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+		}
+
+		// Only raised after the push, so a pump that clears it before this store still finds the node in the list it takes.
+		bHasOverflow.store(true, std::memory_order_seq_cst);
+		return false;
+	}
+
+	FMixerParamCommandStream::FOverflowNode* FMixerParamCommandStream::AllocateOverflowNode()
+	{
+		FScopeLock Lock(&FreeOverflowNodesLock);
+
+		// The pump only ever pushes, so with a single popper a node's Next can't change under us.
+		FOverflowNode* Node = FreeOverflowNodes.load(std::memory_order_acquire);
+		while (Node && !FreeOverflowNodes.compare_exchange_weak(Node, Node->Next, std::memory_order_acquire, std::memory_order_acquire))
+		{
+		}
+
+		return Node ? Node : new FOverflowNode();
+	}
+
+	void FMixerParamCommandStream::ReleaseOverflowNodes(FOverflowNode* InFirstNode, FOverflowNode* InLastNode)
+	{
+		if (!InFirstNode)
+		{
+			return;
+		}
+
+		InLastNode->Next = FreeOverflowNodes.load(std::memory_order_relaxed);
+		while (!FreeOverflowNodes.compare_exchange_weak(InLastNode->Next, InFirstNode, std::memory_order_release, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	uint32 FMixerParamCommandStream::GetHashSlot(uint32 InTargetId, EMixerParam InParam) const
+	{
+		const uint32 Key = (InTargetId * static_cast<uint32>(EMixerParam::Count)) + static_cast<uint32>(InParam);
+		return (Key * 2654435761U) & HashMask;
+	}
+
+	int32 FMixerParamCommandStream::FindCoalescedIndex(uint32 InTargetId, EMixerParam InParam) const
+	{
+		for (uint32 Slot = GetHashSlot(InTargetId, InParam); HashSlots[Slot] != INDEX_NONE; Slot = (Slot + 1) & HashMask)
+		{
+			const FMixerParamCommand& Command = CoalescedCommands[HashSlots[Slot]].Command;
+			if (Command.TargetId == InTargetId && Command.Param == InParam)
+			{
+				return HashSlots[Slot];
+			}
+		}
+
+		return INDEX_NONE;
+	}
+
+	void FMixerParamCommandStream::AddCoalesced(const FSequencedCommand& InRecord)
+	{
+		uint32 Slot = GetHashSlot(InRecord.Command.TargetId, InRecord.Command.Param);
+		while (HashSlots[Slot] != INDEX_NONE)
+		{
+			Slot = (Slot + 1) & HashMask;
+		}
+
+		HashSlots[Slot] = CoalescedCommands.Add(InRecord);
+	}
+
+	void FMixerParamCommandStream::ResetCoalesced()
+	{
+		// Clearing only the slots we used keeps the reset proportional to the number of pending pairs.
+		for (const FSequencedCommand& Record : CoalescedCommands)
+		{
+			uint32 Slot = GetHashSlot(Record.Command.TargetId, Record.Command.Param);
+			while (HashSlots[Slot] != INDEX_NONE)
+			{
+				HashSlots[Slot] = INDEX_NONE;
+				Slot = (Slot + 1) & HashMask;
+			}
+		}
+
+		CoalescedCommands.Reset();
+	}
+}
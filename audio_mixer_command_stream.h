@@ -0,0 +1,273 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "concurrent_queue.h"
+#include <atomic>
+
+namespace Audio
+{
+	/** Parameters that can be set through a FMixerParamCommandStream. */
+	enum class EMixerParam : uint8
+	{
+		/** Output volume of the target submix. */
+		OutputVolume,
+
+		/** Wet level of the target submix. */
+		WetLevel,
+
+		/** Dry level of the target submix. */
+		DryLevel,
+
+		/** Send level of the target source voice into the submix. */
+		SendLevel,
+
+		Count
+	};
+
+	/**
+	 * A fixed-size, trivially copyable parameter-set record.
+	 *
+	 * Records are what producers push into a FMixerParamCommandStream instead of a heap-allocated closure.
+	 */
+	struct FMixerParamCommand
+	{
+		/** Id of the object the parameter belongs to (the submix id, or the source id for send levels). */
+		uint32 TargetId;
+
+		/** Frame within the next render block at which the new value should start to take effect. */
+		int32 SampleOffset;
+
+		/** The new parameter value. */
+		float Value;
+
+		/** Which parameter to set. */
+		EMixerParam Param;
+
+		uint8 Padding[3];
+	};
+
+	static_assert(sizeof(FMixerParamCommand) == 16, "FMixerParamCommand should stay a 16 byte POD record.");
+
+	/**
+	 * Multiple-producer, single-consumer channel of parameter-set records.
+	 *
+	 * The render thread pumps the stream once per block. Records for the same (target, parameter)
+	 * pair are coalesced so only the latest value is applied, in the order the pairs were first seen.
+	 * Pumping does not allocate.
+	 *
+	 * When the queue is full, records go to a lock-free overflow list instead. Once a record has overflowed,
+	 * every push goes there until the next pump, which takes the whole list and applies it after the queue.
+	 * Every record carries a push sequence number, and coalescing keeps the newer of two records for a pair,
+	 * so a value is never overwritten by an older one that reached the render thread through the other path.
+	 * The render thread never locks, allocates or frees: overflow nodes are recycled for the producers.
+	 */
+	class FMixerParamCommandStream
+	{
+	public:
+
+		/**
+		 * Creates and initializes a new command stream.
+		 *
+		 * @param InCapacity The number of records that can be queued between two pumps (will be rounded up to the next power of 2).
+		 */
+		explicit FMixerParamCommandStream(uint32 InCapacity = DefaultCapacity);
+
+		~FMixerParamCommandStream();
+
+		/**
+		 * Queues a parameter set. Never drops it: if the queue is full, it goes to the overflow list.
+		 *
+		 * @return true if the record was queued, false if it went to the overflow list, which may allocate.
+		 * @note To be called only from producer thread(s).
+		 */
+		bool Push(uint32 InTargetId, EMixerParam InParam, float InValue, int32 InSampleOffset = 0);
+
+		/**
+		 * Drains the stream and applies the latest value of every (target, parameter) pair.
+		 *
+		 * @param ApplyFunction Called as ApplyFunction(const FMixerParamCommand&) once per coalesced record.
+		 * @return The number of records that were applied.
+		 * @note To be called only from the consumer (render) thread.
+		 */
+		template<typename ApplyFunctionType>
+		int32 Pump(ApplyFunctionType&& ApplyFunction)
+		{
+			// Only drain what was queued when the pump started so a busy producer cannot starve the render thread.
+			int32 NumApplied = DrainQueue(Queue.Num(), ApplyFunction);
+
+			if (bHasOverflow.load(std::memory_order_seq_cst))
+			{
+				// Clear the flag before taking the list. A producer sets it after pushing, so one that still sees it
+				// cleared afterwards has its node in this list, and later pushes only go to the queue once the list is taken.
+				bHasOverflow.store(false, std::memory_order_seq_cst);
+				FOverflowNode* OverflowNodes = OverflowHead.exchange(nullptr, std::memory_order_seq_cst);
+
+				// Records a producer queued before it overflowed may have been published since the first drain.
+				NumApplied += DrainQueue(Queue.Num(), ApplyFunction);
+
+				// The list is newest first, so reverse it into push order.
+				FOverflowNode* FirstNode = nullptr;
+				FOverflowNode* LastNode = OverflowNodes;
+				while (OverflowNodes)
+				{
+					FOverflowNode* NextNode = OverflowNodes->Next;
+					OverflowNodes->Next = FirstNode;
+					FirstNode = OverflowNodes;
+					OverflowNodes = NextNode;
+				}
+
+				for (FOverflowNode* Node = FirstNode; Node; Node = Node->Next)
+				{
+					NumApplied += Coalesce(Node->Record, ApplyFunction);
+				}
+
+				ReleaseOverflowNodes(FirstNode, LastNode);
+			}
+
+			NumApplied += ApplyCoalesced(ApplyFunction);
+
+			return NumApplied;
+		}
+
+	private:
+
+		/** Default number of records that can be queued between two pumps. */
+		static const uint32 DefaultCapacity = 1024;
+
+		/** Number of records dequeued per batch while pumping. */
+		static const int32 DequeueBatchSize = 64;
+
+		/** Number of distinct (target, parameter) pairs coalesced before a pump flushes early. */
+		static const int32 MaxCoalesced = 256;
+
+		/** A record and the order it was pushed in. */
+		struct FSequencedCommand
+		{
+			FMixerParamCommand Command;
+			uint32 Sequence;
+		};
+
+		/** A record pushed while the queue was full. */
+		struct FOverflowNode
+		{
+			FSequencedCommand Record;
+			FOverflowNode* Next;
+		};
+
+		/** Dequeues up to InNumToDrain records into the coalesced set. Returns the number of records applied to make room. */
+		template<typename ApplyFunctionType>
+		int32 DrainQueue(uint32 InNumToDrain, ApplyFunctionType&& ApplyFunction)
+		{
+			int32 NumApplied = 0;
+
+			while (InNumToDrain > 0)
+			{
+				const uint32 NumDequeued = Queue.DequeueBatch(DequeuedCommands.GetData(), FMath::Min<uint32>(InNumToDrain, DequeuedCommands.Num()));
+				if (NumDequeued == 0)
+				{
+					break;
+				}
+
+				InNumToDrain -= NumDequeued;
+
+				for (uint32 CommandIndex = 0; CommandIndex < NumDequeued; ++CommandIndex)
+				{
+					NumApplied += Coalesce(DequeuedCommands[CommandIndex], ApplyFunction);
+				}
+			}
+
+			return NumApplied;
+		}
+
+		/** Makes a record the pending value of its pair, unless a newer one is pending. Returns the number of records applied to make room. */
+		template<typename ApplyFunctionType>
+		int32 Coalesce(const FSequencedCommand& InRecord, ApplyFunctionType&& ApplyFunction)
+		{
+			int32 CoalescedIndex = FindCoalescedIndex(InRecord.Command.TargetId, InRecord.Command.Param);
+			if (CoalescedIndex != INDEX_NONE)
+			{
+				// Sequence numbers wrap, so compare their distance.
+				FSequencedCommand& PendingRecord = CoalescedCommands[CoalescedIndex];
+				if ((int32)(InRecord.Sequence - PendingRecord.Sequence) > 0)
+				{
+					PendingRecord = InRecord;
+				}
+				return 0;
+			}
+
+			// Out of room: apply what we have so far. Later records for the same pair are applied after it, so the latest value still wins.
+			int32 NumApplied = 0;
+			if (CoalescedCommands.Num() == MaxCoalesced)
+			{
+				NumApplied = ApplyCoalesced(ApplyFunction);
+			}
+
+			AddCoalesced(InRecord);
+
+			return NumApplied;
+		}
+
+		template<typename ApplyFunctionType>
+		int32 ApplyCoalesced(ApplyFunctionType&& ApplyFunction)
+		{
+			const int32 NumCommands = CoalescedCommands.Num();
+
+			for (const FSequencedCommand& Record : CoalescedCommands)
+			{
+				ApplyFunction(Record.Command);
+			}
+
+			ResetCoalesced();
+
+			return NumCommands;
+		}
+
+		/** Returns the index of the pending record for the given pair, or INDEX_NONE. */
+		int32 FindCoalescedIndex(uint32 InTargetId, EMixerParam InParam) const;
+
+		/** Adds a record for a pair that is not pending yet. */
+		void AddCoalesced(const FSequencedCommand& InRecord);
+
+		/** Clears the pending records and their hash slots without freeing memory. */
+		void ResetCoalesced();
+
+		/** Returns the home hash slot for the given pair. */
+		uint32 GetHashSlot(uint32 InTargetId, EMixerParam InParam) const;
+
+		/** Takes a recycled overflow node, or allocates one. Producers only. */
+		FOverflowNode* AllocateOverflowNode();
+
+		/** Hands a chain of applied overflow nodes back to the producers. Never blocks. */
+		void ReleaseOverflowNodes(FOverflowNode* InFirstNode, FOverflowNode* InLastNode);
+
+		/** Queue between producers and the render thread. */
+		common::router::TBoundedQueue<FSequencedCommand, common::router::EQueueMode::Mpsc> Queue;
+
+		/** Scratch storage for dequeued batches. */
+		TArray<FSequencedCommand> DequeuedCommands;
+
+		/** Latest record per pair, in first-seen order. */
+		TArray<FSequencedCommand> CoalescedCommands;
+
+		/** Open-addressed index from pair to CoalescedCommands entry. */
+		TArray<int32> HashSlots;
+
+		/** Mask for wrapping HashSlots indices. */
+		uint32 HashMask;
+
+		/** Sequence number of the next push. */
+		std::atomic<uint32> NextSequence;
+
+		/** Stack of records pushed while the queue was full, or since, until the next pump takes it whole. */
+		std::atomic<FOverflowNode*> OverflowHead;
+
+		/** Stack of applied overflow nodes, pushed by the pump and popped by producers. */
+		std::atomic<FOverflowNode*> FreeOverflowNodes;
+
+		/** Makes producers the only, one at a time, popper of FreeOverflowNodes, so popping is ABA safe. Never taken by the pump. */
+		FCriticalSection FreeOverflowNodesLock;
+
+		/** Whether records go to the overflow list. Set by producers after pushing to it, cleared by the pump before taking it. */
+		std::atomic<bool> bHasOverflow;
+	};
+}
@@ -1,3 +1,43 @@
+static int32 SubmixParallelRenderCVar = 0;
+FAutoConsoleVariableRef CVarSubmixParallelRender(
+	TEXT("au.Submix.ParallelRender"),
+	SubmixParallelRenderCVar,
+	TEXT("Renders independent submix subtrees in parallel on a work-stealing render thread pool.\n")
+	TEXT("0: Serial (default), >0: Number of pool worker threads in addition to the audio render thread."),
+	ECVF_Default);
+
+static int32 SubmixUseExecutionPlanCVar = 1;
+FAutoConsoleVariableRef CVarSubmixUseExecutionPlan(
+	TEXT("au.Submix.UseExecutionPlan"),
+	SubmixUseExecutionPlanCVar,
+	TEXT("Renders the submix tree from a flat execution plan that is only recompiled when the topology changes.\n")
+	TEXT("0: Recursive rendering (parallel rendering is unavailable), 1: Execution plan (default)."),
+	ECVF_Default);
+
+static int32 OverloadGovernorCVar = 1;
+FAutoConsoleVariableRef CVarOverloadGovernor(
+	TEXT("au.Overload.Governor"),
+	OverloadGovernorCVar,
+	TEXT("Degrades rendering in steps when the render thread gets close to missing its deadline (see au.Overload.*).\n")
+	TEXT("0: Off, 1: On (default). Never applies to non-realtime rendering."),
+	ECVF_Default);
+
+static int32 VoiceVirtualizationCVar = 1;
+FAutoConsoleVariableRef CVarVoiceVirtualization(
+	TEXT("au.Voice.Virtualize"),
+	VoiceVirtualizationCVar,
+	TEXT("Virtualizes inaudible voices, and the quietest voices beyond au.Voice.MaxRealVoices, so they skip decoding, source processing and mixing.\n")
+	TEXT("0: Render every voice, 1: Virtualize (default). Never applies to non-realtime rendering."),
+	ECVF_Default);
+
+static int32 EndpointAsyncWorkersCVar = 1;
+FAutoConsoleVariableRef CVarEndpointAsyncWorkers(
+	TEXT("au.Endpoint.AsyncWorkers"),
+	EndpointAsyncWorkersCVar,
+	TEXT("Delivers the audio of external endpoint submixes on a worker thread per endpoint, so a slow endpoint can't delay the main output (see au.Endpoint.*).\n")
+	TEXT("0: Send to endpoints on the audio render thread, 1: Use endpoint workers (default). Never applies to non-realtime rendering."),
+	ECVF_Default);
+
 bool FMixerDevice::OnProcessAudioStream(AlignedFloatBuffer& Output)
 	{
 		LLM_SCOPE(ELLMTag::AudioMixer);
@@ -5,8 +45,23 @@ bool FMixerDevice::OnProcessAudioStream(AlignedFloatBuffer& Output)
 		// This function could be called in a task manager, which means the thread ID may change between calls.
 		ResetAudioRenderingThreadId();
 
-		// Update the audio render thread time at the head of the render
-		AudioThreadTimingData.AudioRenderThreadTime = FPlatformTime::Seconds() - AudioThreadTimingData.StartTime;
+		// Non-realtime renders have no deadline, and must not degrade.
+		const bool bGovernOverload = OverloadGovernorCVar != 0 && !IsNonRealtime();
+		if (bGovernOverload)
+		{
+			OverloadGovernor.BeginBlock();
+		}
+		else if (OverloadGovernor.GetLevel() != EMixerOverloadLevel::None)
+		{
+			OverloadGovernor.Reset();
+		}
+
+		// Scratch buffers of the previous block are all dead by now.
+		FMixerFrameArena::Get().Reset();
+
+		// Update the audio render thread time at the head of the render. Non-realtime renders run
+		// faster than the wall clock, so they keep time by the audio clock to stay deterministic.
+		AudioThreadTimingData.AudioRenderThreadTime = IsNonRealtime() ? AudioClock : FPlatformTime::Seconds() - AudioThreadTimingData.StartTime;
 
 		// Pump the command queue to the audio render thread
 		PumpCommandQueue();
@@ -14,6 +69,12 @@ bool FMixerDevice::OnProcessAudioStream(AlignedFloatBuffer& Output)
 		// update the clock manager
 		QuantizedEventClockManager.Update(SourceManager->GetNumOutputFrames());
 
+		// Rank the voices by how loud they would be and virtualize the inaudible ones before any of them render.
+		// Non-realtime renders have the time to render every voice.
+		SourceManager->GatherVoiceAudibility(VoiceAudibilityInputs);
+		VoiceAudibility.Update(VoiceAudibilityInputs, VoiceVirtualizationCVar != 0 && !IsNonRealtime(), OverloadGovernor.GetVoiceScale());
+		SourceManager->ApplyVoiceVirtualization(VoiceAudibility);
+
 		// Compute the next block of audio in the source manager
 		SourceManager->ComputeNextBlockOfSamples();
 
@@ -24,13 +85,34 @@ bool FMixerDevice::OnProcessAudioStream(AlignedFloatBuffer& Output)
 			FMixerSubmixPtr MasterSubmixPtr = MasterSubmix.Pin();
 			if (MasterSubmixPtr.IsValid())
 			{
-				// Process the audio output from the master submix
-				MasterSubmixPtr->ProcessAudio(Output);
+				const int32 NumRenderWorkers = FMath::Max(SubmixParallelRenderCVar, 0);
+				if (SubmixRenderThreadPool.GetNumWorkers() != NumRenderWorkers)
+				{
+					SubmixRenderThreadPool.Init(NumRenderWorkers);
+				}
+
+				if (SubmixUseExecutionPlanCVar)
+				{
+					// Process the audio output from the master submix, rendering independent subtrees in parallel if the pool has workers
+					SubmixGraph.Render(MasterSubmixPtr, Output, &SubmixRenderThreadPool);
+				}
+				else
+				{
+					// Release the plan so it doesn't keep removed submixes alive, and recompile when it is used again.
+					SubmixGraph.Reset();
+
+					// Process the audio output from the master submix
+					MasterSubmixPtr->ProcessAudio(Output);
+				}
 			}
 		}
 
 		{
 			CSV_SCOPED_TIMING_STAT(Audio, EndpointSubmixes);
+
+			// Non-realtime renders must deliver every block, and have no deadline to protect.
+			const bool bUseEndpointWorkers = EndpointAsyncWorkersCVar != 0 && !IsNonRealtime();
+
 			FScopeLock ScopeLock(&EndpointSubmixesMutationLock);
 			for (FMixerSubmixPtr& Submix : DefaultEndpointSubmixes)
 			{
@@ -51,7 +133,14 @@ bool FMixerDevice::OnProcessAudioStream(AlignedFloatBuffer& Output)
 				// and it wasn't removed from ExternalEndpointSubmixes.
 				ensure(Submix->IsExternalEndpointSubmix());
 
-				Submix->ProcessAudioAndSendToEndpoint();
+				if (bUseEndpointWorkers)
+				{
+					Submix->ProcessAudioAndQueueForEndpoint();
+				}
+				else
+				{
+					Submix->ProcessAudioAndSendToEndpoint();
+				}
 			}
 		}
 
@@ -67,5 +156,39 @@ bool FMixerDevice::OnProcessAudioStream(AlignedFloatBuffer& Output)
 		// Update the audio clock
 		AudioClock += AudioClockDelta;
 
+		if (bGovernOverload)
+		{
+			OverloadGovernor.EndBlock(GetNumOutputFrames(), GetSampleRate());
+		}
+
 		return true;
 	}
+
+	void FMixerDevice::MarkSubmixGraphDirty()
+	{
+		SubmixGraph.MarkDirty();
+	}
+
+	void FMixerDevice::SubmixTopologyCommand(TFunction<void()> InCommand)
+	{
+		// Only commands that register or unregister submixes go through here, so other commands don't cost a recompile.
+		AudioRenderThreadCommand([this, Command = MoveTemp(InCommand)]()
+		{
+			Command();
+			SubmixGraph.MarkDirty();
+		});
+	}
+
+	void FMixerDevice::UpdateOverloadVoiceScale()
+	{
+		// Game thread. The voice limit belongs to FAudioDevice, so the render thread only publishes the scale.
+		// It publishes level changes and xruns the same way, so they are logged from here.
+		OverloadGovernor.LogChanges();
+
+		const float VoiceScale = OverloadGovernor.GetVoiceScale();
+		if (VoiceScale != AppliedOverloadVoiceScale)
+		{
+			SetMaxChannelsScaled(VoiceScale);
+			AppliedOverloadVoiceScale = VoiceScale;
+		}
+	}
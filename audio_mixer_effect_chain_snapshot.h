@@ -0,0 +1,88 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DSP/Dsp.h"
+#include "Sound/SoundEffectSubmix.h"
+#include "snapshot_publisher.h"
+#include <atomic>
+
+namespace Audio
+{
+	/**
+	 * Fade of one effect chain. Created with its start volume by the writer and only touched by the
+	 * audio render thread after that, so it survives the snapshots that keep the chain without being copied.
+	 */
+	struct FMixerEffectChainFade
+	{
+		explicit FMixerEffectChainFade(float InStartVolume)
+			: FadeVolume(InStartVolume)
+			, AppliedTargetVolume(InStartVolume)
+			, bIsFinished(false)
+		{
+		}
+
+		FDynamicParameter FadeVolume;
+
+		/** Target of the fade in progress, so a snapshot's target is only applied when it changes. */
+		float AppliedTargetVolume;
+
+		/** Set by the render thread once the chain has faded out, so the writer can drop it. */
+		std::atomic<bool> bIsFinished;
+	};
+
+	typedef TSharedPtr<FMixerEffectChainFade, ESPMode::ThreadSafe> FMixerEffectChainFadePtr;
+
+	/** One effect chain of a submix, as published in an effect chain snapshot. */
+	struct FSubmixEffectFadeInfo
+	{
+		FSubmixEffectFadeInfo()
+			: FadeTargetVolume(1.0f)
+			, FadeTimeSec(0.0f)
+			, bIsCurrentChain(false)
+			, bIsBaseEffect(false)
+		{
+		}
+
+		TArray<FSoundEffectSubmixPtr> EffectChain;
+
+		/** Render side fade state, shared with the previous and next snapshots holding this chain. */
+		FMixerEffectChainFadePtr Fade;
+
+		/** Volume the chain fades to, and how long it takes from when the render thread sees the snapshot. */
+		float FadeTargetVolume;
+		float FadeTimeSec;
+
+		bool bIsCurrentChain;
+		bool bIsBaseEffect;
+
+		/** Fades the chain to the given volume, keeping its current fade state. Writer only, on a copy in the next snapshot. */
+		void FadeTo(float InTargetVolume, float InFadeTimeSec)
+		{
+			FadeTargetVolume = InTargetVolume;
+			FadeTimeSec = InFadeTimeSec;
+		}
+
+		/** Makes a chain that starts at the given volume. */
+		static FSubmixEffectFadeInfo Create(const TArray<FSoundEffectSubmixPtr>& InEffectChain, float InStartVolume, bool bInIsBaseEffect)
+		{
+			FSubmixEffectFadeInfo FadeInfo;
+			FadeInfo.EffectChain = InEffectChain;
+			FadeInfo.Fade = MakeShared<FMixerEffectChainFade, ESPMode::ThreadSafe>(InStartVolume);
+			FadeInfo.FadeTargetVolume = InStartVolume;
+			FadeInfo.bIsCurrentChain = true;
+			FadeInfo.bIsBaseEffect = bInIsBaseEffect;
+			return FadeInfo;
+		}
+	};
+
+	/**
+	 * Immutable set of effect chains of a submix, in processing order. The render thread iterates
+	 * it without locking; every change publishes a new snapshot.
+	 */
+	struct FMixerEffectChainSnapshot
+	{
+		TArray<FSubmixEffectFadeInfo> Chains;
+	};
+
+	typedef TSnapshotPublisher<FMixerEffectChainSnapshot> FMixerEffectChainPublisher;
+}
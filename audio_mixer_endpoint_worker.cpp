@@ -0,0 +1,210 @@
+#include "audio_mixer_endpoint_worker.h"
+#include "audio_mixer_kernels.h"
+
+static float EndpointLatencyBudgetMsCVar = 60.0f;
+FAutoConsoleVariableRef CVarEndpointLatencyBudgetMs(
+	TEXT("au.Endpoint.LatencyBudgetMs"),
+	EndpointLatencyBudgetMsCVar,
+	TEXT("Audio an external endpoint's worker may fall behind the main output before blocks are dropped, in milliseconds (default: 60).\n")
+	TEXT("Drift compensation keeps half of it queued at the endpoint. Read when the endpoint's worker starts."),
+	ECVF_Default);
+
+static int32 EndpointDriftCompensationCVar = 1;
+FAutoConsoleVariableRef CVarEndpointDriftCompensation(
+	TEXT("au.Endpoint.DriftCompensation"),
+	EndpointDriftCompensationCVar,
+	TEXT("Resamples external endpoint audio slightly faster or slower to follow the endpoint's clock.\n")
+	TEXT("0: Off, 1: On (default). Only applies to endpoints that report how much audio they have queued."),
+	ECVF_Default);
+
+static int32 EndpointMaxDriftCorrectionPpmCVar = 1000;
+FAutoConsoleVariableRef CVarEndpointMaxDriftCorrectionPpm(
+	TEXT("au.Endpoint.MaxDriftCorrectionPpm"),
+	EndpointMaxDriftCorrectionPpmCVar,
+	TEXT("Largest resampling ratio adjustment drift compensation makes, in parts per million (default: 1000, at most 10000)."),
+	ECVF_Default);
+
+namespace Audio
+{
+	namespace EndpointWorker
+	{
+		/** How quickly the smoothed endpoint queue follows the reported one, per delivered block. Endpoints report it in whole callbacks, so it jumps around. */
+		static const float QueueSmoothing = 0.05f;
+
+		/** Ratio correction per unit of relative queue error. A queue off by its whole target is corrected by 1000 ppm. */
+		static const double ProportionalGain = 0.001;
+
+		/** Added to the integral correction per block and unit of relative queue error; removes the steady offset a constant drift leaves. */
+		static const double IntegralGain = 0.00001;
+	}
+
+	FMixerEndpointWorker::FMixerEndpointWorker(TUniquePtr<IMixerEndpointSink> InSink, const FMixerEndpointWorkerSettings& InSettings)
+		: Sink(MoveTemp(InSink))
+		, Settings(InSettings)
+		, EndpointSampleRate(0)
+		, MaxQueuedSamples(0)
+		, bWasResampling(false)
+		, TargetQueuedFrames(0.0f)
+		, SmoothedQueuedFrames(0.0f)
+		, DriftIntegral(0.0)
+		, WakeEvent(FPlatformProcess::GetSynchEventFromPool(false))
+		, Thread(nullptr)
+		, bStopping(false)
+	{
+		check(Sink.IsValid());
+		check(Settings.NumChannels > 0 && Settings.DeviceSampleRate > 0 && Settings.MaxFramesPerBlock > 0);
+
+		EndpointSampleRate = Sink->GetSampleRate();
+
+		// Everything is allocated here, so neither thread allocates while the endpoint runs.
+		// The ring holds at least two blocks, so a block can be queued while the worker still reads the last one.
+		const float LatencyBudgetSeconds = FMath::Max(EndpointLatencyBudgetMsCVar, 1.0f) / 1000.0f;
+		const int32 MaxQueuedFrames = FMath::Max(FMath::CeilToInt(LatencyBudgetSeconds * Settings.DeviceSampleRate), 2 * Settings.MaxFramesPerBlock);
+		MaxQueuedSamples = MaxQueuedFrames * Settings.NumChannels;
+		RingBuffer.SetCapacity(MaxQueuedSamples, true);
+
+		TargetQueuedFrames = 0.5f * LatencyBudgetSeconds * EndpointSampleRate;
+		SmoothedQueuedFrames = TargetQueuedFrames;
+
+		// The resampler is set up even at equal rates, because drift compensation needs it too.
+		Resampler.Init(Settings.NumChannels, Settings.DeviceSampleRate, EndpointSampleRate, Settings.MaxFramesPerBlock);
+		InputBlock.SetNumZeroed(Settings.MaxFramesPerBlock * Settings.NumChannels);
+		OutputBlock.SetNumZeroed(Resampler.GetMaxOutputFrames(Settings.MaxFramesPerBlock) * Settings.NumChannels);
+
+		Thread = FRunnableThread::Create(this, TEXT("AudioMixerEndpointWorker"), 0, TPri_AboveNormal);
+	}
+
+	FMixerEndpointWorker::~FMixerEndpointWorker()
+	{
+		if (Thread)
+		{
+			Stop();
+			Thread->WaitForCompletion();
+			delete Thread;
+			Thread = nullptr;
+		}
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	}
+
+	void FMixerEndpointWorker::QueueBlock(const float* InAudio, int32 InNumFrames, int32 InNumChannels)
+	{
+		const uint32 NumSamples = InNumFrames * InNumChannels;
+
+		// Only whole blocks are dropped, so the worker never loses its channel alignment.
+		if (InNumChannels != Settings.NumChannels || RingBuffer.Num() + NumSamples > MaxQueuedSamples)
+		{
+			FMixerEndpointCounters::Increment(Counters.NumBlocksDropped);
+			return;
+		}
+
+		RingBuffer.Push(InAudio, NumSamples);
+		FMixerEndpointCounters::Increment(Counters.NumBlocksQueued);
+		WakeEvent->Trigger();
+	}
+
+	uint32 FMixerEndpointWorker::Run()
+	{
+		while (true)
+		{
+			WakeEvent->Wait();
+
+			if (bStopping.load(std::memory_order_acquire))
+			{
+				break;
+			}
+
+			ProcessQueuedAudio();
+		}
+
+		return 0;
+	}
+
+	void FMixerEndpointWorker::Stop()
+	{
+		bStopping.store(true, std::memory_order_release);
+		WakeEvent->Trigger();
+	}
+
+	void FMixerEndpointWorker::ProcessQueuedAudio()
+	{
+		const FMixerKernels& Kernels = GetMixerKernels();
+		const int32 NumChannels = Settings.NumChannels;
+
+		for (;;)
+		{
+			// The render thread pushes whole blocks, but a push can be published in two spans, so only take whole frames.
+			const int32 NumFrames = FMath::Min<int32>(RingBuffer.Num() / NumChannels, Settings.MaxFramesPerBlock);
+			if (NumFrames == 0)
+			{
+				break;
+			}
+			const uint32 NumSamples = NumFrames * NumChannels;
+
+			// A mirrored ring hands out the whole block in place. Otherwise a block that wraps around the end is copied out.
+			TArrayView<const float> InputSpan = RingBuffer.AcquireRead(NumSamples);
+			const bool bReadInPlace = InputSpan.Num() == NumSamples;
+			if (!bReadInPlace)
+			{
+				RingBuffer.Pop(InputBlock.GetData(), NumSamples);
+			}
+			const float* Input = bReadInPlace ? InputSpan.GetData() : InputBlock.GetData();
+
+			const bool bCompensateDrift = UpdateDriftCorrection();
+			if (bCompensateDrift || EndpointSampleRate != Settings.DeviceSampleRate)
+			{
+				if (!bWasResampling)
+				{
+					Resampler.Reset();
+					bWasResampling = true;
+				}
+
+				const int32 NumOutputFrames = Resampler.Process(Kernels, Input, NumFrames, OutputBlock.GetData());
+
+				// The resampler keeps its own history, so the block can go back to the render thread before the sink, which may block, has it.
+				if (bReadInPlace)
+				{
+					RingBuffer.CommitRead(NumSamples);
+				}
+
+				Sink->SendAudio(OutputBlock.GetData(), NumOutputFrames, NumChannels);
+				FMixerEndpointCounters::Increment(Counters.NumFramesSent, NumOutputFrames);
+			}
+			else
+			{
+				bWasResampling = false;
+				Sink->SendAudio(Input, NumFrames, NumChannels);
+				if (bReadInPlace)
+				{
+					RingBuffer.CommitRead(NumSamples);
+				}
+				FMixerEndpointCounters::Increment(Counters.NumFramesSent, NumFrames);
+			}
+		}
+	}
+
+	bool FMixerEndpointWorker::UpdateDriftCorrection()
+	{
+		const int32 NumQueuedFrames = Sink->GetNumQueuedFrames();
+		if (EndpointDriftCompensationCVar == 0 || NumQueuedFrames == INDEX_NONE)
+		{
+			// Start over from the nominal ratio if compensation resumes.
+			SmoothedQueuedFrames = TargetQueuedFrames;
+			DriftIntegral = 0.0;
+			Resampler.SetRatioCorrection(0.0);
+			Counters.DriftCorrectionPpm.store(0, std::memory_order_relaxed);
+			return false;
+		}
+
+		SmoothedQueuedFrames += (NumQueuedFrames - SmoothedQueuedFrames) * EndpointWorker::QueueSmoothing;
+
+		// More queued than the target means the endpoint plays slower than the mix produces, so consume input faster and send fewer frames.
+		const double QueueError = (SmoothedQueuedFrames - TargetQueuedFrames) / TargetQueuedFrames;
+		const double MaxCorrection = FMath::Min(FMath::Max(EndpointMaxDriftCorrectionPpmCVar, 0), 10000) * 1.0e-6;
+		DriftIntegral = FMath::Clamp(DriftIntegral + QueueError * EndpointWorker::IntegralGain, -MaxCorrection, MaxCorrection);
+		const double Correction = FMath::Clamp(QueueError * EndpointWorker::ProportionalGain + DriftIntegral, -MaxCorrection, MaxCorrection);
+
+		Resampler.SetRatioCorrection(Correction);
+		Counters.DriftCorrectionPpm.store(FMath::RoundToInt((float)(Correction * 1.0e6)), std::memory_order_relaxed);
+		return true;
+	}
+}
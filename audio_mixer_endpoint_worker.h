@@ -0,0 +1,136 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "audio_mixer_resampler.h"
+#include "spsc_circular_buffer.h"
+#include <atomic>
+
+namespace Audio
+{
+	/** Where an endpoint worker delivers its audio, e.g. an adapter around an external audio endpoint. */
+	class IMixerEndpointSink
+	{
+	public:
+		virtual ~IMixerEndpointSink() = default;
+
+		/** The rate the endpoint plays audio at. Read once, when the worker starts. */
+		virtual int32 GetSampleRate() const = 0;
+
+		/**
+		 * Frames handed to the endpoint that it hasn't played yet, or INDEX_NONE if it can't tell. Called on the
+		 * worker thread before each delivery; drift compensation holds this at its target.
+		 */
+		virtual int32 GetNumQueuedFrames() const = 0;
+
+		/** Delivers interleaved audio at the endpoint's rate. Called on the worker thread, and allowed to block. */
+		virtual void SendAudio(const float* InAudio, int32 InNumFrames, int32 InNumChannels) = 0;
+	};
+
+	/** Format of the audio the render thread queues for an endpoint. */
+	struct FMixerEndpointWorkerSettings
+	{
+		int32 NumChannels = 0;
+		int32 DeviceSampleRate = 0;
+
+		/** Largest block QueueBlock is called with. */
+		int32 MaxFramesPerBlock = 0;
+	};
+
+	/** Counters of an endpoint worker, readable from any thread. */
+	struct FMixerEndpointCounters
+	{
+		std::atomic<uint64> NumBlocksQueued { 0 };
+
+		/** Blocks the render thread dropped because the worker was a full latency budget behind, or the channel count changed. */
+		std::atomic<uint64> NumBlocksDropped { 0 };
+
+		/** Frames delivered to the endpoint, at its rate. */
+		std::atomic<uint64> NumFramesSent { 0 };
+
+		/** The ratio correction drift compensation currently applies, in parts per million. */
+		std::atomic<int32> DriftCorrectionPpm { 0 };
+
+		static void Increment(std::atomic<uint64>& InCounter, uint64 InAmount = 1)
+		{
+			InCounter.store(InCounter.load(std::memory_order_relaxed) + InAmount, std::memory_order_relaxed);
+		}
+	};
+
+	/**
+	 * Runs an external endpoint submix's delivery on its own thread, so a slow endpoint (a controller
+	 * speaker, a capture sink) never holds up the main output.
+	 *
+	 * The audio render thread still renders the endpoint submix, then copies the block into a lock-free
+	 * ring sized to the latency budget (au.Endpoint.LatencyBudgetMs) and wakes the worker; it never waits.
+	 * If the worker falls a whole budget behind, the block is dropped and counted. The worker converts
+	 * the audio to the endpoint's sample rate with a polyphase resampler and hands it to the sink.
+	 *
+	 * The device and the endpoint run on different clocks, so even at equal nominal rates the endpoint
+	 * plays slightly faster or slower than the mix produces. Drift compensation watches how much audio
+	 * is queued at the endpoint and nudges the resampling ratio by up to au.Endpoint.MaxDriftCorrectionPpm
+	 * to keep it at half the latency budget, instead of letting the queue run dry or overflow.
+	 */
+	class FMixerEndpointWorker : public FRunnable
+	{
+	public:
+		/** Allocates the ring and the resampler and starts the worker thread. */
+		FMixerEndpointWorker(TUniquePtr<IMixerEndpointSink> InSink, const FMixerEndpointWorkerSettings& InSettings);
+		virtual ~FMixerEndpointWorker();
+
+		/**
+		 * Queues a block of interleaved audio at the device rate and wakes the worker. Audio render thread only.
+		 * Never allocates or blocks; drops the whole block if the ring is full or the channel count doesn't match.
+		 */
+		void QueueBlock(const float* InAudio, int32 InNumFrames, int32 InNumChannels);
+
+		const FMixerEndpointWorkerSettings& GetSettings() const { return Settings; }
+		const FMixerEndpointCounters& GetCounters() const { return Counters; }
+
+		//~ Begin FRunnable
+		virtual uint32 Run() override;
+		virtual void Stop() override;
+		//~ End FRunnable
+
+	private:
+		/** Converts and delivers everything in the ring. Worker thread only. */
+		void ProcessQueuedAudio();
+
+		/** Updates the resampling ratio from the endpoint's queue. Returns false if drift isn't being compensated. Worker thread only. */
+		bool UpdateDriftCorrection();
+
+		TUniquePtr<IMixerEndpointSink> Sink;
+		FMixerEndpointWorkerSettings Settings;
+		int32 EndpointSampleRate;
+
+		/** Render thread to worker thread. Mirrored where supported, so the worker reads every block in place. */
+		TSpscCircularBuffer<float> RingBuffer;
+
+		/** The latency budget in samples. The ring's capacity is rounded up to a power of two, so blocks are dropped against this instead. */
+		uint32 MaxQueuedSamples;
+
+		/** Worker thread staging: a block that wrapped around the end of an unmirrored ring, and the resampled block. */
+		TArray<float> InputBlock;
+		TArray<float> OutputBlock;
+
+		FMixerPolyphaseResampler Resampler;
+
+		/** Whether the last block went through the resampler, so it restarts clean after blocks that bypassed it. */
+		bool bWasResampling;
+
+		/** Endpoint frames drift compensation keeps queued: half the latency budget. */
+		float TargetQueuedFrames;
+
+		/** Drift compensation state. Worker thread only. */
+		float SmoothedQueuedFrames;
+		double DriftIntegral;
+
+		FMixerEndpointCounters Counters;
+
+		FEvent* WakeEvent;
+		FRunnableThread* Thread;
+		std::atomic<bool> bStopping;
+	};
+}
@@ -0,0 +1,81 @@
+#include "audio_mixer_envelope_follower.h"
+#include "audio_mixer_kernels.h"
+
+namespace Audio
+{
+	namespace EnvelopeFollower
+	{
+		/** Analog ballistics reach 1 - 1/e of a step within the attack or release time, digital ones reach 99%. */
+		static const float AnalogTimeConstant = 1.0f;
+		static const float DigitalTimeConstant = 4.60517019f;
+	}
+
+	FMultichannelEnvelopeFollower::FMultichannelEnvelopeFollower()
+		: NumChannels(0)
+		, ChannelKernels(nullptr)
+		, SampleRate(48000.0f)
+		, AttackCoefficient(0.0f)
+		, ReleaseCoefficient(0.0f)
+		, Mode(EMixerEnvelopeMode::Peak)
+		, bIsAnalog(true)
+	{
+		Reset();
+	}
+
+	void FMultichannelEnvelopeFollower::Init(float InSampleRate, int32 InAttackTimeMsec, int32 InReleaseTimeMsec, EMixerEnvelopeMode InMode, bool bInIsAnalog)
+	{
+		SampleRate = InSampleRate;
+		Mode = InMode;
+		bIsAnalog = bInIsAnalog;
+		AttackCoefficient = GetCoefficient(InAttackTimeMsec);
+		ReleaseCoefficient = GetCoefficient(InReleaseTimeMsec);
+
+		Reset();
+	}
+
+	void FMultichannelEnvelopeFollower::Reset()
+	{
+		FMemory::Memzero(Envelopes, sizeof(Envelopes));
+		NumChannels = 0;
+
+		FMixerEnvelopeValues ZeroValues;
+		FMemory::Memzero(&ZeroValues, sizeof(ZeroValues));
+		PublishedValues.Write(ZeroValues);
+	}
+
+	float FMultichannelEnvelopeFollower::GetCoefficient(int32 InTimeMsec) const
+	{
+		if (InTimeMsec <= 0)
+		{
+			return 0.0f;
+		}
+
+		const float TimeConstant = bIsAnalog ? EnvelopeFollower::AnalogTimeConstant : EnvelopeFollower::DigitalTimeConstant;
+		return FMath::Exp(-1000.0f * TimeConstant / ((float)InTimeMsec * SampleRate));
+	}
+
+	void FMultichannelEnvelopeFollower::ProcessAudio(const float* InBuffer, int32 InNumFrames, int32 InNumChannels)
+	{
+		check(InNumChannels <= AUDIO_MIXER_MAX_OUTPUT_CHANNELS);
+
+		// The channels mean something else after a layout change, so start over.
+		if (InNumChannels != NumChannels || !ChannelKernels)
+		{
+			FMemory::Memzero(Envelopes, sizeof(Envelopes));
+			NumChannels = InNumChannels;
+			ChannelKernels = &GetMixerChannelKernels(NumChannels);
+		}
+
+		const bool bMeanSquared = Mode == EMixerEnvelopeMode::RootMeanSquare;
+		ChannelKernels->FollowEnvelope(InBuffer, InNumFrames, NumChannels, Envelopes, AttackCoefficient, ReleaseCoefficient, bMeanSquared);
+
+		FMixerEnvelopeValues NewValues;
+		for (int32 Channel = 0; Channel < AUDIO_MIXER_MAX_OUTPUT_CHANNELS; ++Channel)
+		{
+			NewValues.Values[Channel] = Channel < NumChannels ? (bMeanSquared ? FMath::Sqrt(Envelopes[Channel]) : Envelopes[Channel]) : 0.0f;
+		}
+		NewValues.NumChannels = NumChannels;
+
+		PublishedValues.Write(NewValues);
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AudioMixer.h"
+#include "seqlock.h"
+
+namespace Audio
+{
+	struct FMixerChannelKernels;
+
+	/** What a submix envelope follower measures. */
+	enum class EMixerEnvelopeMode : uint8
+	{
+		/** Follows the absolute sample value. */
+		Peak,
+
+		/** Follows the mean square and reports its square root. */
+		RootMeanSquare
+	};
+
+	/** Envelope values of every channel of a submix, as published to readers. */
+	struct FMixerEnvelopeValues
+	{
+		float Values[AUDIO_MIXER_MAX_OUTPUT_CHANNELS];
+		int32 NumChannels;
+	};
+
+	/**
+	 * Envelope follower for all channels of an interleaved submix buffer.
+	 *
+	 * Processing runs the FollowEnvelope channel kernel for the current layout, looked up when the
+	 * channel count changes, which updates a vector of channels per frame instead of striding over
+	 * the buffer once per channel. After each block the values are published through a seqlock, so
+	 * readers on other threads never block the audio render thread and never contend with each other.
+	 */
+	class FMultichannelEnvelopeFollower
+	{
+	public:
+		FMultichannelEnvelopeFollower();
+
+		/** Sets the ballistics and resets the envelopes. Audio render thread only. */
+		void Init(float InSampleRate, int32 InAttackTimeMsec, int32 InReleaseTimeMsec, EMixerEnvelopeMode InMode = EMixerEnvelopeMode::Peak, bool bInIsAnalog = true);
+
+		/** Resets the envelopes to zero. Audio render thread only. */
+		void Reset();
+
+		/** Processes a block of interleaved audio and publishes the new values. Audio render thread only. */
+		void ProcessAudio(const float* InBuffer, int32 InNumFrames, int32 InNumChannels);
+
+		/** Returns the last published values. Any thread; never blocks the render thread. */
+		FMixerEnvelopeValues GetEnvelopeValues() const
+		{
+			return PublishedValues.Read();
+		}
+
+	private:
+		/** Returns the one-pole coefficient for the given time constant. */
+		float GetCoefficient(int32 InTimeMsec) const;
+
+		/** Follower state, one value per channel (mean squares in RootMeanSquare mode). */
+		float Envelopes[AUDIO_MIXER_MAX_OUTPUT_CHANNELS];
+		int32 NumChannels;
+
+		/** Kernels for NumChannels, or nullptr before the first block. */
+		const FMixerChannelKernels* ChannelKernels;
+
+		float SampleRate;
+		float AttackCoefficient;
+		float ReleaseCoefficient;
+		EMixerEnvelopeMode Mode;
+		bool bIsAnalog;
+
+		TSeqLock<FMixerEnvelopeValues> PublishedValues;
+	};
+}
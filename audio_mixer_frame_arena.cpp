@@ -0,0 +1,76 @@
+#include "audio_mixer_frame_arena.h"
+
+static int32 FrameArenaInitialSizeKBCVar = 256;
+FAutoConsoleVariableRef CVarFrameArenaInitialSizeKB(
+	TEXT("au.FrameArena.InitialSizeKB"),
+	FrameArenaInitialSizeKBCVar,
+	TEXT("Initial size of each render thread's scratch arena, in kilobytes. Arenas grow to the peak they see (default: 256)."),
+	ECVF_Default);
+
+namespace Audio
+{
+	FMixerFrameArena::FMixerFrameArena(SIZE_T InCapacity)
+		: Block(nullptr)
+		, Capacity(Align(InCapacity, Alignment))
+		, Offset(0)
+		, HighWaterMark(0)
+	{
+		Block = static_cast<uint8*>(FMemory::Malloc(FMath::Max<SIZE_T>(Capacity, Alignment), Alignment));
+	}
+
+	FMixerFrameArena::~FMixerFrameArena()
+	{
+		Reset();
+		FMemory::Free(Block);
+	}
+
+	FMixerFrameArena& FMixerFrameArena::Get()
+	{
+		static thread_local TUniquePtr<FMixerFrameArena> ThreadArena;
+		if (!ThreadArena.IsValid())
+		{
+			ThreadArena = MakeUnique<FMixerFrameArena>((SIZE_T)FMath::Max(FrameArenaInitialSizeKBCVar, 1) * 1024);
+		}
+
+		return *ThreadArena;
+	}
+
+	void* FMixerFrameArena::AllocateBytes(SIZE_T InSize)
+	{
+		const SIZE_T Size = Align(InSize, Alignment);
+		const SIZE_T Start = Offset;
+
+		Offset += Size;
+		HighWaterMark = FMath::Max(HighWaterMark, Offset);
+
+		if (Offset <= Capacity)
+		{
+			return Block + Start;
+		}
+
+		void* Overflow = FMemory::Malloc(FMath::Max<SIZE_T>(Size, Alignment), Alignment);
+		OverflowAllocations.Add(Overflow);
+		return Overflow;
+	}
+
+	void FMixerFrameArena::Reset()
+	{
+		Offset = 0;
+
+		if (OverflowAllocations.Num() == 0)
+		{
+			return;
+		}
+
+		for (void* Overflow : OverflowAllocations)
+		{
+			FMemory::Free(Overflow);
+		}
+		OverflowAllocations.Reset();
+
+		// Grow once to the peak, so the next blocks fit in the main block again.
+		Capacity = Align(HighWaterMark, Alignment);
+		FMemory::Free(Block);
+		Block = static_cast<uint8*>(FMemory::Malloc(Capacity, Alignment));
+	}
+}
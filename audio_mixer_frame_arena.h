@@ -0,0 +1,90 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace Audio
+{
+	/**
+	 * Linear allocator for scratch buffers that only live while a block renders.
+	 *
+	 * Every thread that renders submixes owns one arena, which is reset once per render block.
+	 * Allocations are 64 byte aligned and cost a pointer bump. A submix takes its scratch buffers
+	 * inside an FScope, which hands the memory back when the submix finishes, so the next submix
+	 * on the same thread reuses it and the arena only grows to the largest scratch footprint that
+	 * is live at once rather than the sum over all submixes.
+	 *
+	 * When a block needs more than the arena holds, the excess comes from the heap for that block
+	 * and the arena grows to the block's peak on the next reset, so allocations stop after warm-up.
+	 */
+	class FMixerFrameArena
+	{
+	public:
+		static constexpr SIZE_T Alignment = 64;
+
+		explicit FMixerFrameArena(SIZE_T InCapacity);
+		~FMixerFrameArena();
+
+		/** Returns the calling thread's arena, creating it on first use. */
+		static FMixerFrameArena& Get();
+
+		/** Returns uninitialized, aligned storage for the given number of elements. Valid until the enclosing scope ends or the arena is reset. */
+		template <typename ElementType>
+		ElementType* Allocate(int32 InNum)
+		{
+			return static_cast<ElementType*>(AllocateBytes(sizeof(ElementType) * FMath::Max(InNum, 0)));
+		}
+
+		void* AllocateBytes(SIZE_T InSize);
+
+		/** Frees everything. Called once per render block, outside any scope. */
+		void Reset();
+
+		/** Returns the current position, to rewind to later. */
+		SIZE_T GetMark() const { return Offset; }
+
+		/** Frees everything allocated since the mark was taken. */
+		void Rewind(SIZE_T InMark)
+		{
+			check(InMark <= Offset);
+			Offset = InMark;
+		}
+
+		SIZE_T GetCapacity() const { return Capacity; }
+
+		/** Largest number of bytes live at once since the arena was created. */
+		SIZE_T GetHighWaterMark() const { return HighWaterMark; }
+
+		/** Hands back everything allocated in the scope when it ends. */
+		class FScope
+		{
+		public:
+			explicit FScope(FMixerFrameArena& InArena)
+				: Arena(InArena)
+				, Mark(InArena.GetMark())
+			{
+			}
+
+			~FScope()
+			{
+				Arena.Rewind(Mark);
+			}
+
+		private:
+			FMixerFrameArena& Arena;
+			SIZE_T Mark;
+		};
+
+	private:
+		/** Main block. */
+		uint8* Block;
+		SIZE_T Capacity;
+
+		/** Bytes in use, counting overflow allocations past the end of the main block. */
+		SIZE_T Offset;
+
+		SIZE_T HighWaterMark;
+
+		/** Heap allocations for the part of this block that didn't fit. Freed by Reset. */
+		TArray<void*> OverflowAllocations;
+	};
+}
@@ -0,0 +1,1591 @@
+#include "audio_mixer_kernels.h"
+#include "AudioMixerLog.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define MIXER_KERNELS_X86 1
+	#include <immintrin.h>
+	#if defined(_MSC_VER) && !defined(__clang__)
+		#include <intrin.h>
+	#endif
+#else
+	#define MIXER_KERNELS_X86 0
+#endif
+
+// GCC and Clang need per-function target attributes to emit AVX code without building the whole module for AVX.
+#if MIXER_KERNELS_X86 && (defined(__GNUC__) || defined(__clang__))
+	#define MIXER_TARGET_AVX2 __attribute__((target("avx2")))
+	#define MIXER_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+	#define MIXER_TARGET_AVX2
+	#define MIXER_TARGET_AVX512
+#endif
+
+// Keep multiplies and adds separate; fused multiply-adds would make the AVX-512 kernels round differently from the scalar reference.
+#if defined(__clang__)
+	#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+	#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace Audio
+{
+	namespace MixerKernels
+	{
+		/** Returns the per-group gain increment of a fade over the given number of samples. */
+		static FORCEINLINE float GetFadeDelta(int32 NumSamples, float StartGain, float EndGain)
+		{
+			const int32 NumGroups = FMath::Max(NumSamples / 4, 1);
+			return (EndGain - StartGain) / NumGroups;
+		}
+
+		/** Returns the gain applied to the group of four samples that contains SampleIndex. */
+		static FORCEINLINE float GetFadeGain(int32 SampleIndex, float StartGain, float Delta)
+		{
+			return StartGain + Delta * (float)(SampleIndex >> 2);
+		}
+
+		/** Buffers GainAndMixInMultiple sums in registers per pass over the output, which keeps the input streams few enough for the prefetchers. */
+		static constexpr int32 MultipleMixGroupSize = 8;
+
+		/** DotProduct sums into this many interleaved partial sums, one per AVX2 lane, so every instruction set adds in the same order. */
+		static constexpr int32 DotProductNumLanes = 8;
+
+		/** Adds the products of samples From to NumSamples into the partial sums, continuing the lane pattern of the vector loops. */
+		static FORCEINLINE void AccumulateDotProductTail(const float* InA, const float* InB, int32 From, int32 NumSamples, float* InOutLanes)
+		{
+			for (int32 i = From; i < NumSamples; ++i)
+			{
+				InOutLanes[i % DotProductNumLanes] += InA[i] * InB[i];
+			}
+		}
+
+		/** Folds the partial sums of DotProduct: the upper half onto the lower half, then the pairs. */
+		static FORCEINLINE float ReduceDotProductLanes(const float* InLanes)
+		{
+			const float Sum0 = InLanes[0] + InLanes[4];
+			const float Sum1 = InLanes[1] + InLanes[5];
+			const float Sum2 = InLanes[2] + InLanes[6];
+			const float Sum3 = InLanes[3] + InLanes[7];
+			return (Sum0 + Sum2) + (Sum1 + Sum3);
+		}
+
+		/** Returns the gain used by MixDownToMono. */
+		static FORCEINLINE float GetDownmixGain(int32 NumChannels)
+		{
+			return 1.0f / FMath::Sqrt((float)NumChannels);
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// Scalar reference
+
+		static void MixInScalar(const float* InBuffer, float* BufferToSumTo, int32 NumSamples)
+		{
+			for (int32 i = 0; i < NumSamples; ++i)
+			{
+				BufferToSumTo[i] += InBuffer[i];
+			}
+		}
+
+		static void GainAndMixInScalar(const float* InBuffer, float* BufferToSumTo, int32 NumSamples, float Gain)
+		{
+			for (int32 i = 0; i < NumSamples; ++i)
+			{
+				BufferToSumTo[i] += InBuffer[i] * Gain;
+			}
+		}
+
+		static void GainAndMixInMultipleScalar(const float* const* InBuffers, const float* Gains, int32 NumBuffers, int32 InOffset, float* BufferToSumTo, int32 NumSamples)
+		{
+			for (int32 First = 0; First < NumBuffers; First += MultipleMixGroupSize)
+			{
+				const int32 Last = FMath::Min(First + MultipleMixGroupSize, NumBuffers);
+				for (int32 i = 0; i < NumSamples; ++i)
+				{
+					float Sum = BufferToSumTo[i];
+					for (int32 BufferIndex = First; BufferIndex < Last; ++BufferIndex)
+					{
+						Sum += InBuffers[BufferIndex][InOffset + i] * Gains[BufferIndex];
+					}
+					BufferToSumTo[i] = Sum;
+				}
+			}
+		}
+
+		static void FadeAndMixInScalar(const float* InBuffer, float* BufferToSumTo, int32 NumSamples, float StartGain, float EndGain)
+		{
+			const float Delta = GetFadeDelta(NumSamples, StartGain, EndGain);
+			for (int32 i = 0; i < NumSamples; ++i)
+			{
+				BufferToSumTo[i] += InBuffer[i] * GetFadeGain(i, StartGain, Delta);
+			}
+		}
+
+		static void MultiplyByConstantInPlaceScalar(float* InOutBuffer, int32 NumSamples, float Gain)
+		{
+			for (int32 i = 0; i < NumSamples; ++i)
+			{
+				InOutBuffer[i] *= Gain;
+			}
+		}
+
+		static void FadeInPlaceScalar(float* InOutBuffer, int32 NumSamples, float StartGain, float EndGain)
+		{
+			const float Delta = GetFadeDelta(NumSamples, StartGain, EndGain);
+			for (int32 i = 0; i < NumSamples; ++i)
+			{
+				InOutBuffer[i] *= GetFadeGain(i, StartGain, Delta);
+			}
+		}
+
+		static void RangeClampScalar(float* InOutBuffer, int32 NumSamples, float MinValue, float MaxValue)
+		{
+			for (int32 i = 0; i < NumSamples; ++i)
+			{
+				InOutBuffer[i] = FMath::Min(FMath::Max(InOutBuffer[i], MinValue), MaxValue);
+			}
+		}
+
+		static void MixDownToMonoScalar(const float* InBuffer, float* OutMonoBuffer, int32 NumFrames, int32 NumChannels)
+		{
+			const float Gain = GetDownmixGain(NumChannels);
+			for (int32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex)
+			{
+				const float* Frame = InBuffer + FrameIndex * NumChannels;
+
+				float Sum = 0.0f;
+				for (int32 ChannelIndex = 0; ChannelIndex < NumChannels; ++ChannelIndex)
+				{
+					Sum += Frame[ChannelIndex];
+				}
+
+				OutMonoBuffer[FrameIndex] = Sum * Gain;
+			}
+		}
+
+		/** Scale and clamp range of an integer output format. Full scale is 2^n - 1, so 1.0 and -1.0 map to the largest values of either sign. */
+		struct FInt16Format
+		{
+			static constexpr float FullScale = 32767.0f;
+			static constexpr float MinValue = -32767.0f;
+			static constexpr float MaxValue = 32767.0f;
+			static constexpr bool bSaturatesInIntegerRange = false;
+		};
+
+		struct FInt24Format
+		{
+			static constexpr float FullScale = 8388607.0f;
+			static constexpr float MinValue = -8388607.0f;
+			static constexpr float MaxValue = 8388607.0f;
+			static constexpr bool bSaturatesInIntegerRange = false;
+		};
+
+		// 2^31 - 1 rounds to 2^31 as a float, one past the int32 range, so samples clamped to full scale are
+		// saturated to +-(2^31 - 1) after the conversion rather than converted.
+		struct FInt32Format
+		{
+			static constexpr float FullScale = 2147483647.0f;
+			static constexpr float MinValue = -2147483647.0f;
+			static constexpr float MaxValue = 2147483647.0f;
+			static constexpr bool bSaturatesInIntegerRange = true;
+		};
+
+		static constexpr uint32 DitherHashMultiplierA = 0x9E3779B1u;
+		static constexpr uint32 DitherHashMultiplierB = 0x85EBCA6Bu;
+		static constexpr float DitherNoiseScale = 1.0f / 65536.0f;
+
+		/**
+		 * Returns the TPDF dither noise, in LSBs, for the given sample of the dither sequence. The noise is the
+		 * difference of the two 16 bit halves of an integer hash, so it needs no state and every instruction set
+		 * can compute it for any sample independently.
+		 */
+		static FORCEINLINE float GetDitherNoise(uint32 SampleIndex)
+		{
+			uint32 Hash = SampleIndex * DitherHashMultiplierA;
+			Hash ^= Hash >> 16;
+			Hash *= DitherHashMultiplierB;
+			Hash ^= Hash >> 13;
+			return (float)((int32)(Hash >> 16) - (int32)(Hash & 0xFFFF)) * DitherNoiseScale;
+		}
+
+		template <typename FormatType>
+		static FORCEINLINE int32 ConvertSampleScalar(float Sample, float Scale, float DitherAmount, uint32 DitherIndex)
+		{
+			float Value = Sample * Scale;
+			if (DitherAmount != 0.0f)
+			{
+				Value += GetDitherNoise(DitherIndex) * DitherAmount;
+			}
+			Value = FMath::Min(FMath::Max(Value, FormatType::MinValue), FormatType::MaxValue);
+			if (FormatType::bSaturatesInIntegerRange && (Value >= FormatType::MaxValue || Value <= FormatType::MinValue))
+			{
+				return Value > 0.0f ? MAX_int32 : -MAX_int32;
+			}
+			return (int32)Value;
+		}
+
+		static FORCEINLINE void WriteInt24(uint8* OutSample, int32 Value)
+		{
+			OutSample[0] = (uint8)(Value & 0xFF);
+			OutSample[1] = (uint8)((Value >> 8) & 0xFF);
+			OutSample[2] = (uint8)((Value >> 16) & 0xFF);
+		}
+
+		static float MaxAbsScalar(const float* InBuffer, int32 NumSamples)
+		{
+			float Max = 0.0f;
+			for (int32 i = 0; i < NumSamples; ++i)
+			{
+				Max = FMath::Max(Max, FMath::Abs(InBuffer[i]));
+			}
+			return Max;
+		}
+
+		static float DotProductScalar(const float* InA, const float* InB, int32 NumSamples)
+		{
+			float Lanes[DotProductNumLanes] = { 0.0f };
+			AccumulateDotProductTail(InA, InB, 0, NumSamples, Lanes);
+			return ReduceDotProductLanes(Lanes);
+		}
+
+		static FORCEINLINE float FollowEnvelopeSample(float Envelope, float Sample, float AttackCoefficient, float ReleaseCoefficient, bool bMeanSquared)
+		{
+			const float Input = bMeanSquared ? Sample * Sample : FMath::Abs(Sample);
+			const float Coefficient = Input > Envelope ? AttackCoefficient : ReleaseCoefficient;
+			return Coefficient * (Envelope - Input) + Input;
+		}
+
+		/** Follows the envelopes of channels FirstChannel and up, one channel at a time. */
+		static void FollowEnvelopeChannelsScalar(const float* InBuffer, int32 NumFrames, int32 NumChannels, int32 FirstChannel, float* InOutEnvelopes, float AttackCoefficient, float ReleaseCoefficient, bool bMeanSquared)
+		{
+			for (int32 Channel = FirstChannel; Channel < NumChannels; ++Channel)
+			{
+				float Envelope = InOutEnvelopes[Channel];
+				const float* Samples = InBuffer + Channel;
+				for (int32 Frame = 0; Frame < NumFrames; ++Frame, Samples += NumChannels)
+				{
+					Envelope = FollowEnvelopeSample(Envelope, *Samples, AttackCoefficient, ReleaseCoefficient, bMeanSquared);
+				}
+				InOutEnvelopes[Channel] = Envelope;
+			}
+		}
+
+		static void FollowEnvelopeScalar(const float* InBuffer, int32 NumFrames, int32 NumChannels, float* InOutEnvelopes, float AttackCoefficient, float ReleaseCoefficient, bool bMeanSquared)
+		{
+			FollowEnvelopeChannelsScalar(InBuffer, NumFrames, NumChannels, 0, InOutEnvelopes, AttackCoefficient, ReleaseCoefficient, bMeanSquared);
+		}
+
+		static void DeinterleaveScalar(const float* InBuffer, float* OutLanes, int32 LaneStride, int32 NumFrames, int32 NumChannels)
+		{
+			for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+			{
+				float* Lane = OutLanes + Channel * LaneStride;
+				const float* Samples = InBuffer + Channel;
+				for (int32 Frame = 0; Frame < NumFrames; ++Frame, Samples += NumChannels)
+				{
+					Lane[Frame] = *Samples;
+				}
+			}
+		}
+
+		static void InterleaveScalar(const float* InLanes, int32 LaneStride, float* OutBuffer, int32 NumFrames, int32 NumChannels)
+		{
+			for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+			{
+				const float* Lane = InLanes + Channel * LaneStride;
+				float* Samples = OutBuffer + Channel;
+				for (int32 Frame = 0; Frame < NumFrames; ++Frame, Samples += NumChannels)
+				{
+					*Samples = Lane[Frame];
+				}
+			}
+		}
+
+		static void ConvertToFloatScalar(const float* InBuffer, float* OutBuffer, int32 NumSamples, float Gain)
+		{
+			for (int32 i = 0; i < NumSamples; ++i)
+			{
+				OutBuffer[i] = FMath::Min(FMath::Max(InBuffer[i] * Gain, -1.0f), 1.0f);
+			}
+		}
+
+		static void ConvertToInt16Scalar(const float* InBuffer, int16* OutBuffer, int32 NumSamples, float Gain, float DitherAmount, uint32 DitherSeed)
+		{
+			const float Scale = Gain * FInt16Format::FullScale;
+			for (int32 i = 0; i < NumSamples; ++i)
+			{
+				OutBuffer[i] = (int16)ConvertSampleScalar<FInt16Format>(InBuffer[i], Scale, DitherAmount, DitherSeed + i);
+			}
+		}
+
+		static void ConvertToInt24Scalar(const float* InBuffer, uint8* OutBuffer, int32 NumSamples, float Gain, float DitherAmount, uint32 DitherSeed)
+		{
+			const float Scale = Gain * FInt24Format::FullScale;
+			for (int32 i = 0; i < NumSamples; ++i)
+			{
+				WriteInt24(OutBuffer + i * 3, ConvertSampleScalar<FInt24Format>(InBuffer[i], Scale, DitherAmount, DitherSeed + i));
+			}
+		}
+
+		static void ConvertToInt32Scalar(const float* InBuffer, int32* OutBuffer, int32 NumSamples, float Gain, float DitherAmount, uint32 DitherSeed)
+		{
+			const float Scale = Gain * FInt32Format::FullScale;
+			for (int32 i = 0; i < NumSamples; ++i)
+			{
+				OutBuffer[i] = ConvertSampleScalar<FInt32Format>(InBuffer[i], Scale, DitherAmount, DitherSeed + i);
+			}
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// Scalar, fixed channel count
+
+		template <int32 NumChannels>
+		static void MixDownToMonoFixedScalar(const float* InBuffer, float* OutMonoBuffer, int32 NumFrames, int32 InNumChannels)
+		{
+			checkSlow(InNumChannels == NumChannels);
+			const float Gain = GetDownmixGain(NumChannels);
+			for (int32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex)
+			{
+				const float* Frame = InBuffer + FrameIndex * NumChannels;
+
+				float Sum = 0.0f;
+				for (int32 ChannelIndex = 0; ChannelIndex < NumChannels; ++ChannelIndex)
+				{
+					Sum += Frame[ChannelIndex];
+				}
+
+				OutMonoBuffer[FrameIndex] = Sum * Gain;
+			}
+		}
+
+		/** Updates every channel of a frame before moving to the next one, so the buffer is read once in order. */
+		template <int32 NumChannels>
+		static void FollowEnvelopeFixedScalar(const float* InBuffer, int32 NumFrames, int32 InNumChannels, float* InOutEnvelopes, float AttackCoefficient, float ReleaseCoefficient, bool bMeanSquared)
+		{
+			checkSlow(InNumChannels == NumChannels);
+			float Envelopes[NumChannels];
+			for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+			{
+				Envelopes[Channel] = InOutEnvelopes[Channel];
+			}
+
+			const float* Frame = InBuffer;
+			for (int32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex, Frame += NumChannels)
+			{
+				for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+				{
+					Envelopes[Channel] = FollowEnvelopeSample(Envelopes[Channel], Frame[Channel], AttackCoefficient, ReleaseCoefficient, bMeanSquared);
+				}
+			}
+
+			for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+			{
+				InOutEnvelopes[Channel] = Envelopes[Channel];
+			}
+		}
+
+#if MIXER_KERNELS_X86
+		//////////////////////////////////////////////////////////////////////////
+		// SSE2 (baseline on x86-64)
+
+		static void MixInSSE2(const float* InBuffer, float* BufferToSumTo, int32 NumSamples)
+		{
+			int32 i = 0;
+			for (; i + 4 <= NumSamples; i += 4)
+			{
+				_mm_storeu_ps(BufferToSumTo + i, _mm_add_ps(_mm_loadu_ps(BufferToSumTo + i), _mm_loadu_ps(InBuffer + i)));
+			}
+			MixInScalar(InBuffer + i, BufferToSumTo + i, NumSamples - i);
+		}
+
+		static void GainAndMixInSSE2(const float* InBuffer, float* BufferToSumTo, int32 NumSamples, float Gain)
+		{
+			const __m128 GainVector = _mm_set1_ps(Gain);
+			int32 i = 0;
+			for (; i + 4 <= NumSamples; i += 4)
+			{
+				const __m128 Scaled = _mm_mul_ps(_mm_loadu_ps(InBuffer + i), GainVector);
+				_mm_storeu_ps(BufferToSumTo + i, _mm_add_ps(_mm_loadu_ps(BufferToSumTo + i), Scaled));
+			}
+			GainAndMixInScalar(InBuffer + i, BufferToSumTo + i, NumSamples - i, Gain);
+		}
+
+		static void GainAndMixInMultipleSSE2(const float* const* InBuffers, const float* Gains, int32 NumBuffers, int32 InOffset, float* BufferToSumTo, int32 NumSamples)
+		{
+			for (int32 First = 0; First < NumBuffers; First += MultipleMixGroupSize)
+			{
+				const int32 NumInGroup = FMath::Min(MultipleMixGroupSize, NumBuffers - First);
+				const float* Buffers[MultipleMixGroupSize];
+				__m128 GainVectors[MultipleMixGroupSize];
+				for (int32 BufferIndex = 0; BufferIndex < NumInGroup; ++BufferIndex)
+				{
+					Buffers[BufferIndex] = InBuffers[First + BufferIndex] + InOffset;
+					GainVectors[BufferIndex] = _mm_set1_ps(Gains[First + BufferIndex]);
+				}
+
+				int32 i = 0;
+				for (; i + 4 <= NumSamples; i += 4)
+				{
+					__m128 Sum = _mm_loadu_ps(BufferToSumTo + i);
+					for (int32 BufferIndex = 0; BufferIndex < NumInGroup; ++BufferIndex)
+					{
+						Sum = _mm_add_ps(Sum, _mm_mul_ps(_mm_loadu_ps(Buffers[BufferIndex] + i), GainVectors[BufferIndex]));
+					}
+					_mm_storeu_ps(BufferToSumTo + i, Sum);
+				}
+				GainAndMixInMultipleScalar(InBuffers + First, Gains + First, NumInGroup, InOffset + i, BufferToSumTo + i, NumSamples - i);
+			}
+		}
+
+		static void FadeAndMixInSSE2(const float* InBuffer, float* BufferToSumTo, int32 NumSamples, float StartGain, float EndGain)
+		{
+			const float Delta = GetFadeDelta(NumSamples, StartGain, EndGain);
+			int32 i = 0;
+			for (; i + 4 <= NumSamples; i += 4)
+			{
+				const __m128 Scaled = _mm_mul_ps(_mm_loadu_ps(InBuffer + i), _mm_set1_ps(GetFadeGain(i, StartGain, Delta)));
+				_mm_storeu_ps(BufferToSumTo + i, _mm_add_ps(_mm_loadu_ps(BufferToSumTo + i), Scaled));
+			}
+			for (; i < NumSamples; ++i)
+			{
+				BufferToSumTo[i] += InBuffer[i] * GetFadeGain(i, StartGain, Delta);
+			}
+		}
+
+		static void MultiplyByConstantInPlaceSSE2(float* InOutBuffer, int32 NumSamples, float Gain)
+		{
+			const __m128 GainVector = _mm_set1_ps(Gain);
+			int32 i = 0;
+			for (; i + 4 <= NumSamples; i += 4)
+			{
+				_mm_storeu_ps(InOutBuffer + i, _mm_mul_ps(_mm_loadu_ps(InOutBuffer + i), GainVector));
+			}
+			MultiplyByConstantInPlaceScalar(InOutBuffer + i, NumSamples - i, Gain);
+		}
+
+		static void FadeInPlaceSSE2(float* InOutBuffer, int32 NumSamples, float StartGain, float EndGain)
+		{
+			const float Delta = GetFadeDelta(NumSamples, StartGain, EndGain);
+			int32 i = 0;
+			for (; i + 4 <= NumSamples; i += 4)
+			{
+				_mm_storeu_ps(InOutBuffer + i, _mm_mul_ps(_mm_loadu_ps(InOutBuffer + i), _mm_set1_ps(GetFadeGain(i, StartGain, Delta))));
+			}
+			for (; i < NumSamples; ++i)
+			{
+				InOutBuffer[i] *= GetFadeGain(i, StartGain, Delta);
+			}
+		}
+
+		static void RangeClampSSE2(float* InOutBuffer, int32 NumSamples, float MinValue, float MaxValue)
+		{
+			const __m128 MinVector = _mm_set1_ps(MinValue);
+			const __m128 MaxVector = _mm_set1_ps(MaxValue);
+			int32 i = 0;
+			for (; i + 4 <= NumSamples; i += 4)
+			{
+				_mm_storeu_ps(InOutBuffer + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(InOutBuffer + i), MinVector), MaxVector));
+			}
+			RangeClampScalar(InOutBuffer + i, NumSamples - i, MinValue, MaxValue);
+		}
+
+		static void MixDownToMonoSSE2(const float* InBuffer, float* OutMonoBuffer, int32 NumFrames, int32 NumChannels)
+		{
+			// Only stereo has a shuffle-friendly layout; other layouts use the reference loop.
+			if (NumChannels != 2)
+			{
+				MixDownToMonoScalar(InBuffer, OutMonoBuffer, NumFrames, NumChannels);
+				return;
+			}
+
+			const __m128 GainVector = _mm_set1_ps(GetDownmixGain(2));
+			int32 FrameIndex = 0;
+			for (; FrameIndex + 4 <= NumFrames; FrameIndex += 4)
+			{
+				const __m128 FramesA = _mm_loadu_ps(InBuffer + FrameIndex * 2);
+				const __m128 FramesB = _mm_loadu_ps(InBuffer + FrameIndex * 2 + 4);
+				const __m128 Left = _mm_shuffle_ps(FramesA, FramesB, _MM_SHUFFLE(2, 0, 2, 0));
+				const __m128 Right = _mm_shuffle_ps(FramesA, FramesB, _MM_SHUFFLE(3, 1, 3, 1));
+				_mm_storeu_ps(OutMonoBuffer + FrameIndex, _mm_mul_ps(_mm_add_ps(Left, Right), GainVector));
+			}
+			MixDownToMonoScalar(InBuffer + FrameIndex * 2, OutMonoBuffer + FrameIndex, NumFrames - FrameIndex, 2);
+		}
+
+		/** Low 32 bits of a 32 bit lane multiply; SSE2 only has the widening 32 x 32 -> 64 bit multiply. */
+		static FORCEINLINE __m128i MultiplyLowSSE2(__m128i A, __m128i B)
+		{
+			const __m128i Even = _mm_mul_epu32(A, B);
+			const __m128i Odd = _mm_mul_epu32(_mm_srli_epi64(A, 32), _mm_srli_epi64(B, 32));
+			return _mm_unpacklo_epi32(_mm_shuffle_epi32(Even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(Odd, _MM_SHUFFLE(0, 0, 2, 0)));
+		}
+
+		/** Vector version of GetDitherNoise for four consecutive samples. */
+		static FORCEINLINE __m128 GetDitherNoiseSSE2(uint32 SampleIndex)
+		{
+			__m128i Hash = _mm_add_epi32(_mm_set1_epi32((int32)SampleIndex), _mm_setr_epi32(0, 1, 2, 3));
+			Hash = MultiplyLowSSE2(Hash, _mm_set1_epi32((int32)DitherHashMultiplierA));
+			Hash = _mm_xor_si128(Hash, _mm_srli_epi32(Hash, 16));
+			Hash = MultiplyLowSSE2(Hash, _mm_set1_epi32((int32)DitherHashMultiplierB));
+			Hash = _mm_xor_si128(Hash, _mm_srli_epi32(Hash, 13));
+			const __m128i Difference = _mm_sub_epi32(_mm_srli_epi32(Hash, 16), _mm_and_si128(Hash, _mm_set1_epi32(0xFFFF)));
+			return _mm_mul_ps(_mm_cvtepi32_ps(Difference), _mm_set1_ps(DitherNoiseScale));
+		}
+
+		/** Scales, dithers, clamps and truncates four samples. */
+		template <typename FormatType>
+		static FORCEINLINE __m128i ConvertVectorSSE2(const float* InSamples, __m128 Scale, float DitherAmount, uint32 DitherIndex)
+		{
+			__m128 Value = _mm_mul_ps(_mm_loadu_ps(InSamples), Scale);
+			if (DitherAmount != 0.0f)
+			{
+				Value = _mm_add_ps(Value, _mm_mul_ps(GetDitherNoiseSSE2(DitherIndex), _mm_set1_ps(DitherAmount)));
+			}
+			Value = _mm_min_ps(_mm_max_ps(Value, _mm_set1_ps(FormatType::MinValue)), _mm_set1_ps(FormatType::MaxValue));
+			__m128i Result = _mm_cvttps_epi32(Value);
+			if (FormatType::bSaturatesInIntegerRange)
+			{
+				// Full scale converts to 0x80000000 either way: flip the positive lanes to 0x7FFFFFFF and add one to the negative ones.
+				Result = _mm_xor_si128(Result, _mm_castps_si128(_mm_cmpge_ps(Value, _mm_set1_ps(FormatType::MaxValue))));
+				Result = _mm_sub_epi32(Result, _mm_castps_si128(_mm_cmple_ps(Value, _mm_set1_ps(FormatType::MinValue))));
+			}
+			return Result;
+		}
+
+		static float MaxAbsSSE2(const float* InBuffer, int32 NumSamples)
+		{
+			const __m128 AbsMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+			__m128 MaxVector = _mm_setzero_ps();
+			int32 i = 0;
+			for (; i + 4 <= NumSamples; i += 4)
+			{
+				MaxVector = _mm_max_ps(MaxVector, _mm_and_ps(_mm_loadu_ps(InBuffer + i), AbsMask));
+			}
+
+			alignas(16) float Lanes[4];
+			_mm_store_ps(Lanes, MaxVector);
+			const float Max = FMath::Max(FMath::Max(Lanes[0], Lanes[1]), FMath::Max(Lanes[2], Lanes[3]));
+			return FMath::Max(Max, MaxAbsScalar(InBuffer + i, NumSamples - i));
+		}
+
+		static float DotProductSSE2(const float* InA, const float* InB, int32 NumSamples)
+		{
+			// Two vectors of partial sums stand in for the eight AVX2 lanes.
+			__m128 SumLow = _mm_setzero_ps();
+			__m128 SumHigh = _mm_setzero_ps();
+			int32 i = 0;
+			for (; i + DotProductNumLanes <= NumSamples; i += DotProductNumLanes)
+			{
+				SumLow = _mm_add_ps(SumLow, _mm_mul_ps(_mm_loadu_ps(InA + i), _mm_loadu_ps(InB + i)));
+				SumHigh = _mm_add_ps(SumHigh, _mm_mul_ps(_mm_loadu_ps(InA + i + 4), _mm_loadu_ps(InB + i + 4)));
+			}
+
+			alignas(16) float Lanes[DotProductNumLanes];
+			_mm_store_ps(Lanes, SumLow);
+			_mm_store_ps(Lanes + 4, SumHigh);
+			AccumulateDotProductTail(InA, InB, i, NumSamples, Lanes);
+			return ReduceDotProductLanes(Lanes);
+		}
+
+		/** Vector version of FollowEnvelopeSample for four channels. */
+		static FORCEINLINE __m128 FollowEnvelopeVectorSSE2(__m128 Envelope, __m128 Samples, __m128 AttackCoefficient, __m128 ReleaseCoefficient, bool bMeanSquared)
+		{
+			const __m128 Input = bMeanSquared ? _mm_mul_ps(Samples, Samples) : _mm_and_ps(Samples, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)));
+			const __m128 IsRising = _mm_cmpgt_ps(Input, Envelope);
+			const __m128 Coefficient = _mm_or_ps(_mm_and_ps(IsRising, AttackCoefficient), _mm_andnot_ps(IsRising, ReleaseCoefficient));
+			return _mm_add_ps(_mm_mul_ps(Coefficient, _mm_sub_ps(Envelope, Input)), Input);
+		}
+
+		/**
+		 * Follows the envelopes of channels FirstChannel and up. Each group of four channels of a frame is one
+		 * vector, so the loop over frames runs once per group instead of once per channel. A remaining pair of
+		 * channels (stereo, or the last two of 5.1) uses the low half of a vector.
+		 */
+		static void FollowEnvelopeChannelsSSE2(const float* InBuffer, int32 NumFrames, int32 NumChannels, int32 FirstChannel, float* InOutEnvelopes, float AttackCoefficient, float ReleaseCoefficient, bool bMeanSquared)
+		{
+			const __m128 AttackVector = _mm_set1_ps(AttackCoefficient);
+			const __m128 ReleaseVector = _mm_set1_ps(ReleaseCoefficient);
+
+			int32 Channel = FirstChannel;
+			for (; Channel + 4 <= NumChannels; Channel += 4)
+			{
+				__m128 Envelope = _mm_loadu_ps(InOutEnvelopes + Channel);
+				const float* Samples = InBuffer + Channel;
+				for (int32 Frame = 0; Frame < NumFrames; ++Frame, Samples += NumChannels)
+				{
+					Envelope = FollowEnvelopeVectorSSE2(Envelope, _mm_loadu_ps(Samples), AttackVector, ReleaseVector, bMeanSquared);
+				}
+				_mm_storeu_ps(InOutEnvelopes + Channel, Envelope);
+			}
+
+			if (Channel + 2 <= NumChannels)
+			{
+				__m128 Envelope = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(InOutEnvelopes + Channel)));
+				const float* Samples = InBuffer + Channel;
+				for (int32 Frame = 0; Frame < NumFrames; ++Frame, Samples += NumChannels)
+				{
+					const __m128 SamplePair = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(Samples)));
+					Envelope = FollowEnvelopeVectorSSE2(Envelope, SamplePair, AttackVector, ReleaseVector, bMeanSquared);
+				}
+				_mm_store_sd(reinterpret_cast<double*>(InOutEnvelopes + Channel), _mm_castps_pd(Envelope));
+				Channel += 2;
+			}
+
+			FollowEnvelopeChannelsScalar(InBuffer, NumFrames, NumChannels, Channel, InOutEnvelopes, AttackCoefficient, ReleaseCoefficient, bMeanSquared);
+		}
+
+		static void FollowEnvelopeSSE2(const float* InBuffer, int32 NumFrames, int32 NumChannels, float* InOutEnvelopes, float AttackCoefficient, float ReleaseCoefficient, bool bMeanSquared)
+		{
+			FollowEnvelopeChannelsSSE2(InBuffer, NumFrames, NumChannels, 0, InOutEnvelopes, AttackCoefficient, ReleaseCoefficient, bMeanSquared);
+		}
+
+		/** Deinterleaves channels in groups of four by transposing 4 x 4 blocks of frames and channels. Returns the first channel left over. */
+		static int32 DeinterleaveChannelGroupsSSE2(const float* InBuffer, float* OutLanes, int32 LaneStride, int32 NumFrames, int32 NumChannels)
+		{
+			const int32 NumGroupedChannels = NumChannels & ~3;
+			const int32 NumGroupedFrames = NumFrames & ~3;
+			for (int32 Channel = 0; Channel < NumGroupedChannels; Channel += 4)
+			{
+				float* Lane = OutLanes + Channel * LaneStride;
+				for (int32 FrameIndex = 0; FrameIndex < NumGroupedFrames; FrameIndex += 4)
+				{
+					const float* Frames = InBuffer + FrameIndex * NumChannels + Channel;
+					__m128 Row0 = _mm_loadu_ps(Frames);
+					__m128 Row1 = _mm_loadu_ps(Frames + NumChannels);
+					__m128 Row2 = _mm_loadu_ps(Frames + NumChannels * 2);
+					__m128 Row3 = _mm_loadu_ps(Frames + NumChannels * 3);
+					_MM_TRANSPOSE4_PS(Row0, Row1, Row2, Row3);
+					_mm_storeu_ps(Lane + FrameIndex, Row0);
+					_mm_storeu_ps(Lane + LaneStride + FrameIndex, Row1);
+					_mm_storeu_ps(Lane + LaneStride * 2 + FrameIndex, Row2);
+					_mm_storeu_ps(Lane + LaneStride * 3 + FrameIndex, Row3);
+				}
+
+				for (int32 FrameIndex = NumGroupedFrames; FrameIndex < NumFrames; ++FrameIndex)
+				{
+					for (int32 Offset = 0; Offset < 4; ++Offset)
+					{
+						Lane[Offset * LaneStride + FrameIndex] = InBuffer[FrameIndex * NumChannels + Channel + Offset];
+					}
+				}
+			}
+			return NumGroupedChannels;
+		}
+
+		/** The inverse of DeinterleaveChannelGroupsSSE2. */
+		static int32 InterleaveChannelGroupsSSE2(const float* InLanes, int32 LaneStride, float* OutBuffer, int32 NumFrames, int32 NumChannels)
+		{
+			const int32 NumGroupedChannels = NumChannels & ~3;
+			const int32 NumGroupedFrames = NumFrames & ~3;
+			for (int32 Channel = 0; Channel < NumGroupedChannels; Channel += 4)
+			{
+				const float* Lane = InLanes + Channel * LaneStride;
+				for (int32 FrameIndex = 0; FrameIndex < NumGroupedFrames; FrameIndex += 4)
+				{
+					__m128 Row0 = _mm_loadu_ps(Lane + FrameIndex);
+					__m128 Row1 = _mm_loadu_ps(Lane + LaneStride + FrameIndex);
+					__m128 Row2 = _mm_loadu_ps(Lane + LaneStride * 2 + FrameIndex);
+					__m128 Row3 = _mm_loadu_ps(Lane + LaneStride * 3 + FrameIndex);
+					_MM_TRANSPOSE4_PS(Row0, Row1, Row2, Row3);
+
+					float* Frames = OutBuffer + FrameIndex * NumChannels + Channel;
+					_mm_storeu_ps(Frames, Row0);
+					_mm_storeu_ps(Frames + NumChannels, Row1);
+					_mm_storeu_ps(Frames + NumChannels * 2, Row2);
+					_mm_storeu_ps(Frames + NumChannels * 3, Row3);
+				}
+
+				for (int32 FrameIndex = NumGroupedFrames; FrameIndex < NumFrames; ++FrameIndex)
+				{
+					for (int32 Offset = 0; Offset < 4; ++Offset)
+					{
+						OutBuffer[FrameIndex * NumChannels + Channel + Offset] = Lane[Offset * LaneStride + FrameIndex];
+					}
+				}
+			}
+			return NumGroupedChannels;
+		}
+
+		static void DeinterleaveSSE2(const float* InBuffer, float* OutLanes, int32 LaneStride, int32 NumFrames, int32 NumChannels)
+		{
+			// Stereo gets a shuffle; other layouts transpose groups of four channels (e.g. the front
+			// four of 5.1) and copy the channels left over one at a time.
+			if (NumChannels != 2)
+			{
+				for (int32 Channel = DeinterleaveChannelGroupsSSE2(InBuffer, OutLanes, LaneStride, NumFrames, NumChannels); Channel < NumChannels; ++Channel)
+				{
+					float* Lane = OutLanes + Channel * LaneStride;
+					for (int32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex)
+					{
+						Lane[FrameIndex] = InBuffer[FrameIndex * NumChannels + Channel];
+					}
+				}
+				return;
+			}
+
+			float* LeftLane = OutLanes;
+			float* RightLane = OutLanes + LaneStride;
+			int32 FrameIndex = 0;
+			for (; FrameIndex + 4 <= NumFrames; FrameIndex += 4)
+			{
+				const __m128 FramesA = _mm_loadu_ps(InBuffer + FrameIndex * 2);
+				const __m128 FramesB = _mm_loadu_ps(InBuffer + FrameIndex * 2 + 4);
+				_mm_storeu_ps(LeftLane + FrameIndex, _mm_shuffle_ps(FramesA, FramesB, _MM_SHUFFLE(2, 0, 2, 0)));
+				_mm_storeu_ps(RightLane + FrameIndex, _mm_shuffle_ps(FramesA, FramesB, _MM_SHUFFLE(3, 1, 3, 1)));
+			}
+			for (; FrameIndex < NumFrames; ++FrameIndex)
+			{
+				LeftLane[FrameIndex] = InBuffer[FrameIndex * 2];
+				RightLane[FrameIndex] = InBuffer[FrameIndex * 2 + 1];
+			}
+		}
+
+		static void InterleaveSSE2(const float* InLanes, int32 LaneStride, float* OutBuffer, int32 NumFrames, int32 NumChannels)
+		{
+			if (NumChannels != 2)
+			{
+				for (int32 Channel = InterleaveChannelGroupsSSE2(InLanes, LaneStride, OutBuffer, NumFrames, NumChannels); Channel < NumChannels; ++Channel)
+				{
+					const float* Lane = InLanes + Channel * LaneStride;
+					for (int32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex)
+					{
+						OutBuffer[FrameIndex * NumChannels + Channel] = Lane[FrameIndex];
+					}
+				}
+				return;
+			}
+
+			const float* LeftLane = InLanes;
+			const float* RightLane = InLanes + LaneStride;
+			int32 FrameIndex = 0;
+			for (; FrameIndex + 4 <= NumFrames; FrameIndex += 4)
+			{
+				const __m128 Left = _mm_loadu_ps(LeftLane + FrameIndex);
+				const __m128 Right = _mm_loadu_ps(RightLane + FrameIndex);
+				_mm_storeu_ps(OutBuffer + FrameIndex * 2, _mm_unpacklo_ps(Left, Right));
+				_mm_storeu_ps(OutBuffer + FrameIndex * 2 + 4, _mm_unpackhi_ps(Left, Right));
+			}
+			for (; FrameIndex < NumFrames; ++FrameIndex)
+			{
+				OutBuffer[FrameIndex * 2] = LeftLane[FrameIndex];
+				OutBuffer[FrameIndex * 2 + 1] = RightLane[FrameIndex];
+			}
+		}
+
+		static void ConvertToFloatSSE2(const float* InBuffer, float* OutBuffer, int32 NumSamples, float Gain)
+		{
+			const __m128 GainVector = _mm_set1_ps(Gain);
+			const __m128 MinVector = _mm_set1_ps(-1.0f);
+			const __m128 MaxVector = _mm_set1_ps(1.0f);
+			int32 i = 0;
+			for (; i + 4 <= NumSamples; i += 4)
+			{
+				_mm_storeu_ps(OutBuffer + i, _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(InBuffer + i), GainVector), MinVector), MaxVector));
+			}
+			ConvertToFloatScalar(InBuffer + i, OutBuffer + i, NumSamples - i, Gain);
+		}
+
+		static void ConvertToInt16SSE2(const float* InBuffer, int16* OutBuffer, int32 NumSamples, float Gain, float DitherAmount, uint32 DitherSeed)
+		{
+			const __m128 Scale = _mm_set1_ps(Gain * FInt16Format::FullScale);
+			int32 i = 0;
+			for (; i + 8 <= NumSamples; i += 8)
+			{
+				const __m128i Low = ConvertVectorSSE2<FInt16Format>(InBuffer + i, Scale, DitherAmount, DitherSeed + i);
+				const __m128i High = ConvertVectorSSE2<FInt16Format>(InBuffer + i + 4, Scale, DitherAmount, DitherSeed + i + 4);
+				_mm_storeu_si128((__m128i*)(OutBuffer + i), _mm_packs_epi32(Low, High));
+			}
+			ConvertToInt16Scalar(InBuffer + i, OutBuffer + i, NumSamples - i, Gain, DitherAmount, DitherSeed + i);
+		}
+
+		static void ConvertToInt24SSE2(const float* InBuffer, uint8* OutBuffer, int32 NumSamples, float Gain, float DitherAmount, uint32 DitherSeed)
+		{
+			// SSE2 has no byte shuffle, so only the arithmetic is vectorized and the samples are packed one by one.
+			const __m128 Scale = _mm_set1_ps(Gain * FInt24Format::FullScale);
+			alignas(16) int32 Converted[4];
+			int32 i = 0;
+			for (; i + 4 <= NumSamples; i += 4)
+			{
+				_mm_store_si128((__m128i*)Converted, ConvertVectorSSE2<FInt24Format>(InBuffer + i, Scale, DitherAmount, DitherSeed + i));
+				for (int32 Lane = 0; Lane < 4; ++Lane)
+				{
+					WriteInt24(OutBuffer + (i + Lane) * 3, Converted[Lane]);
+				}
+			}
+			ConvertToInt24Scalar(InBuffer + i, OutBuffer + i * 3, NumSamples - i, Gain, DitherAmount, DitherSeed + i);
+		}
+
+		static void ConvertToInt32SSE2(const float* InBuffer, int32* OutBuffer, int32 NumSamples, float Gain, float DitherAmount, uint32 DitherSeed)
+		{
+			const __m128 Scale = _mm_set1_ps(Gain * FInt32Format::FullScale);
+			int32 i = 0;
+			for (; i + 4 <= NumSamples; i += 4)
+			{
+				_mm_storeu_si128((__m128i*)(OutBuffer + i), ConvertVectorSSE2<FInt32Format>(InBuffer + i, Scale, DitherAmount, DitherSeed + i));
+			}
+			ConvertToInt32Scalar(InBuffer + i, OutBuffer + i, NumSamples - i, Gain, DitherAmount, DitherSeed + i);
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// SSE2, fixed channel count
+
+		/**
+		 * Downmixes four frames per vector. Each group of four channels is transposed so a vector holds one channel
+		 * of the four frames, a remaining pair is split with shuffles, and the channels are summed in order from
+		 * zero, as the reference loop does.
+		 */
+		template <int32 NumChannels>
+		static void MixDownToMonoFixedSSE2(const float* InBuffer, float* OutMonoBuffer, int32 NumFrames, int32 InNumChannels)
+		{
+			checkSlow(InNumChannels == NumChannels);
+			constexpr int32 NumGroupedChannels = NumChannels & ~3;
+			const __m128 GainVector = _mm_set1_ps(GetDownmixGain(NumChannels));
+
+			int32 FrameIndex = 0;
+			for (; FrameIndex + 4 <= NumFrames; FrameIndex += 4)
+			{
+				const float* Frames = InBuffer + FrameIndex * NumChannels;
+				__m128 Sum = _mm_setzero_ps();
+
+				for (int32 Channel = 0; Channel < NumGroupedChannels; Channel += 4)
+				{
+					__m128 Row0 = _mm_loadu_ps(Frames + Channel);
+					__m128 Row1 = _mm_loadu_ps(Frames + NumChannels + Channel);
+					__m128 Row2 = _mm_loadu_ps(Frames + NumChannels * 2 + Channel);
+					__m128 Row3 = _mm_loadu_ps(Frames + NumChannels * 3 + Channel);
+					_MM_TRANSPOSE4_PS(Row0, Row1, Row2, Row3);
+					Sum = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(Sum, Row0), Row1), Row2), Row3);
+				}
+
+				if ((NumChannels & 2) != 0)
+				{
+					const float* Pairs = Frames + NumGroupedChannels;
+					const __m128 Frames01 = _mm_castpd_ps(_mm_loadh_pd(_mm_load_sd(reinterpret_cast<const double*>(Pairs)), reinterpret_cast<const double*>(Pairs + NumChannels)));
+					const __m128 Frames23 = _mm_castpd_ps(_mm_loadh_pd(_mm_load_sd(reinterpret_cast<const double*>(Pairs + NumChannels * 2)), reinterpret_cast<const double*>(Pairs + NumChannels * 3)));
+					Sum = _mm_add_ps(Sum, _mm_shuffle_ps(Frames01, Frames23, _MM_SHUFFLE(2, 0, 2, 0)));
+					Sum = _mm_add_ps(Sum, _mm_shuffle_ps(Frames01, Frames23, _MM_SHUFFLE(3, 1, 3, 1)));
+				}
+
+				if ((NumChannels & 1) != 0)
+				{
+					constexpr int32 LastChannel = NumChannels - 1;
+					Sum = _mm_add_ps(Sum, _mm_setr_ps(Frames[LastChannel], Frames[NumChannels + LastChannel], Frames[NumChannels * 2 + LastChannel], Frames[NumChannels * 3 + LastChannel]));
+				}
+
+				_mm_storeu_ps(OutMonoBuffer + FrameIndex, _mm_mul_ps(Sum, GainVector));
+			}
+			MixDownToMonoFixedScalar<NumChannels>(InBuffer + FrameIndex * NumChannels, OutMonoBuffer + FrameIndex, NumFrames - FrameIndex, NumChannels);
+		}
+
+		/**
+		 * Follows every channel group of a frame before moving to the next frame, with all envelopes held in
+		 * registers. The buffer is read once, and the dependency chains of the groups overlap instead of running
+		 * one pass per group as the generic version does.
+		 */
+		template <int32 NumChannels>
+		static void FollowEnvelopeFixedSSE2(const float* InBuffer, int32 NumFrames, int32 InNumChannels, float* InOutEnvelopes, float AttackCoefficient, float ReleaseCoefficient, bool bMeanSquared)
+		{
+			checkSlow(InNumChannels == NumChannels);
+			constexpr int32 NumGroups = NumChannels / 4;
+			constexpr bool bHasPair = (NumChannels & 2) != 0;
+			constexpr bool bHasSingle = (NumChannels & 1) != 0;
+			constexpr int32 PairChannel = NumGroups * 4;
+			constexpr int32 SingleChannel = NumChannels - 1;
+
+			const __m128 AttackVector = _mm_set1_ps(AttackCoefficient);
+			const __m128 ReleaseVector = _mm_set1_ps(ReleaseCoefficient);
+
+			// The spare element keeps the array legal for layouts without a full group.
+			__m128 Envelopes[NumGroups + 1];
+			for (int32 Group = 0; Group < NumGroups; ++Group)
+			{
+				Envelopes[Group] = _mm_loadu_ps(InOutEnvelopes + Group * 4);
+			}
+			__m128 PairEnvelope = bHasPair ? _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(InOutEnvelopes + PairChannel))) : _mm_setzero_ps();
+			float SingleEnvelope = bHasSingle ? InOutEnvelopes[SingleChannel] : 0.0f;
+
+			const float* Frame = InBuffer;
+			for (int32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex, Frame += NumChannels)
+			{
+				for (int32 Group = 0; Group < NumGroups; ++Group)
+				{
+					Envelopes[Group] = FollowEnvelopeVectorSSE2(Envelopes[Group], _mm_loadu_ps(Frame + Group * 4), AttackVector, ReleaseVector, bMeanSquared);
+				}
+				if (bHasPair)
+				{
+					const __m128 SamplePair = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(Frame + PairChannel)));
+					PairEnvelope = FollowEnvelopeVectorSSE2(PairEnvelope, SamplePair, AttackVector, ReleaseVector, bMeanSquared);
+				}
+				if (bHasSingle)
+				{
+					SingleEnvelope = FollowEnvelopeSample(SingleEnvelope, Frame[SingleChannel], AttackCoefficient, ReleaseCoefficient, bMeanSquared);
+				}
+			}
+
+			for (int32 Group = 0; Group < NumGroups; ++Group)
+			{
+				_mm_storeu_ps(InOutEnvelopes + Group * 4, Envelopes[Group]);
+			}
+			if (bHasPair)
+			{
+				_mm_store_sd(reinterpret_cast<double*>(InOutEnvelopes + PairChannel), _mm_castps_pd(PairEnvelope));
+			}
+			if (bHasSingle)
+			{
+				InOutEnvelopes[SingleChannel] = SingleEnvelope;
+			}
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// AVX2
+
+		MIXER_TARGET_AVX2 static void MixInAVX2(const float* InBuffer, float* BufferToSumTo, int32 NumSamples)
+		{
+			int32 i = 0;
+			for (; i + 8 <= NumSamples; i += 8)
+			{
+				_mm256_storeu_ps(BufferToSumTo + i, _mm256_add_ps(_mm256_loadu_ps(BufferToSumTo + i), _mm256_loadu_ps(InBuffer + i)));
+			}
+			MixInSSE2(InBuffer + i, BufferToSumTo + i, NumSamples - i);
+		}
+
+		MIXER_TARGET_AVX2 static void GainAndMixInAVX2(const float* InBuffer, float* BufferToSumTo, int32 NumSamples, float Gain)
+		{
+			const __m256 GainVector = _mm256_set1_ps(Gain);
+			int32 i = 0;
+			for (; i + 8 <= NumSamples; i += 8)
+			{
+				const __m256 Scaled = _mm256_mul_ps(_mm256_loadu_ps(InBuffer + i), GainVector);
+				_mm256_storeu_ps(BufferToSumTo + i, _mm256_add_ps(_mm256_loadu_ps(BufferToSumTo + i), Scaled));
+			}
+			GainAndMixInSSE2(InBuffer + i, BufferToSumTo + i, NumSamples - i, Gain);
+		}
+
+		MIXER_TARGET_AVX2 static void GainAndMixInMultipleAVX2(const float* const* InBuffers, const float* Gains, int32 NumBuffers, int32 InOffset, float* BufferToSumTo, int32 NumSamples)
+		{
+			for (int32 First = 0; First < NumBuffers; First += MultipleMixGroupSize)
+			{
+				const int32 NumInGroup = FMath::Min(MultipleMixGroupSize, NumBuffers - First);
+				const float* Buffers[MultipleMixGroupSize];
+				__m256 GainVectors[MultipleMixGroupSize];
+				for (int32 BufferIndex = 0; BufferIndex < NumInGroup; ++BufferIndex)
+				{
+					Buffers[BufferIndex] = InBuffers[First + BufferIndex] + InOffset;
+					GainVectors[BufferIndex] = _mm256_set1_ps(Gains[First + BufferIndex]);
+				}
+
+				int32 i = 0;
+				for (; i + 8 <= NumSamples; i += 8)
+				{
+					__m256 Sum = _mm256_loadu_ps(BufferToSumTo + i);
+					for (int32 BufferIndex = 0; BufferIndex < NumInGroup; ++BufferIndex)
+					{
+						Sum = _mm256_add_ps(Sum, _mm256_mul_ps(_mm256_loadu_ps(Buffers[BufferIndex] + i), GainVectors[BufferIndex]));
+					}
+					_mm256_storeu_ps(BufferToSumTo + i, Sum);
+				}
+				GainAndMixInMultipleSSE2(InBuffers + First, Gains + First, NumInGroup, InOffset + i, BufferToSumTo + i, NumSamples - i);
+			}
+		}
+
+		MIXER_TARGET_AVX2 static void FadeAndMixInAVX2(const float* InBuffer, float* BufferToSumTo, int32 NumSamples, float StartGain, float EndGain)
+		{
+			const float Delta = GetFadeDelta(NumSamples, StartGain, EndGain);
+			int32 i = 0;
+			for (; i + 8 <= NumSamples; i += 8)
+			{
+				const float GainA = GetFadeGain(i, StartGain, Delta);
+				const float GainB = GetFadeGain(i + 4, StartGain, Delta);
+				const __m256 GainVector = _mm256_setr_ps(GainA, GainA, GainA, GainA, GainB, GainB, GainB, GainB);
+				const __m256 Scaled = _mm256_mul_ps(_mm256_loadu_ps(InBuffer + i), GainVector);
+				_mm256_storeu_ps(BufferToSumTo + i, _mm256_add_ps(_mm256_loadu_ps(BufferToSumTo + i), Scaled));
+			}
+			for (; i < NumSamples; ++i)
+			{
+				BufferToSumTo[i] += InBuffer[i] * GetFadeGain(i, StartGain, Delta);
+			}
+		}
+
+		MIXER_TARGET_AVX2 static void MultiplyByConstantInPlaceAVX2(float* InOutBuffer, int32 NumSamples, float Gain)
+		{
+			const __m256 GainVector = _mm256_set1_ps(Gain);
+			int32 i = 0;
+			for (; i + 8 <= NumSamples; i += 8)
+			{
+				_mm256_storeu_ps(InOutBuffer + i, _mm256_mul_ps(_mm256_loadu_ps(InOutBuffer + i), GainVector));
+			}
+			MultiplyByConstantInPlaceSSE2(InOutBuffer + i, NumSamples - i, Gain);
+		}
+
+		MIXER_TARGET_AVX2 static void FadeInPlaceAVX2(float* InOutBuffer, int32 NumSamples, float StartGain, float EndGain)
+		{
+			const float Delta = GetFadeDelta(NumSamples, StartGain, EndGain);
+			int32 i = 0;
+			for (; i + 8 <= NumSamples; i += 8)
+			{
+				const float GainA = GetFadeGain(i, StartGain, Delta);
+				const float GainB = GetFadeGain(i + 4, StartGain, Delta);
+				const __m256 GainVector = _mm256_setr_ps(GainA, GainA, GainA, GainA, GainB, GainB, GainB, GainB);
+				_mm256_storeu_ps(InOutBuffer + i, _mm256_mul_ps(_mm256_loadu_ps(InOutBuffer + i), GainVector));
+			}
+			for (; i < NumSamples; ++i)
+			{
+				InOutBuffer[i] *= GetFadeGain(i, StartGain, Delta);
+			}
+		}
+
+		MIXER_TARGET_AVX2 static void RangeClampAVX2(float* InOutBuffer, int32 NumSamples, float MinValue, float MaxValue)
+		{
+			const __m256 MinVector = _mm256_set1_ps(MinValue);
+			const __m256 MaxVector = _mm256_set1_ps(MaxValue);
+			int32 i = 0;
+			for (; i + 8 <= NumSamples; i += 8)
+			{
+				_mm256_storeu_ps(InOutBuffer + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(InOutBuffer + i), MinVector), MaxVector));
+			}
+			RangeClampSSE2(InOutBuffer + i, NumSamples - i, MinValue, MaxValue);
+		}
+
+		MIXER_TARGET_AVX2 static void MixDownToMonoAVX2(const float* InBuffer, float* OutMonoBuffer, int32 NumFrames, int32 NumChannels)
+		{
+			if (NumChannels != 2)
+			{
+				MixDownToMonoScalar(InBuffer, OutMonoBuffer, NumFrames, NumChannels);
+				return;
+			}
+
+			const __m256 GainVector = _mm256_set1_ps(GetDownmixGain(2));
+			int32 FrameIndex = 0;
+			for (; FrameIndex + 8 <= NumFrames; FrameIndex += 8)
+			{
+				const __m256 FramesA = _mm256_loadu_ps(InBuffer + FrameIndex * 2);
+				const __m256 FramesB = _mm256_loadu_ps(InBuffer + FrameIndex * 2 + 8);
+
+				// The in-lane shuffles leave the frames in 0 1 4 5 2 3 6 7 order; the permute restores it.
+				const __m256 Left = _mm256_shuffle_ps(FramesA, FramesB, _MM_SHUFFLE(2, 0, 2, 0));
+				const __m256 Right = _mm256_shuffle_ps(FramesA, FramesB, _MM_SHUFFLE(3, 1, 3, 1));
+				const __m256 Sum = _mm256_mul_ps(_mm256_add_ps(Left, Right), GainVector);
+				_mm256_storeu_ps(OutMonoBuffer + FrameIndex, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(Sum), _MM_SHUFFLE(3, 1, 2, 0))));
+			}
+			MixDownToMonoSSE2(InBuffer + FrameIndex * 2, OutMonoBuffer + FrameIndex, NumFrames - FrameIndex, 2);
+		}
+
+		/** Vector version of GetDitherNoise for eight consecutive samples. */
+		MIXER_TARGET_AVX2 static FORCEINLINE __m256 GetDitherNoiseAVX2(uint32 SampleIndex)
+		{
+			__m256i Hash = _mm256_add_epi32(_mm256_set1_epi32((int32)SampleIndex), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+			Hash = _mm256_mullo_epi32(Hash, _mm256_set1_epi32((int32)DitherHashMultiplierA));
+			Hash = _mm256_xor_si256(Hash, _mm256_srli_epi32(Hash, 16));
+			Hash = _mm256_mullo_epi32(Hash, _mm256_set1_epi32((int32)DitherHashMultiplierB));
+			Hash = _mm256_xor_si256(Hash, _mm256_srli_epi32(Hash, 13));
+			const __m256i Difference = _mm256_sub_epi32(_mm256_srli_epi32(Hash, 16), _mm256_and_si256(Hash, _mm256_set1_epi32(0xFFFF)));
+			return _mm256_mul_ps(_mm256_cvtepi32_ps(Difference), _mm256_set1_ps(DitherNoiseScale));
+		}
+
+		/** Scales, dithers, clamps and truncates eight samples. */
+		template <typename FormatType>
+		MIXER_TARGET_AVX2 static FORCEINLINE __m256i ConvertVectorAVX2(const float* InSamples, __m256 Scale, float DitherAmount, uint32 DitherIndex)
+		{
+			__m256 Value = _mm256_mul_ps(_mm256_loadu_ps(InSamples), Scale);
+			if (DitherAmount != 0.0f)
+			{
+				Value = _mm256_add_ps(Value, _mm256_mul_ps(GetDitherNoiseAVX2(DitherIndex), _mm256_set1_ps(DitherAmount)));
+			}
+			Value = _mm256_min_ps(_mm256_max_ps(Value, _mm256_set1_ps(FormatType::MinValue)), _mm256_set1_ps(FormatType::MaxValue));
+			__m256i Result = _mm256_cvttps_epi32(Value);
+			if (FormatType::bSaturatesInIntegerRange)
+			{
+				Result = _mm256_xor_si256(Result, _mm256_castps_si256(_mm256_cmp_ps(Value, _mm256_set1_ps(FormatType::MaxValue), _CMP_GE_OQ)));
+				Result = _mm256_sub_epi32(Result, _mm256_castps_si256(_mm256_cmp_ps(Value, _mm256_set1_ps(FormatType::MinValue), _CMP_LE_OQ)));
+			}
+			return Result;
+		}
+
+		MIXER_TARGET_AVX2 static float MaxAbsAVX2(const float* InBuffer, int32 NumSamples)
+		{
+			const __m256 AbsMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+			__m256 MaxVector = _mm256_setzero_ps();
+			int32 i = 0;
+			for (; i + 8 <= NumSamples; i += 8)
+			{
+				MaxVector = _mm256_max_ps(MaxVector, _mm256_and_ps(_mm256_loadu_ps(InBuffer + i), AbsMask));
+			}
+
+			alignas(32) float Lanes[8];
+			_mm256_store_ps(Lanes, MaxVector);
+			float Max = 0.0f;
+			for (const float Lane : Lanes)
+			{
+				Max = FMath::Max(Max, Lane);
+			}
+			return FMath::Max(Max, MaxAbsSSE2(InBuffer + i, NumSamples - i));
+		}
+
+		MIXER_TARGET_AVX2 static float DotProductAVX2(const float* InA, const float* InB, int32 NumSamples)
+		{
+			__m256 Sum = _mm256_setzero_ps();
+			int32 i = 0;
+			for (; i + DotProductNumLanes <= NumSamples; i += DotProductNumLanes)
+			{
+				Sum = _mm256_add_ps(Sum, _mm256_mul_ps(_mm256_loadu_ps(InA + i), _mm256_loadu_ps(InB + i)));
+			}
+
+			alignas(32) float Lanes[DotProductNumLanes];
+			_mm256_store_ps(Lanes, Sum);
+			AccumulateDotProductTail(InA, InB, i, NumSamples, Lanes);
+			return ReduceDotProductLanes(Lanes);
+		}
+
+		/** Follows eight channels per vector (7.1 in one pass), then hands the rest to the SSE2 version. */
+		MIXER_TARGET_AVX2 static void FollowEnvelopeAVX2(const float* InBuffer, int32 NumFrames, int32 NumChannels, float* InOutEnvelopes, float AttackCoefficient, float ReleaseCoefficient, bool bMeanSquared)
+		{
+			const __m256 AbsMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+			const __m256 AttackVector = _mm256_set1_ps(AttackCoefficient);
+			const __m256 ReleaseVector = _mm256_set1_ps(ReleaseCoefficient);
+
+			int32 Channel = 0;
+			for (; Channel + 8 <= NumChannels; Channel += 8)
+			{
+				__m256 Envelope = _mm256_loadu_ps(InOutEnvelopes + Channel);
+				const float* Samples = InBuffer + Channel;
+				for (int32 Frame = 0; Frame < NumFrames; ++Frame, Samples += NumChannels)
+				{
+					const __m256 SampleVector = _mm256_loadu_ps(Samples);
+					const __m256 Input = bMeanSquared ? _mm256_mul_ps(SampleVector, SampleVector) : _mm256_and_ps(SampleVector, AbsMask);
+					const __m256 Coefficient = _mm256_blendv_ps(ReleaseVector, AttackVector, _mm256_cmp_ps(Input, Envelope, _CMP_GT_OQ));
+					Envelope = _mm256_add_ps(_mm256_mul_ps(Coefficient, _mm256_sub_ps(Envelope, Input)), Input);
+				}
+				_mm256_storeu_ps(InOutEnvelopes + Channel, Envelope);
+			}
+
+			FollowEnvelopeChannelsSSE2(InBuffer, NumFrames, NumChannels, Channel, InOutEnvelopes, AttackCoefficient, ReleaseCoefficient, bMeanSquared);
+		}
+
+		MIXER_TARGET_AVX2 static void DeinterleaveAVX2(const float* InBuffer, float* OutLanes, int32 LaneStride, int32 NumFrames, int32 NumChannels)
+		{
+			if (NumChannels != 2)
+			{
+				DeinterleaveSSE2(InBuffer, OutLanes, LaneStride, NumFrames, NumChannels);
+				return;
+			}
+
+			float* LeftLane = OutLanes;
+			float* RightLane = OutLanes + LaneStride;
+			int32 FrameIndex = 0;
+			for (; FrameIndex + 8 <= NumFrames; FrameIndex += 8)
+			{
+				const __m256 FramesA = _mm256_loadu_ps(InBuffer + FrameIndex * 2);
+				const __m256 FramesB = _mm256_loadu_ps(InBuffer + FrameIndex * 2 + 8);
+
+				// As in MixDownToMonoAVX2, the permute puts the frames back in order after the in-lane shuffles.
+				const __m256 Left = _mm256_shuffle_ps(FramesA, FramesB, _MM_SHUFFLE(2, 0, 2, 0));
+				const __m256 Right = _mm256_shuffle_ps(FramesA, FramesB, _MM_SHUFFLE(3, 1, 3, 1));
+				_mm256_storeu_ps(LeftLane + FrameIndex, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(Left), _MM_SHUFFLE(3, 1, 2, 0))));
+				_mm256_storeu_ps(RightLane + FrameIndex, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(Right), _MM_SHUFFLE(3, 1, 2, 0))));
+			}
+			DeinterleaveSSE2(InBuffer + FrameIndex * 2, OutLanes + FrameIndex, LaneStride, NumFrames - FrameIndex, 2);
+		}
+
+		MIXER_TARGET_AVX2 static void InterleaveAVX2(const float* InLanes, int32 LaneStride, float* OutBuffer, int32 NumFrames, int32 NumChannels)
+		{
+			if (NumChannels != 2)
+			{
+				InterleaveSSE2(InLanes, LaneStride, OutBuffer, NumFrames, NumChannels);
+				return;
+			}
+
+			const float* LeftLane = InLanes;
+			const float* RightLane = InLanes + LaneStride;
+			int32 FrameIndex = 0;
+			for (; FrameIndex + 8 <= NumFrames; FrameIndex += 8)
+			{
+				const __m256 Left = _mm256_loadu_ps(LeftLane + FrameIndex);
+				const __m256 Right = _mm256_loadu_ps(RightLane + FrameIndex);
+
+				// The unpacks interleave within each 128 bit half, so frames 0-1 and 4-5 land in Low and 2-3 and 6-7 in High.
+				const __m256 Low = _mm256_unpacklo_ps(Left, Right);
+				const __m256 High = _mm256_unpackhi_ps(Left, Right);
+				_mm256_storeu_ps(OutBuffer + FrameIndex * 2, _mm256_permute2f128_ps(Low, High, 0x20));
+				_mm256_storeu_ps(OutBuffer + FrameIndex * 2 + 8, _mm256_permute2f128_ps(Low, High, 0x31));
+			}
+			InterleaveSSE2(InLanes + FrameIndex, LaneStride, OutBuffer + FrameIndex * 2, NumFrames - FrameIndex, 2);
+		}
+
+		MIXER_TARGET_AVX2 static void ConvertToFloatAVX2(const float* InBuffer, float* OutBuffer, int32 NumSamples, float Gain)
+		{
+			const __m256 GainVector = _mm256_set1_ps(Gain);
+			const __m256 MinVector = _mm256_set1_ps(-1.0f);
+			const __m256 MaxVector = _mm256_set1_ps(1.0f);
+			int32 i = 0;
+			for (; i + 8 <= NumSamples; i += 8)
+			{
+				_mm256_storeu_ps(OutBuffer + i, _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(InBuffer + i), GainVector), MinVector), MaxVector));
+			}
+			ConvertToFloatSSE2(InBuffer + i, OutBuffer + i, NumSamples - i, Gain);
+		}
+
+		MIXER_TARGET_AVX2 static void ConvertToInt16AVX2(const float* InBuffer, int16* OutBuffer, int32 NumSamples, float Gain, float DitherAmount, uint32 DitherSeed)
+		{
+			const __m256 Scale = _mm256_set1_ps(Gain * FInt16Format::FullScale);
+			int32 i = 0;
+			for (; i + 16 <= NumSamples; i += 16)
+			{
+				const __m256i Low = ConvertVectorAVX2<FInt16Format>(InBuffer + i, Scale, DitherAmount, DitherSeed + i);
+				const __m256i High = ConvertVectorAVX2<FInt16Format>(InBuffer + i + 8, Scale, DitherAmount, DitherSeed + i + 8);
+
+				// The in-lane pack interleaves the halves of the two vectors; the permute restores sample order.
+				const __m256i Packed = _mm256_packs_epi32(Low, High);
+				_mm256_storeu_si256((__m256i*)(OutBuffer + i), _mm256_permute4x64_epi64(Packed, _MM_SHUFFLE(3, 1, 2, 0)));
+			}
+			ConvertToInt16SSE2(InBuffer + i, OutBuffer + i, NumSamples - i, Gain, DitherAmount, DitherSeed + i);
+		}
+
+		MIXER_TARGET_AVX2 static void ConvertToInt24AVX2(const float* InBuffer, uint8* OutBuffer, int32 NumSamples, float Gain, float DitherAmount, uint32 DitherSeed)
+		{
+			const __m256 Scale = _mm256_set1_ps(Gain * FInt24Format::FullScale);
+
+			// Drop the top byte of each sample within each lane, move the two 12 byte runs next to each other,
+			// then store only the 24 bytes that hold samples.
+			const __m256i PackBytes = _mm256_setr_epi8(
+				0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+				0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+			const __m256i PackLanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+			const __m256i StoreMask = _mm256_setr_epi32(-1, -1, -1, -1, -1, -1, 0, 0);
+
+			int32 i = 0;
+			for (; i + 8 <= NumSamples; i += 8)
+			{
+				const __m256i Converted = ConvertVectorAVX2<FInt24Format>(InBuffer + i, Scale, DitherAmount, DitherSeed + i);
+				const __m256i Packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(Converted, PackBytes), PackLanes);
+				_mm256_maskstore_epi32((int*)(OutBuffer + i * 3), StoreMask, Packed);
+			}
+			ConvertToInt24SSE2(InBuffer + i, OutBuffer + i * 3, NumSamples - i, Gain, DitherAmount, DitherSeed + i);
+		}
+
+		MIXER_TARGET_AVX2 static void ConvertToInt32AVX2(const float* InBuffer, int32* OutBuffer, int32 NumSamples, float Gain, float DitherAmount, uint32 DitherSeed)
+		{
+			const __m256 Scale = _mm256_set1_ps(Gain * FInt32Format::FullScale);
+			int32 i = 0;
+			for (; i + 8 <= NumSamples; i += 8)
+			{
+				_mm256_storeu_si256((__m256i*)(OutBuffer + i), ConvertVectorAVX2<FInt32Format>(InBuffer + i, Scale, DitherAmount, DitherSeed + i));
+			}
+			ConvertToInt32SSE2(InBuffer + i, OutBuffer + i, NumSamples - i, Gain, DitherAmount, DitherSeed + i);
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// AVX-512
+
+		MIXER_TARGET_AVX512 static void MixInAVX512(const float* InBuffer, float* BufferToSumTo, int32 NumSamples)
+		{
+			int32 i = 0;
+			for (; i + 16 <= NumSamples; i += 16)
+			{
+				_mm512_storeu_ps(BufferToSumTo + i, _mm512_add_ps(_mm512_loadu_ps(BufferToSumTo + i), _mm512_loadu_ps(InBuffer + i)));
+			}
+			MixInSSE2(InBuffer + i, BufferToSumTo + i, NumSamples - i);
+		}
+
+		MIXER_TARGET_AVX512 static void GainAndMixInAVX512(const float* InBuffer, float* BufferToSumTo, int32 NumSamples, float Gain)
+		{
+			const __m512 GainVector = _mm512_set1_ps(Gain);
+			int32 i = 0;
+			for (; i + 16 <= NumSamples; i += 16)
+			{
+				const __m512 Scaled = _mm512_mul_ps(_mm512_loadu_ps(InBuffer + i), GainVector);
+				_mm512_storeu_ps(BufferToSumTo + i, _mm512_add_ps(_mm512_loadu_ps(BufferToSumTo + i), Scaled));
+			}
+			GainAndMixInSSE2(InBuffer + i, BufferToSumTo + i, NumSamples - i, Gain);
+		}
+
+		MIXER_TARGET_AVX512 static void GainAndMixInMultipleAVX512(const float* const* InBuffers, const float* Gains, int32 NumBuffers, int32 InOffset, float* BufferToSumTo, int32 NumSamples)
+		{
+			for (int32 First = 0; First < NumBuffers; First += MultipleMixGroupSize)
+			{
+				const int32 NumInGroup = FMath::Min(MultipleMixGroupSize, NumBuffers - First);
+				const float* Buffers[MultipleMixGroupSize];
+				__m512 GainVectors[MultipleMixGroupSize];
+				for (int32 BufferIndex = 0; BufferIndex < NumInGroup; ++BufferIndex)
+				{
+					Buffers[BufferIndex] = InBuffers[First + BufferIndex] + InOffset;
+					GainVectors[BufferIndex] = _mm512_set1_ps(Gains[First + BufferIndex]);
+				}
+
+				int32 i = 0;
+				for (; i + 16 <= NumSamples; i += 16)
+				{
+					__m512 Sum = _mm512_loadu_ps(BufferToSumTo + i);
+					for (int32 BufferIndex = 0; BufferIndex < NumInGroup; ++BufferIndex)
+					{
+						Sum = _mm512_add_ps(Sum, _mm512_mul_ps(_mm512_loadu_ps(Buffers[BufferIndex] + i), GainVectors[BufferIndex]));
+					}
+					_mm512_storeu_ps(BufferToSumTo + i, Sum);
+				}
+				GainAndMixInMultipleSSE2(InBuffers + First, Gains + First, NumInGroup, InOffset + i, BufferToSumTo + i, NumSamples - i);
+			}
+		}
+
+		/** Builds the gain vector for the four groups of samples starting at SampleIndex. */
+		MIXER_TARGET_AVX512 static FORCEINLINE __m512 GetFadeGainVectorAVX512(int32 SampleIndex, float StartGain, float Delta)
+		{
+			const float Gain0 = GetFadeGain(SampleIndex, StartGain, Delta);
+			const float Gain1 = GetFadeGain(SampleIndex + 4, StartGain, Delta);
+			const float Gain2 = GetFadeGain(SampleIndex + 8, StartGain, Delta);
+			const float Gain3 = GetFadeGain(SampleIndex + 12, StartGain, Delta);
+			return _mm512_setr_ps(Gain0, Gain0, Gain0, Gain0, Gain1, Gain1, Gain1, Gain1, Gain2, Gain2, Gain2, Gain2, Gain3, Gain3, Gain3, Gain3);
+		}
+
+		MIXER_TARGET_AVX512 static void FadeAndMixInAVX512(const float* InBuffer, float* BufferToSumTo, int32 NumSamples, float StartGain, float EndGain)
+		{
+			const float Delta = GetFadeDelta(NumSamples, StartGain, EndGain);
+			int32 i = 0;
+			for (; i + 16 <= NumSamples; i += 16)
+			{
+				const __m512 Scaled = _mm512_mul_ps(_mm512_loadu_ps(InBuffer + i), GetFadeGainVectorAVX512(i, StartGain, Delta));
+				_mm512_storeu_ps(BufferToSumTo + i, _mm512_add_ps(_mm512_loadu_ps(BufferToSumTo + i), Scaled));
+			}
+			for (; i < NumSamples; ++i)
+			{
+				BufferToSumTo[i] += InBuffer[i] * GetFadeGain(i, StartGain, Delta);
+			}
+		}
+
+		MIXER_TARGET_AVX512 static void MultiplyByConstantInPlaceAVX512(float* InOutBuffer, int32 NumSamples, float Gain)
+		{
+			const __m512 GainVector = _mm512_set1_ps(Gain);
+			int32 i = 0;
+			for (; i + 16 <= NumSamples; i += 16)
+			{
+				_mm512_storeu_ps(InOutBuffer + i, _mm512_mul_ps(_mm512_loadu_ps(InOutBuffer + i), GainVector));
+			}
+			MultiplyByConstantInPlaceSSE2(InOutBuffer + i, NumSamples - i, Gain);
+		}
+
+		MIXER_TARGET_AVX512 static void FadeInPlaceAVX512(float* InOutBuffer, int32 NumSamples, float StartGain, float EndGain)
+		{
+			const float Delta = GetFadeDelta(NumSamples, StartGain, EndGain);
+			int32 i = 0;
+			for (; i + 16 <= NumSamples; i += 16)
+			{
+				_mm512_storeu_ps(InOutBuffer + i, _mm512_mul_ps(_mm512_loadu_ps(InOutBuffer + i), GetFadeGainVectorAVX512(i, StartGain, Delta)));
+			}
+			for (; i < NumSamples; ++i)
+			{
+				InOutBuffer[i] *= GetFadeGain(i, StartGain, Delta);
+			}
+		}
+
+		MIXER_TARGET_AVX512 static void RangeClampAVX512(float* InOutBuffer, int32 NumSamples, float MinValue, float MaxValue)
+		{
+			const __m512 MinVector = _mm512_set1_ps(MinValue);
+			const __m512 MaxVector = _mm512_set1_ps(MaxValue);
+			int32 i = 0;
+			for (; i + 16 <= NumSamples; i += 16)
+			{
+				_mm512_storeu_ps(InOutBuffer + i, _mm512_min_ps(_mm512_max_ps(_mm512_loadu_ps(InOutBuffer + i), MinVector), MaxVector));
+			}
+			RangeClampSSE2(InOutBuffer + i, NumSamples - i, MinValue, MaxValue);
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// CPU feature detection
+
+		static bool CpuSupportsAVX2()
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+			int32 CpuInfo[4];
+			__cpuid(CpuInfo, 0);
+			if (CpuInfo[0] < 7)
+			{
+				return false;
+			}
+
+			// AVX state must be enabled by the OS (OSXSAVE, then XCR0 bits 1 and 2).
+			__cpuid(CpuInfo, 1);
+			if ((CpuInfo[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+			{
+				return false;
+			}
+
+			__cpuidex(CpuInfo, 7, 0);
+			return (CpuInfo[1] & (1 << 5)) != 0;
+#else
+			return false;
+#endif
+		}
+
+		static bool CpuSupportsAVX512()
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return __builtin_cpu_supports("avx512f");
+#elif defined(_MSC_VER)
+			if (!CpuSupportsAVX2())
+			{
+				return false;
+			}
+
+			// Opmask and ZMM state must be enabled by the OS as well (XCR0 bits 5 to 7).
+			if ((_xgetbv(0) & 0xE6) != 0xE6)
+			{
+				return false;
+			}
+
+			int32 CpuInfo[4];
+			__cpuidex(CpuInfo, 7, 0);
+			return (CpuInfo[1] & (1 << 16)) != 0;
+#else
+			return false;
+#endif
+		}
+#endif // MIXER_KERNELS_X86
+
+		static const FMixerKernels ScalarKernels =
+		{
+			EMixerKernelIsa::Scalar, TEXT("Scalar"),
+			MixInScalar, GainAndMixInScalar, GainAndMixInMultipleScalar, FadeAndMixInScalar, MultiplyByConstantInPlaceScalar, FadeInPlaceScalar, RangeClampScalar, MixDownToMonoScalar,
+			MaxAbsScalar, DotProductScalar, FollowEnvelopeScalar, DeinterleaveScalar, InterleaveScalar, ConvertToFloatScalar, ConvertToInt16Scalar, ConvertToInt24Scalar, ConvertToInt32Scalar
+		};
+
+#if MIXER_KERNELS_X86
+		static const FMixerKernels SSE2Kernels =
+		{
+			EMixerKernelIsa::SSE2, TEXT("SSE2"),
+			MixInSSE2, GainAndMixInSSE2, GainAndMixInMultipleSSE2, FadeAndMixInSSE2, MultiplyByConstantInPlaceSSE2, FadeInPlaceSSE2, RangeClampSSE2, MixDownToMonoSSE2,
+			MaxAbsSSE2, DotProductSSE2, FollowEnvelopeSSE2, DeinterleaveSSE2, InterleaveSSE2, ConvertToFloatSSE2, ConvertToInt16SSE2, ConvertToInt24SSE2, ConvertToInt32SSE2
+		};
+
+		static const FMixerKernels AVX2Kernels =
+		{
+			EMixerKernelIsa::AVX2, TEXT("AVX2"),
+			MixInAVX2, GainAndMixInAVX2, GainAndMixInMultipleAVX2, FadeAndMixInAVX2, MultiplyByConstantInPlaceAVX2, FadeInPlaceAVX2, RangeClampAVX2, MixDownToMonoAVX2,
+			MaxAbsAVX2, DotProductAVX2, FollowEnvelopeAVX2, DeinterleaveAVX2, InterleaveAVX2, ConvertToFloatAVX2, ConvertToInt16AVX2, ConvertToInt24AVX2, ConvertToInt32AVX2
+		};
+
+		// The stereo downmix, (de)interleaving, MaxAbs and the output conversions are memory bound or shuffle heavy, and the envelope follower is bound by its
+		// per-frame dependency chain and rarely has 16 channels, so they gain nothing over AVX2. DotProduct stays on eight lanes to keep its summation order.
+		static const FMixerKernels AVX512Kernels =
+		{
+			EMixerKernelIsa::AVX512, TEXT("AVX-512"),
+			MixInAVX512, GainAndMixInAVX512, GainAndMixInMultipleAVX512, FadeAndMixInAVX512, MultiplyByConstantInPlaceAVX512, FadeInPlaceAVX512, RangeClampAVX512, MixDownToMonoAVX2,
+			MaxAbsAVX2, DotProductAVX2, FollowEnvelopeAVX2, DeinterleaveAVX2, InterleaveAVX2, ConvertToFloatAVX2, ConvertToInt16AVX2, ConvertToInt24AVX2, ConvertToInt32AVX2
+		};
+#endif
+
+		/** Layouts with specialized channel kernels: mono, stereo, 5.1, 7.1 and 7.1.4. The first entry of each table is the generic fallback. */
+		static constexpr int32 NumChannelKernelLayouts = 5;
+
+		static const FMixerChannelKernels ScalarChannelKernels[NumChannelKernelLayouts + 1] =
+		{
+			{ 0, MixDownToMonoScalar, FollowEnvelopeScalar },
+			{ 1, MixDownToMonoFixedScalar<1>, FollowEnvelopeFixedScalar<1> },
+			{ 2, MixDownToMonoFixedScalar<2>, FollowEnvelopeFixedScalar<2> },
+			{ 6, MixDownToMonoFixedScalar<6>, FollowEnvelopeFixedScalar<6> },
+			{ 8, MixDownToMonoFixedScalar<8>, FollowEnvelopeFixedScalar<8> },
+			{ 12, MixDownToMonoFixedScalar<12>, FollowEnvelopeFixedScalar<12> }
+		};
+
+#if MIXER_KERNELS_X86
+		static const FMixerChannelKernels SSE2ChannelKernels[NumChannelKernelLayouts + 1] =
+		{
+			{ 0, MixDownToMonoSSE2, FollowEnvelopeSSE2 },
+			{ 1, MixDownToMonoFixedSSE2<1>, FollowEnvelopeFixedSSE2<1> },
+			{ 2, MixDownToMonoSSE2, FollowEnvelopeFixedSSE2<2> },
+			{ 6, MixDownToMonoFixedSSE2<6>, FollowEnvelopeFixedSSE2<6> },
+			{ 8, MixDownToMonoFixedSSE2<8>, FollowEnvelopeFixedSSE2<8> },
+			{ 12, MixDownToMonoFixedSSE2<12>, FollowEnvelopeFixedSSE2<12> }
+		};
+
+		// Keeping every envelope of a frame in registers already overlaps the dependency chains, and the transposing
+		// downmix is bound by its loads, so wider vectors only pay off for the stereo downmix. AVX-512 uses this table too.
+		static const FMixerChannelKernels AVX2ChannelKernels[NumChannelKernelLayouts + 1] =
+		{
+			{ 0, MixDownToMonoAVX2, FollowEnvelopeAVX2 },
+			{ 1, MixDownToMonoFixedSSE2<1>, FollowEnvelopeFixedSSE2<1> },
+			{ 2, MixDownToMonoAVX2, FollowEnvelopeFixedSSE2<2> },
+			{ 6, MixDownToMonoFixedSSE2<6>, FollowEnvelopeFixedSSE2<6> },
+			{ 8, MixDownToMonoFixedSSE2<8>, FollowEnvelopeFixedSSE2<8> },
+			{ 12, MixDownToMonoFixedSSE2<12>, FollowEnvelopeFixedSSE2<12> }
+		};
+#endif
+
+		static const FMixerChannelKernels* SelectChannelKernels()
+		{
+			switch (GetMixerKernels().Isa)
+			{
+#if MIXER_KERNELS_X86
+			case EMixerKernelIsa::SSE2:
+				return SSE2ChannelKernels;
+
+			case EMixerKernelIsa::AVX2:
+			case EMixerKernelIsa::AVX512:
+				return AVX2ChannelKernels;
+#endif
+
+			default:
+				return ScalarChannelKernels;
+			}
+		}
+
+		static const FMixerKernels& SelectKernels()
+		{
+			const FMixerKernels* Kernels = GetMixerKernelsForIsa(EMixerKernelIsa::AVX512);
+			if (!Kernels)
+			{
+				Kernels = GetMixerKernelsForIsa(EMixerKernelIsa::AVX2);
+			}
+			if (!Kernels)
+			{
+				Kernels = GetMixerKernelsForIsa(EMixerKernelIsa::SSE2);
+			}
+			if (!Kernels)
+			{
+				Kernels = &ScalarKernels;
+			}
+
+			UE_LOG(LogAudioMixer, Display, TEXT("Audio mixer kernels: %s"), Kernels->Name);
+			return *Kernels;
+		}
+	}
+
+	const FMixerKernels& GetMixerKernels()
+	{
+		static const FMixerKernels& Kernels = MixerKernels::SelectKernels();
+		return Kernels;
+	}
+
+	const FMixerKernels* GetMixerKernelsForIsa(EMixerKernelIsa InIsa)
+	{
+		switch (InIsa)
+		{
+		case EMixerKernelIsa::Scalar:
+			return &MixerKernels::ScalarKernels;
+
+#if MIXER_KERNELS_X86
+		case EMixerKernelIsa::SSE2:
+			return &MixerKernels::SSE2Kernels;
+
+		case EMixerKernelIsa::AVX2:
+			return MixerKernels::CpuSupportsAVX2() ? &MixerKernels::AVX2Kernels : nullptr;
+
+		case EMixerKernelIsa::AVX512:
+			return MixerKernels::CpuSupportsAVX512() ? &MixerKernels::AVX512Kernels : nullptr;
+#endif
+
+		default:
+			return nullptr;
+		}
+	}
+
+	const FMixerChannelKernels& GetMixerChannelKernels(int32 NumChannels)
+	{
+		static const FMixerChannelKernels* const ChannelKernels = MixerKernels::SelectChannelKernels();
+		for (int32 Layout = 1; Layout <= MixerKernels::NumChannelKernelLayouts; ++Layout)
+		{
+			if (ChannelKernels[Layout].NumChannels == NumChannels)
+			{
+				return ChannelKernels[Layout];
+			}
+		}
+		return ChannelKernels[0];
+	}
+}
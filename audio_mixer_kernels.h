@@ -0,0 +1,128 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace Audio
+{
+	/** Instruction sets the mixer kernels are implemented for. */
+	enum class EMixerKernelIsa : uint8
+	{
+		Scalar,
+		SSE2,
+		AVX2,
+		AVX512
+	};
+
+	/**
+	 * Table of mixing primitives for one instruction set.
+	 *
+	 * All kernels take unaligned pointers and any sample count. Fades step the gain once per
+	 * group of four samples, like FadeBufferFast, and every implementation computes the gain of a
+	 * group as StartGain + Delta * GroupIndex, so all instruction sets produce the same results as
+	 * the scalar reference.
+	 */
+	struct FMixerKernels
+	{
+		/** The instruction set these kernels were compiled for. */
+		EMixerKernelIsa Isa;
+
+		/** Readable name of the instruction set. */
+		const TCHAR* Name;
+
+		/** BufferToSumTo[i] += InBuffer[i] */
+		void (*MixIn)(const float* InBuffer, float* BufferToSumTo, int32 NumSamples);
+
+		/** BufferToSumTo[i] += InBuffer[i] * Gain */
+		void (*GainAndMixIn)(const float* InBuffer, float* BufferToSumTo, int32 NumSamples, float Gain);
+
+		/**
+		 * BufferToSumTo[i] += InBuffers[b][InOffset + i] * Gains[b] for every buffer, added in order, as NumBuffers
+		 * GainAndMixIn calls would. Groups of buffers are summed in registers, so BufferToSumTo is loaded and
+		 * stored once per group rather than once per buffer.
+		 */
+		void (*GainAndMixInMultiple)(const float* const* InBuffers, const float* Gains, int32 NumBuffers, int32 InOffset, float* BufferToSumTo, int32 NumSamples);
+
+		/** BufferToSumTo[i] += InBuffer[i] * Fade(i), with the fade going from StartGain to EndGain. */
+		void (*FadeAndMixIn)(const float* InBuffer, float* BufferToSumTo, int32 NumSamples, float StartGain, float EndGain);
+
+		/** InOutBuffer[i] *= Gain */
+		void (*MultiplyByConstantInPlace)(float* InOutBuffer, int32 NumSamples, float Gain);
+
+		/** InOutBuffer[i] *= Fade(i), with the fade going from StartGain to EndGain. */
+		void (*FadeInPlace)(float* InOutBuffer, int32 NumSamples, float StartGain, float EndGain);
+
+		/** Clamps every sample to [MinValue, MaxValue]. */
+		void (*RangeClamp)(float* InOutBuffer, int32 NumSamples, float MinValue, float MaxValue);
+
+		/** Sums the channels of each interleaved frame into OutMonoBuffer, scaled by 1/sqrt(NumChannels) to preserve power. */
+		void (*MixDownToMono)(const float* InBuffer, float* OutMonoBuffer, int32 NumFrames, int32 NumChannels);
+
+		/** Returns the largest absolute sample value, or 0 for an empty buffer. */
+		float (*MaxAbs)(const float* InBuffer, int32 NumSamples);
+
+		/**
+		 * Returns the sum of InA[i] * InB[i]. Products are added into eight partial sums (sample i goes to sum i % 8),
+		 * which are then folded in a fixed order, so every instruction set returns the same value.
+		 */
+		float (*DotProduct)(const float* InA, const float* InB, int32 NumSamples);
+
+		/**
+		 * Runs a one-pole envelope follower over every channel of an interleaved buffer. Each frame, a channel's
+		 * input is |x| (or x * x when bMeanSquared is set) and its envelope moves towards it by
+		 * Envelope = Coefficient * (Envelope - Input) + Input, using AttackCoefficient while the input is above the
+		 * envelope and ReleaseCoefficient otherwise. InOutEnvelopes holds one value per channel.
+		 */
+		void (*FollowEnvelope)(const float* InBuffer, int32 NumFrames, int32 NumChannels, float* InOutEnvelopes, float AttackCoefficient, float ReleaseCoefficient, bool bMeanSquared);
+
+		/** Splits an interleaved buffer into planar lanes: channel c of frame i goes to OutLanes[c * LaneStride + i]. */
+		void (*Deinterleave)(const float* InBuffer, float* OutLanes, int32 LaneStride, int32 NumFrames, int32 NumChannels);
+
+		/** The inverse of Deinterleave: OutBuffer[i * NumChannels + c] = InLanes[c * LaneStride + i]. */
+		void (*Interleave)(const float* InLanes, int32 LaneStride, float* OutBuffer, int32 NumFrames, int32 NumChannels);
+
+		/** OutBuffer[i] = Clamp(InBuffer[i] * Gain, -1, 1), the float output stage. */
+		void (*ConvertToFloat)(const float* InBuffer, float* OutBuffer, int32 NumSamples, float Gain);
+
+		/**
+		 * Output conversion: scales each sample by Gain to the integer range, adds TPDF dither of DitherAmount
+		 * LSBs (0 disables it), clamps and truncates. DitherSeed is the index of the first sample in the dither
+		 * sequence; advance it by NumSamples per call so consecutive blocks get different noise.
+		 */
+		void (*ConvertToInt16)(const float* InBuffer, int16* OutBuffer, int32 NumSamples, float Gain, float DitherAmount, uint32 DitherSeed);
+
+		/** As ConvertToInt16, writing packed little-endian 24 bit samples (3 bytes each). */
+		void (*ConvertToInt24)(const float* InBuffer, uint8* OutBuffer, int32 NumSamples, float Gain, float DitherAmount, uint32 DitherSeed);
+
+		/** As ConvertToInt16, writing 32 bit samples. */
+		void (*ConvertToInt32)(const float* InBuffer, int32* OutBuffer, int32 NumSamples, float Gain, float DitherAmount, uint32 DitherSeed);
+	};
+
+	/**
+	 * Kernels that loop over the channels of each frame, compiled for one channel count so the channel
+	 * loops unroll and the frame stride is a constant.
+	 *
+	 * Mono, stereo, 5.1, 7.1 and 7.1.4 have specialized versions; any other channel count gets the generic
+	 * kernels of FMixerKernels. Both take the same arguments and produce the same results, so callers look
+	 * the table up once per block (or when their layout changes) and call through it unconditionally.
+	 */
+	struct FMixerChannelKernels
+	{
+		/** The channel count the kernels were compiled for, or 0 for the generic fallback. */
+		int32 NumChannels;
+
+		/** As FMixerKernels::MixDownToMono. */
+		void (*MixDownToMono)(const float* InBuffer, float* OutMonoBuffer, int32 NumFrames, int32 NumChannels);
+
+		/** As FMixerKernels::FollowEnvelope. */
+		void (*FollowEnvelope)(const float* InBuffer, int32 NumFrames, int32 NumChannels, float* InOutEnvelopes, float AttackCoefficient, float ReleaseCoefficient, bool bMeanSquared);
+	};
+
+	/** Returns the kernels for the best instruction set supported by the CPU. Selected once, on first use. */
+	const FMixerKernels& GetMixerKernels();
+
+	/** Returns the kernels for the given instruction set, or nullptr if they are not available in this build or on this CPU. */
+	const FMixerKernels* GetMixerKernelsForIsa(EMixerKernelIsa InIsa);
+
+	/** Returns the channel kernels for the given channel count, on the instruction set GetMixerKernels selected. */
+	const FMixerChannelKernels& GetMixerChannelKernels(int32 NumChannels);
+}
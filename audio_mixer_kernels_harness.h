@@ -0,0 +1,490 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformTime.h"
+#include "audio_mixer_kernels.h"
+
+namespace Audio
+{
+	/** Speed of one kernel on one instruction set. */
+	struct FMixerKernelBenchmarkResult
+	{
+		/** Name of the FMixerKernels member that was timed. */
+		const TCHAR* Kernel = nullptr;
+
+		EMixerKernelIsa Isa = EMixerKernelIsa::Scalar;
+
+		/** Samples (or frames, for the channel kernels) per call. */
+		int32 NumSamples = 0;
+
+		double NanosecondsPerCall = 0.0;
+		double SamplesPerSecond = 0.0;
+
+		/** Time of the scalar reference divided by this kernel's time. */
+		double SpeedupOverScalar = 0.0;
+	};
+
+	namespace KernelHarness
+	{
+		/** Sample counts every kernel is checked at: empty, every remainder around the vector widths, and whole blocks. */
+		static constexpr int32 NumSamplesToCheck[] = { 0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 47, 63, 64, 65, 127, 128, 129, 255, 256, 257, 1023, 1024 };
+
+		/** Offsets of the buffers from the start of their storage, in floats, so unaligned loads and stores are hit too. */
+		static constexpr int32 OffsetsToCheck[] = { 0, 1, 2, 3, 5, 7 };
+
+		static constexpr int32 MaxNumSamples = 1024;
+		static constexpr int32 MaxNumChannels = 12;
+		static constexpr int32 MaxOffset = 8;
+
+		/** Floats past the end of every output that must come back untouched. */
+		static constexpr int32 NumGuardFloats = 16;
+
+		/** Buffers summed by the GainAndMixInMultiple check, more than one register group of every instruction set. */
+		static constexpr int32 MaxNumMixBuffers = 19;
+
+		static constexpr int32 BufferSize = MaxOffset + MaxNumSamples * MaxNumChannels + NumGuardFloats;
+
+		/** Deterministic noise in [-InAmplitude, InAmplitude]. */
+		inline void FillNoise(TArray<float>& OutBuffer, uint32 InSeed, float InAmplitude)
+		{
+			uint32 State = InSeed * 747796405u + 2891336453u;
+			for (int32 Index = 0; Index < OutBuffer.Num(); ++Index)
+			{
+				State ^= State << 13;
+				State ^= State >> 17;
+				State ^= State << 5;
+				OutBuffer[Index] = InAmplitude * ((State >> 8) * (2.0f / 16777216.0f) - 1.0f);
+			}
+		}
+
+		/** Inputs and two copies of the output storage, the reference's and the tested kernel's. */
+		struct FCheckBuffers
+		{
+			TArray<float> InputA;
+			TArray<float> InputB;
+			TArray<float> InitialOutput;
+			TArray<float> ReferenceOutput;
+			TArray<float> TestedOutput;
+
+			explicit FCheckBuffers(uint32 InSeed)
+			{
+				InputA.SetNumUninitialized(BufferSize);
+				InputB.SetNumUninitialized(BufferSize);
+				InitialOutput.SetNumUninitialized(BufferSize);
+				ReferenceOutput.SetNumUninitialized(BufferSize);
+				TestedOutput.SetNumUninitialized(BufferSize);
+
+				// Inputs reach past full scale, so the clamps of the output stages are exercised.
+				FillNoise(InputA, InSeed, 1.5f);
+				FillNoise(InputB, InSeed + 1, 1.5f);
+				FillNoise(InitialOutput, InSeed + 2, 1.0f);
+			}
+		};
+
+		/**
+		 * Runs InReferenceCall and InTestedCall on the same inputs and the same prefilled output, as
+		 * Call(const float* InA, const float* InB, float* Out), and compares InNumOutputFloats outputs
+		 * and the guard after them bit for bit.
+		 *
+		 * @return An empty string if they match, or a description of the first difference.
+		 */
+		template<typename ReferenceCallType, typename TestedCallType>
+		FString CompareCalls(FCheckBuffers& Buffers, const FString& InDescription, int32 InOffset, int32 InNumOutputFloats, ReferenceCallType&& InReferenceCall, TestedCallType&& InTestedCall)
+		{
+			check(InOffset + InNumOutputFloats + NumGuardFloats <= BufferSize);
+
+			// Inputs and outputs get different alignments.
+			const int32 OutputOffset = (InOffset * 5) % MaxOffset;
+			const int32 NumCompared = InNumOutputFloats + NumGuardFloats;
+
+			FMemory::Memcpy(Buffers.ReferenceOutput.GetData(), Buffers.InitialOutput.GetData(), BufferSize * sizeof(float));
+			FMemory::Memcpy(Buffers.TestedOutput.GetData(), Buffers.InitialOutput.GetData(), BufferSize * sizeof(float));
+
+			InReferenceCall(Buffers.InputA.GetData() + InOffset, Buffers.InputB.GetData() + InOffset, Buffers.ReferenceOutput.GetData() + OutputOffset);
+			InTestedCall(Buffers.InputA.GetData() + InOffset, Buffers.InputB.GetData() + InOffset, Buffers.TestedOutput.GetData() + OutputOffset);
+
+			const uint32* ReferenceBits = reinterpret_cast<const uint32*>(Buffers.ReferenceOutput.GetData() + OutputOffset);
+			const uint32* TestedBits = reinterpret_cast<const uint32*>(Buffers.TestedOutput.GetData() + OutputOffset);
+			const uint32* InitialBits = reinterpret_cast<const uint32*>(Buffers.InitialOutput.GetData() + OutputOffset);
+
+			for (int32 Index = 0; Index < NumCompared; ++Index)
+			{
+				if (Index >= InNumOutputFloats && TestedBits[Index] != InitialBits[Index])
+				{
+					return FString::Printf(TEXT("%s, offset %d: wrote float %d past the end of its %d outputs"), *InDescription, InOffset, Index, InNumOutputFloats);
+				}
+
+				if (TestedBits[Index] != ReferenceBits[Index])
+				{
+					return FString::Printf(TEXT("%s, offset %d: output float %d of %d is 0x%08x, the reference wrote 0x%08x"),
+						*InDescription, InOffset, Index, InNumOutputFloats, TestedBits[Index], ReferenceBits[Index]);
+				}
+			}
+
+			return FString();
+		}
+
+		/** Compares a kernel of InKernels against the same kernel of the scalar table. Call is Call(const FMixerKernels&, InA, InB, Out). */
+		template<typename CallType>
+		FString CompareWithScalar(FCheckBuffers& Buffers, const FMixerKernels& InKernels, const FString& InDescription, int32 InOffset, int32 InNumOutputFloats, CallType&& InCall)
+		{
+			const FMixerKernels& Scalar = *GetMixerKernelsForIsa(EMixerKernelIsa::Scalar);
+			return CompareCalls(Buffers, FString::Printf(TEXT("%s %s"), InKernels.Name, *InDescription), InOffset, InNumOutputFloats,
+				[&](const float* InA, const float* InB, float* Out) { InCall(Scalar, InA, InB, Out); },
+				[&](const float* InA, const float* InB, float* Out) { InCall(InKernels, InA, InB, Out); });
+		}
+
+		/** Calls InCheck(NumSamples, Offset) for every sample count and offset until one returns an error. */
+		template<typename CheckType>
+		FString ForEachSize(CheckType&& InCheck)
+		{
+			for (const int32 NumSamples : NumSamplesToCheck)
+			{
+				for (const int32 Offset : OffsetsToCheck)
+				{
+					FString Error = InCheck(NumSamples, Offset);
+					if (!Error.IsEmpty())
+					{
+						return Error;
+					}
+				}
+			}
+			return FString();
+		}
+
+		/** Times InNumIterations calls of InCall, after a few untimed ones. Returns nanoseconds per call. */
+		template<typename CallType>
+		double TimeCalls(int32 InNumIterations, CallType&& InCall)
+		{
+			for (int32 Iteration = 0; Iteration < 16; ++Iteration)
+			{
+				InCall();
+			}
+
+			const double StartSeconds = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < InNumIterations; ++Iteration)
+			{
+				InCall();
+			}
+			return (FPlatformTime::Seconds() - StartSeconds) * 1.0e9 / FMath::Max(InNumIterations, 1);
+		}
+	}
+
+	/**
+	 * Checks every kernel of a table against the scalar reference, bit for bit.
+	 *
+	 * Each kernel runs at every sample count in KernelHarness::NumSamplesToCheck, on buffers at
+	 * several misalignments, with fades, gains, channel counts up to 12 and dither seeds varied. The
+	 * outputs must match the scalar kernels exactly, and nothing past the end of an output may be
+	 * written. GainAndMixInMultiple must also match the GainAndMixIn calls it replaces, so this is
+	 * worth running on the scalar table too.
+	 *
+	 * @param InKernels The table to check, e.g. from GetMixerKernelsForIsa.
+	 * @param InSeed Seed of the noise the kernels are run on.
+	 * @return An empty string if every kernel matches, or a description of the first difference.
+	 */
+	inline FString CheckMixerKernels(const FMixerKernels& InKernels, uint32 InSeed = 1)
+	{
+		using namespace KernelHarness;
+
+		FCheckBuffers Buffers(InSeed);
+		const FMixerKernels& Scalar = *GetMixerKernelsForIsa(EMixerKernelIsa::Scalar);
+
+		// Gains and fades that aren't powers of two, so rounding differences would show.
+		const float Gain = 0.7071f;
+		const float StartGain = 0.13f;
+		const float EndGain = 0.91f;
+
+		FString Error = ForEachSize([&](int32 NumSamples, int32 Offset)
+		{
+			FString SizeError;
+			auto Check = [&](const TCHAR* InKernel, int32 InNumOutputFloats, auto&& InCall)
+			{
+				if (SizeError.IsEmpty())
+				{
+					SizeError = CompareWithScalar(Buffers, InKernels, FString::Printf(TEXT("%s(%d samples)"), InKernel, NumSamples), Offset, InNumOutputFloats, InCall);
+				}
+			};
+
+			Check(TEXT("MixIn"), NumSamples, [&](const FMixerKernels& K, const float* InA, const float*, float* Out) { K.MixIn(InA, Out, NumSamples); });
+			Check(TEXT("GainAndMixIn"), NumSamples, [&](const FMixerKernels& K, const float* InA, const float*, float* Out) { K.GainAndMixIn(InA, Out, NumSamples, Gain); });
+			Check(TEXT("FadeAndMixIn"), NumSamples, [&](const FMixerKernels& K, const float* InA, const float*, float* Out) { K.FadeAndMixIn(InA, Out, NumSamples, StartGain, EndGain); });
+			Check(TEXT("MultiplyByConstantInPlace"), NumSamples, [&](const FMixerKernels& K, const float*, const float*, float* Out) { K.MultiplyByConstantInPlace(Out, NumSamples, Gain); });
+			Check(TEXT("FadeInPlace"), NumSamples, [&](const FMixerKernels& K, const float*, const float*, float* Out) { K.FadeInPlace(Out, NumSamples, EndGain, StartGain); });
+			Check(TEXT("RangeClamp"), NumSamples, [&](const FMixerKernels& K, const float*, const float*, float* Out) { K.RangeClamp(Out, NumSamples, -0.5f, 0.25f); });
+			Check(TEXT("MaxAbs"), 1, [&](const FMixerKernels& K, const float* InA, const float*, float* Out) { Out[0] = K.MaxAbs(InA, NumSamples); });
+			Check(TEXT("DotProduct"), 1, [&](const FMixerKernels& K, const float* InA, const float* InB, float* Out) { Out[0] = K.DotProduct(InA, InB, NumSamples); });
+			Check(TEXT("ConvertToFloat"), NumSamples, [&](const FMixerKernels& K, const float* InA, const float*, float* Out) { K.ConvertToFloat(InA, Out, NumSamples, Gain); });
+
+			// Integer outputs are compared as the floats that hold their bytes, so odd counts compare the padding up to the next float too.
+			const uint32 DitherSeed = InSeed * 4099u + NumSamples;
+			for (const float DitherAmount : { 0.0f, 1.0f })
+			{
+				Check(TEXT("ConvertToInt16"), (NumSamples * 2 + 3) / 4, [&](const FMixerKernels& K, const float* InA, const float*, float* Out) { K.ConvertToInt16(InA, reinterpret_cast<int16*>(Out), NumSamples, Gain, DitherAmount, DitherSeed); });
+				Check(TEXT("ConvertToInt24"), (NumSamples * 3 + 3) / 4, [&](const FMixerKernels& K, const float* InA, const float*, float* Out) { K.ConvertToInt24(InA, reinterpret_cast<uint8*>(Out), NumSamples, Gain, DitherAmount, DitherSeed); });
+				Check(TEXT("ConvertToInt32"), NumSamples, [&](const FMixerKernels& K, const float* InA, const float*, float* Out) { K.ConvertToInt32(InA, reinterpret_cast<int32*>(Out), NumSamples, Gain, DitherAmount, DitherSeed); });
+			}
+
+			// Every buffer count up to a few register groups, reading each buffer from its own place in the input.
+			for (int32 NumBuffers = 1; NumBuffers <= MaxNumMixBuffers && SizeError.IsEmpty(); NumBuffers += (NumBuffers < 9 ? 1 : 5))
+			{
+				const float* MixBuffers[MaxNumMixBuffers];
+				float MixGains[MaxNumMixBuffers];
+				const int32 BufferOffset = Offset;
+				auto SetUpBuffers = [&](const float* InA, const float* InB)
+				{
+					for (int32 Buffer = 0; Buffer < NumBuffers; ++Buffer)
+					{
+						MixBuffers[Buffer] = (Buffer % 2 ? InB : InA) + Buffer * 37;
+						MixGains[Buffer] = InB[Buffer] * 0.5f;
+					}
+				};
+
+				const FString Description = FString::Printf(TEXT("%s GainAndMixInMultiple(%d buffers, %d samples)"), InKernels.Name, NumBuffers, NumSamples);
+				SizeError = CompareCalls(Buffers, Description, Offset, NumSamples,
+					[&](const float* InA, const float* InB, float* Out)
+					{
+						SetUpBuffers(InA, InB);
+						for (int32 Buffer = 0; Buffer < NumBuffers; ++Buffer)
+						{
+							Scalar.GainAndMixIn(MixBuffers[Buffer] + BufferOffset, Out, NumSamples, MixGains[Buffer]);
+						}
+					},
+					[&](const float* InA, const float* InB, float* Out)
+					{
+						SetUpBuffers(InA, InB);
+						InKernels.GainAndMixInMultiple(MixBuffers, MixGains, NumBuffers, BufferOffset, Out, NumSamples);
+					});
+			}
+
+			return SizeError;
+		});
+
+		if (!Error.IsEmpty())
+		{
+			return Error;
+		}
+
+		// The interleaved kernels, at every channel count, with the sample counts taken as frames.
+		for (int32 NumChannels = 1; NumChannels <= MaxNumChannels; ++NumChannels)
+		{
+			Error = ForEachSize([&](int32 NumFrames, int32 Offset)
+			{
+				FString SizeError;
+				auto Check = [&](const TCHAR* InKernel, int32 InNumOutputFloats, auto&& InCall)
+				{
+					if (SizeError.IsEmpty())
+					{
+						SizeError = CompareWithScalar(Buffers, InKernels, FString::Printf(TEXT("%s(%d frames, %d channels)"), InKernel, NumFrames, NumChannels), Offset, InNumOutputFloats, InCall);
+					}
+				};
+
+				// Lanes are padded past the frames, as the resampler's are.
+				const int32 LaneStride = NumFrames + 3;
+				if (NumChannels * LaneStride > MaxNumSamples * MaxNumChannels)
+				{
+					return SizeError;
+				}
+
+				Check(TEXT("MixDownToMono"), NumFrames, [&](const FMixerKernels& K, const float* InA, const float*, float* Out) { K.MixDownToMono(InA, Out, NumFrames, NumChannels); });
+				Check(TEXT("Deinterleave"), NumChannels * LaneStride, [&](const FMixerKernels& K, const float* InA, const float*, float* Out) { K.Deinterleave(InA, Out, LaneStride, NumFrames, NumChannels); });
+				Check(TEXT("Interleave"), NumFrames * NumChannels, [&](const FMixerKernels& K, const float* InA, const float*, float* Out) { K.Interleave(InA, LaneStride, Out, NumFrames, NumChannels); });
+
+				for (const bool bMeanSquared : { false, true })
+				{
+					Check(bMeanSquared ? TEXT("FollowEnvelope(mean squared)") : TEXT("FollowEnvelope"), NumChannels, [&](const FMixerKernels& K, const float* InA, const float*, float* Out)
+					{
+						// Start from the held envelopes a running follower would have.
+						for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+						{
+							Out[Channel] = FMath::Abs(Out[Channel]);
+						}
+						K.FollowEnvelope(InA, NumFrames, NumChannels, Out, 0.2f, 0.999f, bMeanSquared);
+					});
+				}
+
+				return SizeError;
+			});
+
+			if (!Error.IsEmpty())
+			{
+				return Error;
+			}
+		}
+
+		return FString();
+	}
+
+	/**
+	 * Checks the channel kernels GetMixerChannelKernels returns for every channel count up to 12, the
+	 * specialized layouts and the generic fallback, against the generic scalar kernels.
+	 *
+	 * @return An empty string if they all match, or a description of the first difference.
+	 */
+	inline FString CheckMixerChannelKernels(uint32 InSeed = 1)
+	{
+		using namespace KernelHarness;
+
+		FCheckBuffers Buffers(InSeed);
+		const FMixerKernels& Scalar = *GetMixerKernelsForIsa(EMixerKernelIsa::Scalar);
+
+		for (int32 NumChannels = 1; NumChannels <= MaxNumChannels; ++NumChannels)
+		{
+			const FMixerChannelKernels& ChannelKernels = GetMixerChannelKernels(NumChannels);
+
+			FString Error = ForEachSize([&](int32 NumFrames, int32 Offset)
+			{
+				const FString Layout = FString::Printf(TEXT("%d frames, %d channels, %s layout"), NumFrames, NumChannels, ChannelKernels.NumChannels ? TEXT("specialized") : TEXT("generic"));
+
+				FString SizeError = CompareCalls(Buffers, FString::Printf(TEXT("MixDownToMono(%s)"), *Layout), Offset, NumFrames,
+					[&](const float* InA, const float*, float* Out) { Scalar.MixDownToMono(InA, Out, NumFrames, NumChannels); },
+					[&](const float* InA, const float*, float* Out) { ChannelKernels.MixDownToMono(InA, Out, NumFrames, NumChannels); });
+
+				for (const bool bMeanSquared : { false, true })
+				{
+					if (!SizeError.IsEmpty())
+					{
+						break;
+					}
+
+					auto FollowEnvelope = [&](auto FollowEnvelopeKernel, const float* InA, float* Out)
+					{
+						for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+						{
+							Out[Channel] = FMath::Abs(Out[Channel]);
+						}
+						FollowEnvelopeKernel(InA, NumFrames, NumChannels, Out, 0.2f, 0.999f, bMeanSquared);
+					};
+
+					SizeError = CompareCalls(Buffers, FString::Printf(TEXT("FollowEnvelope(%s%s)"), *Layout, bMeanSquared ? TEXT(", mean squared") : TEXT("")), Offset, NumChannels,
+						[&](const float* InA, const float*, float* Out) { FollowEnvelope(Scalar.FollowEnvelope, InA, Out); },
+						[&](const float* InA, const float*, float* Out) { FollowEnvelope(ChannelKernels.FollowEnvelope, InA, Out); });
+				}
+
+				return SizeError;
+			});
+
+			if (!Error.IsEmpty())
+			{
+				return Error;
+			}
+		}
+
+		return FString();
+	}
+
+	/**
+	 * Checks every kernel table available on this CPU, and the channel kernels.
+	 *
+	 * @return An empty string if every table matches the scalar reference, or a description of the first difference.
+	 */
+	inline FString CheckAllMixerKernels(uint32 InSeed = 1)
+	{
+		for (const EMixerKernelIsa Isa : { EMixerKernelIsa::Scalar, EMixerKernelIsa::SSE2, EMixerKernelIsa::AVX2, EMixerKernelIsa::AVX512 })
+		{
+			if (const FMixerKernels* Kernels = GetMixerKernelsForIsa(Isa))
+			{
+				FString Error = CheckMixerKernels(*Kernels, InSeed);
+				if (!Error.IsEmpty())
+				{
+					return Error;
+				}
+			}
+		}
+
+		return CheckMixerChannelKernels(InSeed);
+	}
+
+	/**
+	 * Measures every kernel on every instruction set available on this CPU.
+	 *
+	 * Each kernel runs over buffers that fit in L1, so the results are the kernels' compute throughput
+	 * rather than memory bandwidth. The frame-based kernels run on stereo; GainAndMixInMultiple sums
+	 * eight buffers and counts every summed sample.
+	 *
+	 * @param InNumSamples Samples per call, at most 1024.
+	 * @param InNumIterations Timed calls per kernel.
+	 * @return One result per kernel and instruction set, scalar first.
+	 */
+	inline TArray<FMixerKernelBenchmarkResult> RunMixerKernelBenchmark(int32 InNumSamples = 512, int32 InNumIterations = 20000)
+	{
+		using namespace KernelHarness;
+
+		check(InNumSamples > 0 && InNumSamples <= MaxNumSamples);
+
+		FCheckBuffers Buffers(1);
+		const float* InA = Buffers.InputA.GetData();
+		const float* InB = Buffers.InputB.GetData();
+		float* Out = Buffers.TestedOutput.GetData();
+		FMemory::Memcpy(Out, Buffers.InitialOutput.GetData(), BufferSize * sizeof(float));
+
+		const int32 NumSamples = InNumSamples;
+		const int32 NumFrames = InNumSamples / 2;
+		const int32 NumMixBuffers = 8;
+		const float* MixBuffers[NumMixBuffers];
+		float MixGains[NumMixBuffers];
+		for (int32 Buffer = 0; Buffer < NumMixBuffers; ++Buffer)
+		{
+			MixBuffers[Buffer] = InA + Buffer * MaxNumSamples;
+			MixGains[Buffer] = 0.1f * (Buffer + 1);
+		}
+
+		// Results of the kernels that return one, so the calls aren't optimized away.
+		volatile float Sink = 0.0f;
+
+		TArray<FMixerKernelBenchmarkResult> Results;
+		for (const EMixerKernelIsa Isa : { EMixerKernelIsa::Scalar, EMixerKernelIsa::SSE2, EMixerKernelIsa::AVX2, EMixerKernelIsa::AVX512 })
+		{
+			const FMixerKernels* KernelsPtr = GetMixerKernelsForIsa(Isa);
+			if (!KernelsPtr)
+			{
+				continue;
+			}
+			const FMixerKernels& K = *KernelsPtr;
+
+			auto Time = [&](const TCHAR* InKernel, int32 InNumSamplesPerCall, auto&& InCall)
+			{
+				FMixerKernelBenchmarkResult& Result = Results.AddDefaulted_GetRef();
+				Result.Kernel = InKernel;
+				Result.Isa = Isa;
+				Result.NumSamples = InNumSamplesPerCall;
+				Result.NanosecondsPerCall = TimeCalls(InNumIterations, InCall);
+				Result.SamplesPerSecond = Result.NanosecondsPerCall > 0.0 ? InNumSamplesPerCall * 1.0e9 / Result.NanosecondsPerCall : 0.0;
+			};
+
+			// In-place gains stay close to one, so repeated calls don't decay the buffer into denormals.
+			Time(TEXT("MixIn"), NumSamples, [&]() { K.MixIn(InA, Out, NumSamples); });
+			Time(TEXT("GainAndMixIn"), NumSamples, [&]() { K.GainAndMixIn(InA, Out, NumSamples, 0.5f); });
+			Time(TEXT("GainAndMixInMultiple"), NumSamples * NumMixBuffers, [&]() { K.GainAndMixInMultiple(MixBuffers, MixGains, NumMixBuffers, 0, Out, NumSamples); });
+			Time(TEXT("FadeAndMixIn"), NumSamples, [&]() { K.FadeAndMixIn(InA, Out, NumSamples, 0.25f, 0.75f); });
+			Time(TEXT("MultiplyByConstantInPlace"), NumSamples, [&]() { K.MultiplyByConstantInPlace(Out, NumSamples, 0.99999f); });
+			Time(TEXT("FadeInPlace"), NumSamples, [&]() { K.FadeInPlace(Out, NumSamples, 1.0f, 0.99999f); });
+			Time(TEXT("RangeClamp"), NumSamples, [&]() { K.RangeClamp(Out, NumSamples, -1.0f, 1.0f); });
+			Time(TEXT("MixDownToMono"), NumFrames, [&]() { K.MixDownToMono(InA, Out, NumFrames, 2); });
+			Time(TEXT("MaxAbs"), NumSamples, [&]() { Sink = Sink + K.MaxAbs(InA, NumSamples); });
+			Time(TEXT("DotProduct"), NumSamples, [&]() { Sink = Sink + K.DotProduct(InA, InB, NumSamples); });
+			Time(TEXT("FollowEnvelope"), NumFrames, [&]() { K.FollowEnvelope(InA, NumFrames, 2, Out, 0.2f, 0.999f, false); });
+			Time(TEXT("Deinterleave"), NumFrames, [&]() { K.Deinterleave(InA, Out, NumFrames, NumFrames, 2); });
+			Time(TEXT("Interleave"), NumFrames, [&]() { K.Interleave(InA, NumFrames, Out, NumFrames, 2); });
+			Time(TEXT("ConvertToFloat"), NumSamples, [&]() { K.ConvertToFloat(InA, Out, NumSamples, 1.0f); });
+			Time(TEXT("ConvertToInt16"), NumSamples, [&]() { K.ConvertToInt16(InA, reinterpret_cast<int16*>(Out), NumSamples, 1.0f, 1.0f, 0); });
+			Time(TEXT("ConvertToInt24"), NumSamples, [&]() { K.ConvertToInt24(InA, reinterpret_cast<uint8*>(Out), NumSamples, 1.0f, 1.0f, 0); });
+			Time(TEXT("ConvertToInt32"), NumSamples, [&]() { K.ConvertToInt32(InA, reinterpret_cast<int32*>(Out), NumSamples, 1.0f, 1.0f, 0); });
+		}
+
+		// Scalar ran first, so its results come first.
+		for (FMixerKernelBenchmarkResult& Result : Results)
+		{
+			for (const FMixerKernelBenchmarkResult& ScalarResult : Results)
+			{
+				if (ScalarResult.Isa == EMixerKernelIsa::Scalar && FCString::Strcmp(ScalarResult.Kernel, Result.Kernel) == 0)
+				{
+					Result.SpeedupOverScalar = Result.NanosecondsPerCall > 0.0 ? ScalarResult.NanosecondsPerCall / Result.NanosecondsPerCall : 0.0;
+					break;
+				}
+			}
+		}
+
+		return Results;
+	}
+}
@@ -0,0 +1,273 @@
+#include "audio_mixer_listener_fanout.h"
+#include "AudioMixerLog.h"
+#include "HAL/PlatformProcess.h"
+#include "AudioDevice.h"
+
+namespace Audio
+{
+	namespace ListenerFanout
+	{
+		/** How long an async reader sleeps when it has caught up. Short compared to the ring, which holds many blocks. */
+		static const float ReaderPollIntervalSeconds = 0.002f;
+	}
+
+	FSubmixBufferListenerFanout::FSubmixBufferListenerFanout(int32 InNumRingSlots)
+		: Snapshot(new FSnapshot())
+		, RingMask(0)
+		, NumRingSlots((int32)FMath::RoundUpToPowerOfTwo(FMath::Max(InNumRingSlots, 2)))
+		, MaxSamplesPerSlot(0)
+	{
+	}
+
+	FSubmixBufferListenerFanout::~FSubmixBufferListenerFanout()
+	{
+		{
+			FScopeLock Lock(&MutationLock);
+			SwapSnapshot(new FSnapshot());
+
+			for (TUniquePtr<FAsyncReader>& Reader : AsyncReaders)
+			{
+				Reader->Join();
+			}
+			AsyncReaders.Reset();
+		}
+
+		delete Snapshot.load(std::memory_order_relaxed);
+	}
+
+	void FSubmixBufferListenerFanout::AddListener(ISubmixBufferListener* InListener, bool bInAsync, int32 InMaxSamplesPerBlock)
+	{
+		check(InListener);
+
+		FScopeLock Lock(&MutationLock);
+
+		const FSnapshot* CurrentSnapshot = Snapshot.load(std::memory_order_relaxed);
+		if (CurrentSnapshot->SyncListeners.Contains(InListener) || AsyncReaders.ContainsByPredicate([InListener](const TUniquePtr<FAsyncReader>& Reader) { return Reader->Listener == InListener; }))
+		{
+			return;
+		}
+
+		FSnapshot* NewSnapshot = new FSnapshot(*CurrentSnapshot);
+
+		if (bInAsync)
+		{
+			// The render thread only touches the ring while the snapshot says there are async listeners, so it can be resized until then.
+			if (!CurrentSnapshot->bHasAsyncListeners && (RingSlots.Num() != NumRingSlots || MaxSamplesPerSlot < InMaxSamplesPerBlock))
+			{
+				RingSlots.Reset();
+				RingSlots.SetNum(NumRingSlots);
+				for (FRingSlot& Slot : RingSlots)
+				{
+					Slot.Samples.SetNumZeroed(InMaxSamplesPerBlock);
+				}
+				RingMask = NumRingSlots - 1;
+				MaxSamplesPerSlot = InMaxSamplesPerBlock;
+				PublishedBlock.store(0, std::memory_order_relaxed);
+			}
+
+			AsyncReaders.Add(MakeUnique<FAsyncReader>(*this, InListener));
+			NewSnapshot->bHasAsyncListeners = true;
+		}
+		else
+		{
+			NewSnapshot->SyncListeners.Add(InListener);
+		}
+
+		SwapSnapshot(NewSnapshot);
+	}
+
+	void FSubmixBufferListenerFanout::RemoveListener(ISubmixBufferListener* InListener)
+	{
+		FScopeLock Lock(&MutationLock);
+
+		const int32 ReaderIndex = AsyncReaders.IndexOfByPredicate([InListener](const TUniquePtr<FAsyncReader>& Reader) { return Reader->Listener == InListener; });
+		if (ReaderIndex != INDEX_NONE)
+		{
+			// Joining waits for a callback in progress, so the listener is not called after this returns.
+			AsyncReaders[ReaderIndex]->Join();
+			AsyncReaders.RemoveAt(ReaderIndex);
+
+			if (AsyncReaders.Num() == 0)
+			{
+				FSnapshot* NewSnapshot = new FSnapshot(*Snapshot.load(std::memory_order_relaxed));
+				NewSnapshot->bHasAsyncListeners = false;
+				SwapSnapshot(NewSnapshot);
+			}
+			return;
+		}
+
+		const FSnapshot* CurrentSnapshot = Snapshot.load(std::memory_order_relaxed);
+		if (CurrentSnapshot->SyncListeners.Contains(InListener))
+		{
+			FSnapshot* NewSnapshot = new FSnapshot(*CurrentSnapshot);
+			NewSnapshot->SyncListeners.Remove(InListener);
+			SwapSnapshot(NewSnapshot);
+		}
+	}
+
+	uint64 FSubmixBufferListenerFanout::GetNumOverruns(const ISubmixBufferListener* InListener) const
+	{
+		FScopeLock Lock(&MutationLock);
+
+		for (const TUniquePtr<FAsyncReader>& Reader : AsyncReaders)
+		{
+			if (Reader->Listener == InListener)
+			{
+				return Reader->NumOverruns.load(std::memory_order_relaxed);
+			}
+		}
+		return 0;
+	}
+
+	void FSubmixBufferListenerFanout::SwapSnapshot(FSnapshot* InNewSnapshot)
+	{
+		FSnapshot* OldSnapshot = Snapshot.exchange(InNewSnapshot, std::memory_order_seq_cst);
+		const uint64 NewEpoch = SnapshotEpoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+
+		// The render thread reads the epoch before the snapshot pointer. If it is idle, or advertises an epoch from after
+		// the swap, it can only hold the new snapshot. Otherwise wait for it to finish the block, which also guarantees a
+		// removed synchronous listener is not called after RemoveListener returns.
+		for (;;)
+		{
+			const uint64 ReadingEpoch = RenderThreadEpoch.load(std::memory_order_seq_cst);
+			if (ReadingEpoch == 0 || ReadingEpoch >= NewEpoch)
+			{
+				break;
+			}
+			FPlatformProcess::Yield();
+		}
+
+		delete OldSnapshot;
+	}
+
+	void FSubmixBufferListenerFanout::Broadcast(const USoundSubmix* InSubmix, float* InAudio, int32 InNumSamples, int32 InNumChannels, int32 InSampleRate, double InAudioClock)
+	{
+		RenderThreadEpoch.store(SnapshotEpoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+		const FSnapshot* CurrentSnapshot = Snapshot.load(std::memory_order_seq_cst);
+
+		for (ISubmixBufferListener* Listener : CurrentSnapshot->SyncListeners)
+		{
+			Listener->OnNewSubmixBuffer(InSubmix, InAudio, InNumSamples, InNumChannels, InSampleRate, InAudioClock);
+		}
+
+		if (CurrentSnapshot->bHasAsyncListeners)
+		{
+			Publish(InSubmix, InAudio, InNumSamples, InNumChannels, InSampleRate, InAudioClock);
+		}
+
+		RenderThreadEpoch.store(0, std::memory_order_release);
+	}
+
+	void FSubmixBufferListenerFanout::Publish(const USoundSubmix* InSubmix, const float* InAudio, int32 InNumSamples, int32 InNumChannels, int32 InSampleRate, double InAudioClock)
+	{
+		if (InNumSamples > MaxSamplesPerSlot)
+		{
+			NumOversizedBlocks.store(NumOversizedBlocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			return;
+		}
+
+		const uint64 Block = PublishedBlock.load(std::memory_order_relaxed) + 1;
+		FRingSlot& Slot = RingSlots[Block & RingMask];
+
+		// Seqlock write: readers that see the odd sequence, or a different sequence after copying, discard what they read.
+		Slot.Sequence.store(Block * 2 - 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		Slot.Submix = InSubmix;
+		Slot.NumSamples = InNumSamples;
+		Slot.NumChannels = InNumChannels;
+		Slot.SampleRate = InSampleRate;
+		Slot.AudioClock = InAudioClock;
+		FMemory::Memcpy(Slot.Samples.GetData(), InAudio, InNumSamples * sizeof(float));
+
+		Slot.Sequence.store(Block * 2, std::memory_order_release);
+		PublishedBlock.store(Block, std::memory_order_release);
+	}
+
+	FSubmixBufferListenerFanout::FAsyncReader::FAsyncReader(FSubmixBufferListenerFanout& InFanout, ISubmixBufferListener* InListener)
+		: Listener(InListener)
+		, Fanout(InFanout)
+		, Cursor(InFanout.PublishedBlock.load(std::memory_order_acquire) + 1)
+		, Thread(nullptr)
+	{
+		Samples.SetNumZeroed(Fanout.MaxSamplesPerSlot);
+		Thread = FRunnableThread::Create(this, TEXT("AudioSubmixBufferListener"), 0, TPri_BelowNormal);
+	}
+
+	FSubmixBufferListenerFanout::FAsyncReader::~FAsyncReader()
+	{
+		Join();
+	}
+
+	uint32 FSubmixBufferListenerFanout::FAsyncReader::Run()
+	{
+		while (!bStopping.load(std::memory_order_acquire))
+		{
+			ReadPublishedBlocks();
+			FPlatformProcess::Sleep(ListenerFanout::ReaderPollIntervalSeconds);
+		}
+		return 0;
+	}
+
+	void FSubmixBufferListenerFanout::FAsyncReader::Stop()
+	{
+		bStopping.store(true, std::memory_order_release);
+	}
+
+	void FSubmixBufferListenerFanout::FAsyncReader::Join()
+	{
+		if (Thread)
+		{
+			Stop();
+			Thread->WaitForCompletion();
+			delete Thread;
+			Thread = nullptr;
+		}
+	}
+
+	void FSubmixBufferListenerFanout::FAsyncReader::ReadPublishedBlocks()
+	{
+		const uint64 NumSlots = Fanout.RingMask + 1;
+
+		// Stop at the block that was latest on entry, so a listener slower than the mix still gets to check for Stop().
+		const uint64 TargetBlock = Fanout.PublishedBlock.load(std::memory_order_acquire);
+
+		while (Cursor <= TargetBlock && !bStopping.load(std::memory_order_relaxed))
+		{
+			const uint64 LatestBlock = Fanout.PublishedBlock.load(std::memory_order_acquire);
+
+			// Blocks more than a ring behind have been overwritten. Skip to the oldest one that is still there,
+			// leaving a slot of slack because the render thread may already be writing the next block.
+			if (LatestBlock - Cursor + 2 > NumSlots)
+			{
+				const uint64 OldestReadableBlock = LatestBlock + 2 - NumSlots;
+				NumOverruns.store(NumOverruns.load(std::memory_order_relaxed) + (OldestReadableBlock - Cursor), std::memory_order_relaxed);
+				Cursor = OldestReadableBlock;
+			}
+
+			const FRingSlot& Slot = Fanout.RingSlots[Cursor & Fanout.RingMask];
+			const uint64 SequenceBefore = Slot.Sequence.load(std::memory_order_acquire);
+
+			const USoundSubmix* Submix = Slot.Submix;
+			const int32 NumSamples = FMath::Min(Slot.NumSamples, Samples.Num());
+			const int32 NumChannels = Slot.NumChannels;
+			const int32 SampleRate = Slot.SampleRate;
+			const double AudioClock = Slot.AudioClock;
+			FMemory::Memcpy(Samples.GetData(), Slot.Samples.GetData(), NumSamples * sizeof(float));
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			const uint64 SequenceAfter = Slot.Sequence.load(std::memory_order_relaxed);
+
+			// The block was overwritten before or while it was copied.
+			if (SequenceBefore != Cursor * 2 || SequenceAfter != SequenceBefore)
+			{
+				NumOverruns.store(NumOverruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+				++Cursor;
+				continue;
+			}
+
+			Listener->OnNewSubmixBuffer(Submix, Samples.GetData(), NumSamples, NumChannels, SampleRate, AudioClock);
+			++Cursor;
+		}
+	}
+}
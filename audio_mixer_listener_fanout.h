@@ -0,0 +1,143 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include <atomic>
+
+class ISubmixBufferListener;
+class USoundSubmix;
+
+namespace Audio
+{
+	/**
+	 * Delivers a submix's output blocks to its buffer listeners without letting them stall the mix.
+	 *
+	 * Synchronous listeners are called on the audio render thread, as before. Asynchronous listeners
+	 * run on their own threads: the render thread publishes each block once into a shared broadcast
+	 * ring and every async listener reads it with its own cursor. The render thread never waits for
+	 * a reader; a listener that falls more than a ring's worth of blocks behind skips ahead and the
+	 * missed blocks are counted as overruns.
+	 *
+	 * The listener set is an immutable snapshot that is replaced with an atomic swap, so adding or
+	 * removing a listener never blocks the render thread. The render thread advertises the snapshot
+	 * epoch it is reading, and a replaced snapshot is freed once the render thread has moved past it.
+	 */
+	class FSubmixBufferListenerFanout
+	{
+	public:
+		/** @param InNumRingSlots Blocks the broadcast ring holds (rounded up to a power of two). */
+		explicit FSubmixBufferListenerFanout(int32 InNumRingSlots = 16);
+		~FSubmixBufferListenerFanout();
+
+		/**
+		 * Adds a listener. Not to be called from the audio render thread.
+		 *
+		 * @param InListener The listener to add.
+		 * @param bInAsync Whether to call the listener on its own thread instead of the render thread.
+		 * @param InMaxSamplesPerBlock Largest block the listener may receive. Sizes the broadcast ring when the first async listener is added.
+		 */
+		void AddListener(ISubmixBufferListener* InListener, bool bInAsync, int32 InMaxSamplesPerBlock);
+
+		/** Removes a listener. Not to be called from the audio render thread. Once this returns, the listener won't be called again. */
+		void RemoveListener(ISubmixBufferListener* InListener);
+
+		/** Calls the synchronous listeners and publishes the block to the async ones. Audio render thread only. */
+		void Broadcast(const USoundSubmix* InSubmix, float* InAudio, int32 InNumSamples, int32 InNumChannels, int32 InSampleRate, double InAudioClock);
+
+		/** Returns how many blocks an async listener has missed because it fell behind, or 0 for unknown or synchronous listeners. */
+		uint64 GetNumOverruns(const ISubmixBufferListener* InListener) const;
+
+		/** Blocks that were too large for the broadcast ring and were not published. */
+		uint64 GetNumOversizedBlocks() const { return NumOversizedBlocks.load(std::memory_order_relaxed); }
+
+	private:
+
+		/** One block in the broadcast ring. */
+		struct FRingSlot
+		{
+			/** 2 * Block - 1 while block number Block is being written, 2 * Block once it is published. */
+			std::atomic<uint64> Sequence { 0 };
+
+			const USoundSubmix* Submix = nullptr;
+			int32 NumSamples = 0;
+			int32 NumChannels = 0;
+			int32 SampleRate = 0;
+			double AudioClock = 0.0;
+			TArray<float> Samples;
+		};
+
+		/** Thread that feeds one async listener from the broadcast ring. */
+		class FAsyncReader : public FRunnable
+		{
+		public:
+			FAsyncReader(FSubmixBufferListenerFanout& InFanout, ISubmixBufferListener* InListener);
+			virtual ~FAsyncReader();
+
+			//~ Begin FRunnable
+			virtual uint32 Run() override;
+			virtual void Stop() override;
+			//~ End FRunnable
+
+			/** Stops and joins the thread. */
+			void Join();
+
+			/** Reads and delivers every block published since the last call. */
+			void ReadPublishedBlocks();
+
+			ISubmixBufferListener* Listener;
+			std::atomic<uint64> NumOverruns { 0 };
+
+		private:
+			FSubmixBufferListenerFanout& Fanout;
+
+			/** Next block number to read. */
+			uint64 Cursor;
+
+			/** Private copy of the block being delivered. */
+			TArray<float> Samples;
+
+			FRunnableThread* Thread;
+			std::atomic<bool> bStopping { false };
+		};
+
+		/** Immutable listener set read by the render thread. */
+		struct FSnapshot
+		{
+			TArray<ISubmixBufferListener*> SyncListeners;
+			bool bHasAsyncListeners = false;
+		};
+
+		/** Publishes a new snapshot and frees the old one once the render thread has stopped reading it. Requires MutationLock. */
+		void SwapSnapshot(FSnapshot* InNewSnapshot);
+
+		/** Writes a block into the broadcast ring. Audio render thread only. */
+		void Publish(const USoundSubmix* InSubmix, const float* InAudio, int32 InNumSamples, int32 InNumChannels, int32 InSampleRate, double InAudioClock);
+
+		/** Current listener set. */
+		std::atomic<FSnapshot*> Snapshot;
+
+		/** Incremented by every snapshot swap. */
+		std::atomic<uint64> SnapshotEpoch { 1 };
+
+		/** Epoch the render thread read before loading the snapshot it is using, or 0 while it is not using one. */
+		std::atomic<uint64> RenderThreadEpoch { 0 };
+
+		/** Serializes adding and removing listeners. Never taken by the render thread. */
+		mutable FCriticalSection MutationLock;
+
+		/** Readers of the async listeners. Guarded by MutationLock. */
+		TArray<TUniquePtr<FAsyncReader>> AsyncReaders;
+
+		/** The broadcast ring. Only resized while no async listener is registered. */
+		TArray<FRingSlot> RingSlots;
+		uint64 RingMask;
+		int32 NumRingSlots;
+		int32 MaxSamplesPerSlot;
+
+		/** Number of the last published block. */
+		std::atomic<uint64> PublishedBlock { 0 };
+
+		std::atomic<uint64> NumOversizedBlocks { 0 };
+	};
+}
@@ -0,0 +1,133 @@
+#include "audio_mixer_offline_renderer.h"
+#include "audio_mixer_kernels.h"
+#include "AudioMixerDevice.h"
+#include "AudioMixerLog.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformTime.h"
+
+namespace Audio
+{
+	bool FMixerOfflineMemorySink::Begin(int32 InNumChannels, int32 InSampleRate, int64 InNumFrames)
+	{
+		const int64 NumSamples = InNumFrames * InNumChannels;
+		if (NumSamples > MAX_int32)
+		{
+			UE_LOG(LogAudioMixer, Warning, TEXT("Offline render of %lld frames is too long for a memory sink."), InNumFrames);
+			return false;
+		}
+
+		NumChannels = InNumChannels;
+		SampleRate = InSampleRate;
+		Samples.Reset((int32)NumSamples);
+		return true;
+	}
+
+	bool FMixerOfflineMemorySink::Write(const float* InAudio, int32 InNumSamples)
+	{
+		Samples.Append(InAudio, InNumSamples);
+		return true;
+	}
+
+	FMixerOfflineFileSink::FMixerOfflineFileSink(const FString& InFilePath, ESubmixRecordingFormat InFormat)
+		: FilePath(InFilePath)
+		, Format(InFormat)
+		, NumChannels(0)
+	{
+	}
+
+	bool FMixerOfflineFileSink::Begin(int32 InNumChannels, int32 InSampleRate, int64 InNumFrames)
+	{
+		FSubmixRecorderSettings Settings;
+		Settings.FilePath = FilePath;
+		Settings.NumChannels = InNumChannels;
+		Settings.SampleRate = InSampleRate;
+		Settings.Format = Format;
+		Settings.bWaitWhenFull = true;
+
+		NumChannels = InNumChannels;
+		return Recorder.StartRecording(Settings);
+	}
+
+	bool FMixerOfflineFileSink::Write(const float* InAudio, int32 InNumSamples)
+	{
+		Recorder.PushAudio(InAudio, InNumSamples, NumChannels);
+		return Recorder.GetNumDroppedBlocks() == 0;
+	}
+
+	void FMixerOfflineFileSink::End()
+	{
+		Recorder.StopRecording();
+	}
+
+	FMixerOfflineRenderer::FMixerOfflineRenderer(FMixerDevice& InMixerDevice, float InOutputGain)
+		: MixerDevice(InMixerDevice)
+		, OutputGain(InOutputGain)
+	{
+	}
+
+	FMixerOfflineRenderStats FMixerOfflineRenderer::Render(IMixerOfflineSink& InSink, double InDurationSeconds)
+	{
+		FMixerOfflineRenderStats Stats;
+
+		const int32 NumChannels = MixerDevice.GetNumDeviceChannels();
+		const int32 NumFramesPerBlock = MixerDevice.GetNumOutputFrames();
+		const int32 SampleRate = (int32)MixerDevice.GetSampleRate();
+		if (!ensure(NumChannels > 0 && NumFramesPerBlock > 0 && SampleRate > 0))
+		{
+			return Stats;
+		}
+
+		const int64 NumBlocks = FMath::Max<int64>((int64)FMath::CeilToDouble(InDurationSeconds * SampleRate / NumFramesPerBlock), 0);
+		const int32 NumSamplesPerBlock = NumFramesPerBlock * NumChannels;
+		Stats.SampleRate = SampleRate;
+
+		if (!InSink.Begin(NumChannels, SampleRate, NumBlocks * NumFramesPerBlock))
+		{
+			InSink.End();
+			return Stats;
+		}
+
+		RenderBuffer.SetNumUninitialized(NumSamplesPerBlock);
+		const FMixerKernels& Kernels = GetMixerKernels();
+
+		Stats.bSucceeded = true;
+		const double StartTime = FPlatformTime::Seconds();
+
+		for (int64 Block = 0; Block < NumBlocks; ++Block)
+		{
+			// The same steps as FOutputBuffer::MixNextBuffer, minus the circular queue and the wait for the device.
+			FMemory::Memzero(RenderBuffer.GetData(), NumSamplesPerBlock * sizeof(float));
+			MixerDevice.OnProcessAudioStream(RenderBuffer);
+			Kernels.ConvertToFloat(RenderBuffer.GetData(), RenderBuffer.GetData(), NumSamplesPerBlock, OutputGain);
+
+			if (!InSink.Write(RenderBuffer.GetData(), NumSamplesPerBlock))
+			{
+				UE_LOG(LogAudioMixer, Warning, TEXT("Offline render aborted by its sink after %lld of %lld blocks."), Block, NumBlocks);
+				Stats.bSucceeded = false;
+				break;
+			}
+
+			Stats.NumFramesRendered += NumFramesPerBlock;
+		}
+
+		Stats.RenderSeconds = FPlatformTime::Seconds() - StartTime;
+		InSink.End();
+
+		UE_LOG(LogAudioMixer, Verbose, TEXT("Offline render of %lld frames took %.3f s (%.1fx real time)."), Stats.NumFramesRendered, Stats.RenderSeconds, Stats.GetRealtimeFactor());
+		return Stats;
+	}
+
+	void FMixerOfflineRenderer::RenderJobs(TArrayView<FMixerOfflineRenderJob> InJobs, float InOutputGain)
+	{
+		// Renders are long and uneven, so hand out one job at a time rather than in batches.
+		ParallelFor(InJobs.Num(), [&InJobs, InOutputGain](int32 JobIndex)
+		{
+			FMixerOfflineRenderJob& Job = InJobs[JobIndex];
+			if (ensure(Job.MixerDevice && Job.Sink))
+			{
+				FMixerOfflineRenderer Renderer(*Job.MixerDevice, InOutputGain);
+				Job.Stats = Renderer.Render(*Job.Sink, Job.DurationSeconds);
+			}
+		}, EParallelForFlags::Unbalanced);
+	}
+}
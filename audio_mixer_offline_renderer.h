@@ -0,0 +1,129 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AudioMixer.h"
+#include "audio_mixer_submix_recorder.h"
+
+namespace Audio
+{
+	class FMixerDevice;
+
+	/** Receives the output of an offline render. */
+	class IMixerOfflineSink
+	{
+	public:
+		virtual ~IMixerOfflineSink() {}
+
+		/** Called before the first block. Returns false if the sink can't take the render. */
+		virtual bool Begin(int32 InNumChannels, int32 InSampleRate, int64 InNumFrames) = 0;
+
+		/** Takes a block of interleaved float audio. Returns false to abort the render. */
+		virtual bool Write(const float* InAudio, int32 InNumSamples) = 0;
+
+		/** Called after the last block, including when the render was aborted. */
+		virtual void End() = 0;
+	};
+
+	/** Collects the rendered audio in memory. */
+	class FMixerOfflineMemorySink : public IMixerOfflineSink
+	{
+	public:
+		//~ Begin IMixerOfflineSink
+		virtual bool Begin(int32 InNumChannels, int32 InSampleRate, int64 InNumFrames) override;
+		virtual bool Write(const float* InAudio, int32 InNumSamples) override;
+		virtual void End() override {}
+		//~ End IMixerOfflineSink
+
+		const TArray<float>& GetSamples() const { return Samples; }
+		int32 GetNumChannels() const { return NumChannels; }
+		int32 GetSampleRate() const { return SampleRate; }
+
+	private:
+		TArray<float> Samples;
+		int32 NumChannels = 0;
+		int32 SampleRate = 0;
+	};
+
+	/** Streams the rendered audio to a WAV file through a submix recorder that waits for its writer instead of dropping blocks. */
+	class FMixerOfflineFileSink : public IMixerOfflineSink
+	{
+	public:
+		FMixerOfflineFileSink(const FString& InFilePath, ESubmixRecordingFormat InFormat = ESubmixRecordingFormat::Float32);
+
+		//~ Begin IMixerOfflineSink
+		virtual bool Begin(int32 InNumChannels, int32 InSampleRate, int64 InNumFrames) override;
+		virtual bool Write(const float* InAudio, int32 InNumSamples) override;
+		virtual void End() override;
+		//~ End IMixerOfflineSink
+
+	private:
+		FString FilePath;
+		ESubmixRecordingFormat Format;
+		int32 NumChannels;
+		FMixerSubmixRecorder Recorder;
+	};
+
+	/** Result of an offline render. */
+	struct FMixerOfflineRenderStats
+	{
+		bool bSucceeded = false;
+		int64 NumFramesRendered = 0;
+		int32 SampleRate = 0;
+
+		/** Wall clock time the render took. */
+		double RenderSeconds = 0.0;
+
+		/** Seconds of audio rendered per second of wall clock time. */
+		double GetRealtimeFactor() const
+		{
+			return RenderSeconds > 0.0 && SampleRate > 0 ? ((double)NumFramesRendered / SampleRate) / RenderSeconds : 0.0;
+		}
+	};
+
+	/** One device to render offline, for running many renders at once. */
+	struct FMixerOfflineRenderJob
+	{
+		FMixerDevice* MixerDevice = nullptr;
+		IMixerOfflineSink* Sink = nullptr;
+		double DurationSeconds = 0.0;
+
+		/** Filled in by the render. */
+		FMixerOfflineRenderStats Stats;
+	};
+
+	/**
+	 * Drives a mixer device's render loop as fast as the CPU allows, without a platform device.
+	 *
+	 * Each block is rendered with OnProcessAudioStream, put through the same float output stage as
+	 * the device output (gain and clamp) and handed to a sink. Nothing paces the loop, so a render
+	 * runs faster than real time for batch mix-downs and regression captures, or as a load generator
+	 * when profiling. The device must be opened on a non-realtime platform whose stream isn't
+	 * started, so this is the only caller of its render loop; its audio clock then advances by
+	 * exactly one block per block and repeated renders of the same content are identical.
+	 *
+	 * Devices share no render state, so independent devices can be rendered in parallel.
+	 */
+	class FMixerOfflineRenderer
+	{
+	public:
+		/**
+		 * @param InMixerDevice The device to render.
+		 * @param InOutputGain Gain of the output stage, the offline equivalent of au.LinearGainScalarForFinalOutut.
+		 */
+		explicit FMixerOfflineRenderer(FMixerDevice& InMixerDevice, float InOutputGain = 1.0f);
+
+		/**
+		 * Renders the given duration, rounded up to whole blocks, into the sink. The calling thread acts as the
+		 * device's audio render thread for the duration of the call.
+		 */
+		FMixerOfflineRenderStats Render(IMixerOfflineSink& InSink, double InDurationSeconds);
+
+		/** Renders each job on its own device, spreading the jobs across the task graph's worker threads. */
+		static void RenderJobs(TArrayView<FMixerOfflineRenderJob> InJobs, float InOutputGain = 1.0f);
+
+	private:
+		FMixerDevice& MixerDevice;
+		float OutputGain;
+		AlignedFloatBuffer RenderBuffer;
+	};
+}
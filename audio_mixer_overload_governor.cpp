@@ -0,0 +1,205 @@
+#include "audio_mixer_overload_governor.h"
+#include "AudioMixerLog.h"
+#include "HAL/PlatformTime.h"
+
+static float OverloadBypassEffectsLoadCVar = 0.75f;
+FAutoConsoleVariableRef CVarOverloadBypassEffectsLoad(
+	TEXT("au.Overload.BypassEffectsLoad"),
+	OverloadBypassEffectsLoadCVar,
+	TEXT("Render load (fraction of the block deadline) at which effect chains of low priority submixes are bypassed (default: 0.75)."),
+	ECVF_Default);
+
+static float OverloadSkipAnalysisLoadCVar = 0.85f;
+FAutoConsoleVariableRef CVarOverloadSkipAnalysisLoad(
+	TEXT("au.Overload.SkipAnalysisLoad"),
+	OverloadSkipAnalysisLoadCVar,
+	TEXT("Render load at which submix analysis and buffer listeners are skipped (default: 0.85)."),
+	ECVF_Default);
+
+static float OverloadReduceVoicesLoadCVar = 0.95f;
+FAutoConsoleVariableRef CVarOverloadReduceVoicesLoad(
+	TEXT("au.Overload.ReduceVoicesLoad"),
+	OverloadReduceVoicesLoadCVar,
+	TEXT("Render load at which the number of voices is reduced (default: 0.95)."),
+	ECVF_Default);
+
+static float OverloadRestoreHysteresisCVar = 0.1f;
+FAutoConsoleVariableRef CVarOverloadRestoreHysteresis(
+	TEXT("au.Overload.RestoreHysteresis"),
+	OverloadRestoreHysteresisCVar,
+	TEXT("How far below its threshold the load must fall before a degradation step is restored (default: 0.1)."),
+	ECVF_Default);
+
+static float OverloadRestoreHoldTimeCVar = 2.0f;
+FAutoConsoleVariableRef CVarOverloadRestoreHoldTime(
+	TEXT("au.Overload.RestoreHoldTime"),
+	OverloadRestoreHoldTimeCVar,
+	TEXT("Seconds the load must stay low before a degradation step is restored (default: 2)."),
+	ECVF_Default);
+
+static float OverloadSmoothingTimeCVar = 0.1f;
+FAutoConsoleVariableRef CVarOverloadSmoothingTime(
+	TEXT("au.Overload.SmoothingTime"),
+	OverloadSmoothingTimeCVar,
+	TEXT("Time constant of the render load estimate, in seconds (default: 0.1)."),
+	ECVF_Default);
+
+static float OverloadVoiceScaleCVar = 0.5f;
+FAutoConsoleVariableRef CVarOverloadVoiceScale(
+	TEXT("au.Overload.VoiceScale"),
+	OverloadVoiceScaleCVar,
+	TEXT("Fraction of the maximum number of voices kept while voices are reduced (default: 0.5)."),
+	ECVF_Default);
+
+namespace Audio
+{
+	namespace OverloadGovernor
+	{
+		/** Xruns are logged at most this often, with the number that happened in between. */
+		static const double XrunLogIntervalSeconds = 1.0;
+
+		static const TCHAR* LevelNames[] =
+		{
+			TEXT("None"),
+			TEXT("BypassLowPriorityEffects"),
+			TEXT("SkipAnalysisAndListeners"),
+			TEXT("ReduceVoices")
+		};
+		static_assert(UE_ARRAY_COUNT(LevelNames) == (int32)EMixerOverloadLevel::Count, "Every overload level needs a name.");
+	}
+
+	FMixerOverloadGovernor::FMixerOverloadGovernor()
+		: Level(0)
+		, SmoothedLoad(0.0f)
+		, LevelChangeLoad(0.0f)
+		, LastXrunRenderMs(0.0f)
+		, LastXrunDeadlineMs(0.0f)
+		, BlockStartCycles(0)
+		, RestoreTimeSeconds(0.0f)
+		, LoggedLevel(0)
+		, NumLoggedXruns(0)
+		, LastXrunLogTime(0.0)
+	{
+	}
+
+	void FMixerOverloadGovernor::Reset()
+	{
+		Level.store(0, std::memory_order_relaxed);
+		SmoothedLoad.store(0.0f, std::memory_order_relaxed);
+		RestoreTimeSeconds = 0.0f;
+	}
+
+	void FMixerOverloadGovernor::BeginBlock()
+	{
+		BlockStartCycles = FPlatformTime::Cycles64();
+	}
+
+	void FMixerOverloadGovernor::EndBlock(int32 InNumFrames, float InSampleRate)
+	{
+		if (InNumFrames <= 0 || InSampleRate <= 0.0f)
+		{
+			return;
+		}
+
+		const double RenderSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - BlockStartCycles);
+		const float DeadlineSeconds = InNumFrames / InSampleRate;
+		const float BlockLoad = (float)(RenderSeconds / DeadlineSeconds);
+
+		FMixerOverloadCounters::Increment(Counters.NumBlocks);
+
+		// One pole smoothing with a time constant in seconds, so the estimate reacts equally fast at any block size.
+		const float SmoothingTime = FMath::Max(OverloadSmoothingTimeCVar, 0.0f);
+		const float Alpha = SmoothingTime > 0.0f ? 1.0f - FMath::Exp(-DeadlineSeconds / SmoothingTime) : 1.0f;
+		const float Load = SmoothedLoad.load(std::memory_order_relaxed) + Alpha * (BlockLoad - SmoothedLoad.load(std::memory_order_relaxed));
+		SmoothedLoad.store(Load, std::memory_order_relaxed);
+
+		const bool bIsXrun = BlockLoad > 1.0f;
+		if (bIsXrun)
+		{
+			LastXrunRenderMs.store((float)(RenderSeconds * 1000.0), std::memory_order_relaxed);
+			LastXrunDeadlineMs.store(DeadlineSeconds * 1000.0f, std::memory_order_relaxed);
+			FMixerOverloadCounters::Increment(Counters.NumXruns);
+		}
+
+		const int32 CurrentLevel = Level.load(std::memory_order_relaxed);
+		const int32 MaxLevel = (int32)EMixerOverloadLevel::Count - 1;
+
+		// Degrade one step per block while the load is over the next threshold. A missed deadline
+		// degrades right away, since the smoothed load lags behind a sudden spike.
+		if (CurrentLevel < MaxLevel && (Load >= GetEngageLoad(CurrentLevel + 1) || bIsXrun))
+		{
+			FMixerOverloadCounters::Increment(Counters.NumDegradations);
+			SetLevel(CurrentLevel + 1, Load);
+			return;
+		}
+
+		// Restore a step only after the load has stayed clearly below its threshold for a while.
+		if (CurrentLevel > 0 && Load < GetEngageLoad(CurrentLevel) - OverloadRestoreHysteresisCVar)
+		{
+			RestoreTimeSeconds += DeadlineSeconds;
+			if (RestoreTimeSeconds >= OverloadRestoreHoldTimeCVar)
+			{
+				FMixerOverloadCounters::Increment(Counters.NumRestorations);
+				SetLevel(CurrentLevel - 1, Load);
+			}
+		}
+		else
+		{
+			RestoreTimeSeconds = 0.0f;
+		}
+	}
+
+	float FMixerOverloadGovernor::GetVoiceScale() const
+	{
+		return IsAtLeast(EMixerOverloadLevel::ReduceVoices) ? FMath::Clamp(OverloadVoiceScaleCVar, 0.0f, 1.0f) : 1.0f;
+	}
+
+	float FMixerOverloadGovernor::GetEngageLoad(int32 InLevel)
+	{
+		switch ((EMixerOverloadLevel)InLevel)
+		{
+			case EMixerOverloadLevel::BypassLowPriorityEffects:
+				return OverloadBypassEffectsLoadCVar;
+
+			case EMixerOverloadLevel::SkipAnalysisAndListeners:
+				return OverloadSkipAnalysisLoadCVar;
+
+			case EMixerOverloadLevel::ReduceVoices:
+				return OverloadReduceVoicesLoadCVar;
+
+			default:
+				return 0.0f;
+		}
+	}
+
+	void FMixerOverloadGovernor::SetLevel(int32 InLevel, float InLoad)
+	{
+		LevelChangeLoad.store(InLoad, std::memory_order_relaxed);
+		Level.store(InLevel, std::memory_order_relaxed);
+		RestoreTimeSeconds = 0.0f;
+	}
+
+	void FMixerOverloadGovernor::LogChanges()
+	{
+		// Steps taken between two calls are reported as one change, with the counters telling how many there were.
+		const int32 CurrentLevel = Level.load(std::memory_order_relaxed);
+		if (CurrentLevel != LoggedLevel)
+		{
+			UE_LOG(LogAudioMixer, Display, TEXT("Audio render overload level %s -> %s at %.0f%% load (%llu degradations, %llu restorations)."),
+				OverloadGovernor::LevelNames[LoggedLevel], OverloadGovernor::LevelNames[CurrentLevel], LevelChangeLoad.load(std::memory_order_relaxed) * 100.0f,
+				(unsigned long long)Counters.NumDegradations.load(std::memory_order_relaxed), (unsigned long long)Counters.NumRestorations.load(std::memory_order_relaxed));
+			LoggedLevel = CurrentLevel;
+		}
+
+		const uint64 NumXruns = Counters.NumXruns.load(std::memory_order_relaxed);
+		const double Now = FPlatformTime::Seconds();
+		if (NumXruns != NumLoggedXruns && Now - LastXrunLogTime >= OverloadGovernor::XrunLogIntervalSeconds)
+		{
+			UE_LOG(LogAudioMixer, Warning, TEXT("Audio render xrun: block took %.2f ms of a %.2f ms deadline (%llu xruns since last report, %llu total)."),
+				LastXrunRenderMs.load(std::memory_order_relaxed), LastXrunDeadlineMs.load(std::memory_order_relaxed),
+				(unsigned long long)(NumXruns - NumLoggedXruns), (unsigned long long)NumXruns);
+			NumLoggedXruns = NumXruns;
+			LastXrunLogTime = Now;
+		}
+	}
+}
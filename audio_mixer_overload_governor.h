@@ -0,0 +1,125 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+namespace Audio
+{
+	/** Degradation steps of the overload governor. Each step includes the ones before it. */
+	enum class EMixerOverloadLevel : int32
+	{
+		/** Everything renders. */
+		None,
+
+		/** Effect chains of low priority submixes are bypassed. */
+		BypassLowPriorityEffects,
+
+		/** Spectrum analysis, envelope following and buffer listeners are skipped as well. */
+		SkipAnalysisAndListeners,
+
+		/** The number of voices is scaled down as well. */
+		ReduceVoices,
+
+		Count
+	};
+
+	/** How readily a submix's effect chains are bypassed when the render thread is overloaded. */
+	enum class EMixerSubmixEffectPriority : uint8
+	{
+		/** Bypassed from the first degradation step. */
+		Low,
+
+		/** Never bypassed by the governor. */
+		Normal
+	};
+
+	/** Counters of the overload governor. Written by the audio render thread, readable from anywhere. */
+	struct FMixerOverloadCounters
+	{
+		/** Blocks measured. */
+		std::atomic<uint64> NumBlocks { 0 };
+
+		/** Blocks that took longer to render than they last. */
+		std::atomic<uint64> NumXruns { 0 };
+
+		/** Steps taken towards more degradation, and back. */
+		std::atomic<uint64> NumDegradations { 0 };
+		std::atomic<uint64> NumRestorations { 0 };
+
+		/** Increments a counter. Audio render thread only. */
+		static void Increment(std::atomic<uint64>& Counter)
+		{
+			Counter.store(Counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+	};
+
+	/**
+	 * Deadline-aware overload governor of the render callback.
+	 *
+	 * Measures each block's render cost against its deadline (the time the block lasts at the
+	 * device sample rate) and keeps a smoothed load estimate. When the load crosses the thresholds
+	 * set by the au.Overload console variables, rendering is degraded one EMixerOverloadLevel step
+	 * per block. A step is restored only once the load has stayed below its threshold, less a
+	 * hysteresis margin, for a hold time, so the governor doesn't flap around a threshold.
+	 *
+	 * BeginBlock and EndBlock are called by the audio render thread; the level, load and counters
+	 * can be read from any thread. The render thread never logs: it publishes level changes and xruns
+	 * through atomics, and LogChanges reports them from the game thread.
+	 */
+	class FMixerOverloadGovernor
+	{
+	public:
+		FMixerOverloadGovernor();
+
+		/** Restores every step and clears the load estimate, e.g. when the device format changes. */
+		void Reset();
+
+		/** Starts timing a block. */
+		void BeginBlock();
+
+		/** Stops timing a block of the given length and updates the degradation level. */
+		void EndBlock(int32 InNumFrames, float InSampleRate);
+
+		/** Returns the current degradation step. */
+		EMixerOverloadLevel GetLevel() const { return (EMixerOverloadLevel)Level.load(std::memory_order_relaxed); }
+
+		bool IsAtLeast(EMixerOverloadLevel InLevel) const { return Level.load(std::memory_order_relaxed) >= (int32)InLevel; }
+
+		/** Returns the smoothed render cost as a fraction of the block deadline. */
+		float GetLoad() const { return SmoothedLoad.load(std::memory_order_relaxed); }
+
+		/** Returns the fraction of the maximum voice count that should play, 1 unless voices are being reduced. */
+		float GetVoiceScale() const;
+
+		/** Logs level changes and xruns published since the last call, xruns at most once a second. Game thread only. */
+		void LogChanges();
+
+		const FMixerOverloadCounters& GetCounters() const { return Counters; }
+
+	private:
+		/** Returns the load at which the given step engages. */
+		static float GetEngageLoad(int32 InLevel);
+
+		void SetLevel(int32 InLevel, float InLoad);
+
+		std::atomic<int32> Level;
+		std::atomic<float> SmoothedLoad;
+
+		/** Load at the last level change, and the render time and deadline of the last xrun, in ms. Published for LogChanges. */
+		std::atomic<float> LevelChangeLoad;
+		std::atomic<float> LastXrunRenderMs;
+		std::atomic<float> LastXrunDeadlineMs;
+
+		uint64 BlockStartCycles;
+
+		/** Seconds the load has been low enough to restore the current step. */
+		float RestoreTimeSeconds;
+
+		/** Game thread: the level and xrun count last logged, and when xruns were last logged. */
+		int32 LoggedLevel;
+		uint64 NumLoggedXruns;
+		double LastXrunLogTime;
+
+		FMixerOverloadCounters Counters;
+	};
+}
@@ -0,0 +1,380 @@
+#include "audio_mixer_render_benchmark.h"
+#include "AudioMixerDevice.h"
+#include "AudioMixerLog.h"
+#include "AudioMixerSubmix.h"
+#include "ActiveSound.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Sound/SoundSubmix.h"
+#include "Sound/SoundWaveProcedural.h"
+#include "SubmixEffects/SubmixEffectDynamicsProcessor.h"
+#include "UObject/Package.h"
+
+namespace Audio
+{
+	namespace RenderBenchmark
+	{
+		/** Mono 16 bit frames in the noise block the voices loop over. */
+		static const int32 NumNoiseFrames = 4096;
+
+		static FString FormatDouble(double Value)
+		{
+			return FString::Printf(TEXT("%.3f"), Value);
+		}
+
+		/** Escapes a string for use inside a JSON string literal. */
+		static FString EscapeJsonString(const FString& InString)
+		{
+			FString Escaped;
+			Escaped.Reserve(InString.Len());
+			for (int32 Index = 0; Index < InString.Len(); ++Index)
+			{
+				const TCHAR Char = InString[Index];
+				if (Char == TEXT('"') || Char == TEXT('\\'))
+				{
+					Escaped.AppendChar(TEXT('\\'));
+					Escaped.AppendChar(Char);
+				}
+				else if ((uint32)Char < 0x20)
+				{
+					Escaped += FString::Printf(TEXT("\\u%04x"), (uint32)Char);
+				}
+				else
+				{
+					Escaped.AppendChar(Char);
+				}
+			}
+			return Escaped;
+		}
+	}
+
+	FString FMixerBenchmarkResult::ToJson() const
+	{
+		using namespace RenderBenchmark;
+
+		FString Json = TEXT("{");
+		Json += FString::Printf(TEXT("\"name\": \"%s\", "), *EscapeJsonString(Name));
+		Json += FString::Printf(TEXT("\"submixes\": %d, \"voices\": %d, \"blocks\": %d, "), NumSubmixes, NumSourceVoices, NumBlocks);
+		Json += FString::Printf(TEXT("\"frames_per_block\": %d, \"channels\": %d, \"sample_rate\": %d, \"render_workers\": %d, "), NumFramesPerBlock, NumChannels, SampleRate, NumRenderWorkers);
+		Json += FString::Printf(TEXT("\"block_us\": {\"p50\": %s, \"p90\": %s, \"p99\": %s, \"p99_9\": %s, \"max\": %s, \"mean\": %s}, "),
+			*FormatDouble(P50Microseconds), *FormatDouble(P90Microseconds), *FormatDouble(P99Microseconds), *FormatDouble(P999Microseconds), *FormatDouble(MaxMicroseconds), *FormatDouble(MeanMicroseconds));
+		Json += FString::Printf(TEXT("\"blocks_per_second\": %s, \"voices_per_second\": %s, "), *FormatDouble(BlocksPerSecond), *FormatDouble(VoicesPerSecond));
+		Json += AllocationsPerBlock >= 0.0 ? FString::Printf(TEXT("\"allocations_per_block\": %s"), *FormatDouble(AllocationsPerBlock)) : FString(TEXT("\"allocations_per_block\": null"));
+		Json += TEXT("}");
+		return Json;
+	}
+
+	FMixerRenderBenchmark::FMixerRenderBenchmark(FMixerDevice& InStubDevice)
+		: StubDevice(InStubDevice)
+		, TopSubmix(nullptr)
+		, CountingMalloc(nullptr)
+	{
+		// Fixed seed, so every run and every version plays the same noise.
+		FRandomStream RandomStream(0x5EED);
+		NoiseBlock.SetNumUninitialized(RenderBenchmark::NumNoiseFrames * sizeof(int16));
+		int16* NoiseSamples = reinterpret_cast<int16*>(NoiseBlock.GetData());
+		for (int32 Frame = 0; Frame < RenderBenchmark::NumNoiseFrames; ++Frame)
+		{
+			NoiseSamples[Frame] = (int16)RandomStream.RandRange(-8192, 8192);
+		}
+	}
+
+	FMixerRenderBenchmark::~FMixerRenderBenchmark()
+	{
+		ClearGraph();
+
+		// Runs uninstall the proxy before they return, so no call can still be inside it by now.
+		FMallocCountingProxy::Destroy(CountingMalloc);
+	}
+
+	USoundSubmixBase* FMixerRenderBenchmark::AddSubmix(UClass* InSubmixClass, USoundSubmixBase* InParent, int32 InNumEffects)
+	{
+		USoundSubmixBase* Submix = NewObject<USoundSubmixBase>(GetTransientPackage(), InSubmixClass, MakeUniqueObjectName(GetTransientPackage(), InSubmixClass, TEXT("BenchmarkSubmix")));
+		Submix->AddToRoot();
+
+		if (USoundSubmix* SoundSubmix = Cast<USoundSubmix>(Submix))
+		{
+			for (int32 EffectIndex = 0; EffectIndex < InNumEffects; ++EffectIndex)
+			{
+				USubmixEffectDynamicsProcessorPreset* Preset = NewObject<USubmixEffectDynamicsProcessorPreset>(GetTransientPackage());
+				Preset->AddToRoot();
+				SoundSubmix->SubmixEffectChain.Add(Preset);
+			}
+
+			if (USoundSubmix* ParentSubmix = Cast<USoundSubmix>(InParent))
+			{
+				SoundSubmix->ParentSubmix = ParentSubmix;
+				ParentSubmix->ChildSubmixes.Add(SoundSubmix);
+			}
+		}
+
+		// Submixes without a parent are routed to the master submix.
+		StubDevice.RegisterSoundSubmix(Submix, true);
+		Submixes.Add(Submix);
+		return Submix;
+	}
+
+	void FMixerRenderBenchmark::AddVoice(USoundSubmixBase* InSubmix)
+	{
+		USoundWaveProcedural* Wave = NewObject<USoundWaveProcedural>(GetTransientPackage());
+		Wave->AddToRoot();
+		Wave->SetSampleRate((int32)StubDevice.GetSampleRate());
+		Wave->NumChannels = 1;
+		Wave->Duration = INDEFINITELY_LOOPING_DURATION;
+		Wave->SoundGroup = SOUNDGROUP_Default;
+		Wave->bLooping = true;
+		Wave->SoundSubmixObject = InSubmix;
+
+		// Refill from the shared noise block whenever the voice runs dry. QueueAudio copies, so the block is never written.
+		const TArray<uint8>& Noise = NoiseBlock;
+		Wave->OnSoundWaveProceduralUnderflow.BindLambda([&Noise](USoundWaveProcedural* InWave, int32 InSamplesRequired)
+		{
+			for (int32 NumQueued = 0; NumQueued < InSamplesRequired; NumQueued += RenderBenchmark::NumNoiseFrames)
+			{
+				InWave->QueueAudio(Noise.GetData(), Noise.Num());
+			}
+		});
+
+		FActiveSound ActiveSound;
+		ActiveSound.SetSound(Wave);
+		ActiveSound.bIsUISound = true;
+		ActiveSound.bAllowSpatialization = false;
+		StubDevice.AddNewActiveSound(ActiveSound);
+
+		Voices.Add(Wave);
+	}
+
+	void FMixerRenderBenchmark::BuildGraph(const FMixerBenchmarkGraphSettings& InSettings)
+	{
+		ClearGraph();
+		GraphSettings = InSettings;
+
+		const int32 Depth = FMath::Max(InSettings.Depth, 1);
+		const int32 FanOut = FMath::Max(InSettings.FanOut, 1);
+
+		TopSubmix = AddSubmix(USoundSubmix::StaticClass(), nullptr, InSettings.NumEffectsPerSubmix);
+
+		TArray<USoundSubmixBase*> Level = { TopSubmix };
+		for (int32 LevelIndex = 1; LevelIndex < Depth; ++LevelIndex)
+		{
+			TArray<USoundSubmixBase*> NextLevel;
+			for (USoundSubmixBase* Parent : Level)
+			{
+				for (int32 ChildIndex = 0; ChildIndex < FanOut; ++ChildIndex)
+				{
+					NextLevel.Add(AddSubmix(USoundSubmix::StaticClass(), Parent, InSettings.NumEffectsPerSubmix));
+				}
+			}
+			Level = MoveTemp(NextLevel);
+		}
+
+		for (int32 Index = 0; Index < InSettings.NumSoundfieldSubmixes; ++Index)
+		{
+			AddSubmix(USoundfieldSubmix::StaticClass(), nullptr, 0);
+		}
+
+		for (int32 Index = 0; Index < InSettings.NumEndpointSubmixes; ++Index)
+		{
+			AddSubmix(UEndpointSubmix::StaticClass(), nullptr, 0);
+		}
+
+		for (int32 VoiceIndex = 0; VoiceIndex < InSettings.NumSourceVoices; ++VoiceIndex)
+		{
+			AddVoice(Level[VoiceIndex % Level.Num()]);
+		}
+
+		// Let the game thread start the voices and the render thread pick up the new graph and sources.
+		StubDevice.Update(true);
+		RenderBuffer.SetNumZeroed(StubDevice.GetNumOutputFrames() * StubDevice.GetNumDeviceChannels());
+		StubDevice.OnProcessAudioStream(RenderBuffer);
+	}
+
+	void FMixerRenderBenchmark::ClearGraph()
+	{
+		if (Submixes.Num() == 0 && Voices.Num() == 0)
+		{
+			return;
+		}
+
+		StubDevice.StopAllSounds(true);
+		StubDevice.Update(true);
+
+		for (USoundWaveProcedural* Wave : Voices)
+		{
+			Wave->OnSoundWaveProceduralUnderflow.Unbind();
+			Wave->RemoveFromRoot();
+		}
+		Voices.Reset();
+
+		// Children first, so no submix is unregistered while it still has registered children.
+		for (int32 Index = Submixes.Num() - 1; Index >= 0; --Index)
+		{
+			USoundSubmixBase* Submix = Submixes[Index];
+			StubDevice.UnregisterSoundSubmix(Submix);
+
+			if (USoundSubmix* SoundSubmix = Cast<USoundSubmix>(Submix))
+			{
+				for (USoundEffectSubmixPreset* Preset : SoundSubmix->SubmixEffectChain)
+				{
+					Preset->RemoveFromRoot();
+				}
+			}
+			Submix->RemoveFromRoot();
+		}
+		Submixes.Reset();
+		TopSubmix = nullptr;
+
+		// Flush the unregistration commands.
+		StubDevice.OnProcessAudioStream(RenderBuffer);
+	}
+
+	FMixerBenchmarkResult FMixerRenderBenchmark::RunDeviceBenchmark(const FString& InName, int32 InNumWarmupBlocks, int32 InNumBlocks, bool bInCountAllocations)
+	{
+		return Run(InName, InNumWarmupBlocks, InNumBlocks, bInCountAllocations, [this]()
+		{
+			FMemory::Memzero(RenderBuffer.GetData(), RenderBuffer.Num() * sizeof(float));
+			StubDevice.OnProcessAudioStream(RenderBuffer);
+		});
+	}
+
+	FMixerBenchmarkResult FMixerRenderBenchmark::RunSubmixBenchmark(const FString& InName, int32 InNumWarmupBlocks, int32 InNumBlocks, bool bInCountAllocations)
+	{
+		FMixerSubmixPtr Submix = TopSubmix ? StubDevice.GetSubmixInstance(TopSubmix).Pin() : FMixerSubmixPtr();
+		if (!ensure(Submix.IsValid()))
+		{
+			return FMixerBenchmarkResult();
+		}
+
+		return Run(InName, InNumWarmupBlocks, InNumBlocks, bInCountAllocations, [this, &Submix]()
+		{
+			FMemory::Memzero(RenderBuffer.GetData(), RenderBuffer.Num() * sizeof(float));
+			Submix->ProcessAudio(RenderBuffer);
+		});
+	}
+
+	TArray<FMixerBenchmarkResult> FMixerRenderBenchmark::RunSourceMixComparison(const FString& InName, int32 InNumWarmupBlocks, int32 InNumBlocks, bool bInCountAllocations)
+	{
+		TArray<FMixerBenchmarkResult> Results;
+
+		IConsoleVariable* BatchedMixingCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("au.Submix.BatchedSourceMixing"));
+		if (!ensure(BatchedMixingCVar))
+		{
+			return Results;
+		}
+
+		// The voices' buffers stay from the last device block, so only the submix's mixing is timed.
+		const int32 PreviousValue = BatchedMixingCVar->GetInt();
+
+		BatchedMixingCVar->Set(0, ECVF_SetByCode);
+		Results.Add(RunSubmixBenchmark(InName + TEXT(" per-voice"), InNumWarmupBlocks, InNumBlocks, bInCountAllocations));
+
+		BatchedMixingCVar->Set(1, ECVF_SetByCode);
+		Results.Add(RunSubmixBenchmark(InName + TEXT(" batched"), InNumWarmupBlocks, InNumBlocks, bInCountAllocations));
+
+		BatchedMixingCVar->Set(PreviousValue, ECVF_SetByCode);
+		return Results;
+	}
+
+	TArray<FMixerBenchmarkResult> FMixerRenderBenchmark::RunParallelRenderSweep(const FString& InName, int32 InMaxRenderWorkers, int32 InNumWarmupBlocks, int32 InNumBlocks, bool bInCountAllocations)
+	{
+		TArray<FMixerBenchmarkResult> Results;
+
+		IConsoleVariable* ParallelRenderCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("au.Submix.ParallelRender"));
+		if (!ensure(ParallelRenderCVar))
+		{
+			return Results;
+		}
+
+		// The device restarts its render pool on the first block after the worker count changes, which the warmup absorbs.
+		const int32 PreviousValue = ParallelRenderCVar->GetInt();
+
+		for (int32 NumWorkers = 0; NumWorkers <= InMaxRenderWorkers; ++NumWorkers)
+		{
+			ParallelRenderCVar->Set(NumWorkers, ECVF_SetByCode);
+			Results.Add(RunDeviceBenchmark(FString::Printf(TEXT("%s %d workers"), *InName, NumWorkers), InNumWarmupBlocks, InNumBlocks, bInCountAllocations));
+		}
+
+		ParallelRenderCVar->Set(PreviousValue, ECVF_SetByCode);
+		return Results;
+	}
+
+	FMixerBenchmarkResult FMixerRenderBenchmark::Run(const FString& InName, int32 InNumWarmupBlocks, int32 InNumBlocks, bool bInCountAllocations, TFunctionRef<void()> InRenderBlock)
+	{
+		FMixerBenchmarkResult Result;
+		Result.Name = InName;
+		Result.NumSubmixes = Submixes.Num();
+		Result.NumSourceVoices = Voices.Num();
+		Result.NumFramesPerBlock = StubDevice.GetNumOutputFrames();
+		Result.NumChannels = StubDevice.GetNumDeviceChannels();
+		Result.SampleRate = (int32)StubDevice.GetSampleRate();
+
+		if (IConsoleVariable* ParallelRenderCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("au.Submix.ParallelRender")))
+		{
+			Result.NumRenderWorkers = FMath::Max(ParallelRenderCVar->GetInt(), 0);
+		}
+
+		RenderBuffer.SetNumZeroed(Result.NumFramesPerBlock * Result.NumChannels);
+
+		// Warm up caches, lazily allocated buffers and the voices' decoders.
+		for (int32 Block = 0; Block < InNumWarmupBlocks; ++Block)
+		{
+			InRenderBlock();
+		}
+
+		TimingStats.Reset();
+		if (bInCountAllocations)
+		{
+			CountingMalloc = FMallocCountingProxy::Install(CountingMalloc);
+		}
+
+		for (int32 Block = 0; Block < InNumBlocks; ++Block)
+		{
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			InRenderBlock();
+			TimingStats.AddBlock(FPlatformTime::Cycles64() - StartCycles);
+		}
+
+		if (bInCountAllocations)
+		{
+			const uint64 NumAllocations = CountingMalloc->GetNumAllocations();
+			FMallocCountingProxy::Uninstall(CountingMalloc);
+			Result.AllocationsPerBlock = InNumBlocks > 0 ? (double)NumAllocations / InNumBlocks : 0.0;
+		}
+
+		Result.NumBlocks = TimingStats.GetNumBlocks();
+		Result.P50Microseconds = TimingStats.GetPercentileMicroseconds(50.0);
+		Result.P90Microseconds = TimingStats.GetPercentileMicroseconds(90.0);
+		Result.P99Microseconds = TimingStats.GetPercentileMicroseconds(99.0);
+		Result.P999Microseconds = TimingStats.GetPercentileMicroseconds(99.9);
+		Result.MaxMicroseconds = TimingStats.GetMaxMicroseconds();
+		Result.MeanMicroseconds = TimingStats.GetMeanMicroseconds();
+
+		const double TotalSeconds = TimingStats.GetTotalSeconds();
+		if (TotalSeconds > 0.0)
+		{
+			Result.BlocksPerSecond = Result.NumBlocks / TotalSeconds;
+			Result.VoicesPerSecond = Result.BlocksPerSecond * Result.NumSourceVoices;
+		}
+
+		UE_LOG(LogAudioMixer, Display, TEXT("Render benchmark %s: p50 %.1f us, p99 %.1f us, %.0f blocks/s."), *InName, Result.P50Microseconds, Result.P99Microseconds, Result.BlocksPerSecond);
+		return Result;
+	}
+
+	FString FMixerRenderBenchmark::ResultsToJson(TArrayView<const FMixerBenchmarkResult> InResults)
+	{
+		FString Json = TEXT("{\n\t\"results\": [");
+		for (int32 Index = 0; Index < InResults.Num(); ++Index)
+		{
+			Json += Index > 0 ? TEXT(",\n\t\t") : TEXT("\n\t\t");
+			Json += InResults[Index].ToJson();
+		}
+		Json += TEXT("\n\t]\n}\n");
+		return Json;
+	}
+
+	bool FMixerRenderBenchmark::SaveResultsToFile(TArrayView<const FMixerBenchmarkResult> InResults, const FString& InFilePath)
+	{
+		return FFileHelper::SaveStringToFile(ResultsToJson(InResults), *InFilePath);
+	}
+}
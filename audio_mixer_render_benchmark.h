@@ -0,0 +1,148 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AudioMixer.h"
+#include "audio_mixer_render_stats.h"
+
+class USoundSubmixBase;
+class USoundWaveProcedural;
+
+namespace Audio
+{
+	class FMixerDevice;
+
+	/** Shape of a synthetic submix graph. */
+	struct FMixerBenchmarkGraphSettings
+	{
+		/** Levels of submixes below the master submix. */
+		int32 Depth = 3;
+
+		/** Children of each submix above the last level. */
+		int32 FanOut = 2;
+
+		/** Looping noise voices, spread round-robin over the leaf submixes. */
+		int32 NumSourceVoices = 32;
+
+		/** Effects in the chain of every submix. */
+		int32 NumEffectsPerSubmix = 0;
+
+		/** Soundfield submixes added at the top level, next to the tree. */
+		int32 NumSoundfieldSubmixes = 0;
+
+		/** Endpoint submixes using the default endpoint, added at the top level. */
+		int32 NumEndpointSubmixes = 0;
+	};
+
+	/** Result of one benchmark run. */
+	struct FMixerBenchmarkResult
+	{
+		FString Name;
+
+		int32 NumSubmixes = 0;
+		int32 NumSourceVoices = 0;
+		int32 NumBlocks = 0;
+		int32 NumFramesPerBlock = 0;
+		int32 NumChannels = 0;
+		int32 SampleRate = 0;
+
+		/** Render pool workers besides the render thread (au.Submix.ParallelRender) during the run. */
+		int32 NumRenderWorkers = 0;
+
+		/** Block render time percentiles, in microseconds. */
+		double P50Microseconds = 0.0;
+		double P90Microseconds = 0.0;
+		double P99Microseconds = 0.0;
+		double P999Microseconds = 0.0;
+		double MaxMicroseconds = 0.0;
+		double MeanMicroseconds = 0.0;
+
+		double BlocksPerSecond = 0.0;
+		double VoicesPerSecond = 0.0;
+
+		/** Allocations on all threads per timed block, or -1 when not counted. */
+		double AllocationsPerBlock = -1.0;
+
+		/** Returns the result as a JSON object. */
+		FString ToJson() const;
+	};
+
+	/**
+	 * Render benchmark over synthetic submix graphs.
+	 *
+	 * Builds a graph of transient submix objects on a stub device (a non-realtime device as used by
+	 * the offline renderer), plays looping noise voices into its leaves and times either whole device
+	 * blocks (OnProcessAudioStream) or the recursive ProcessAudio of the graph's top submix. Each run
+	 * reports block latency percentiles, throughput and allocations per block, and results are
+	 * written as JSON so they can be compared across versions.
+	 *
+	 * To be driven from the game thread; the calling thread also acts as the stub device's audio
+	 * render thread, so the device must not be rendered from anywhere else.
+	 */
+	class FMixerRenderBenchmark
+	{
+	public:
+		explicit FMixerRenderBenchmark(FMixerDevice& InStubDevice);
+		~FMixerRenderBenchmark();
+
+		/** Replaces the current graph with a new one. */
+		void BuildGraph(const FMixerBenchmarkGraphSettings& InSettings);
+
+		/** Stops the voices and unregisters and releases the graph's submixes. */
+		void ClearGraph();
+
+		/** Times whole device blocks. */
+		FMixerBenchmarkResult RunDeviceBenchmark(const FString& InName, int32 InNumWarmupBlocks, int32 InNumBlocks, bool bInCountAllocations = true);
+
+		/** Times ProcessAudio of the graph's top submix, which renders the whole tree below it. */
+		FMixerBenchmarkResult RunSubmixBenchmark(const FString& InName, int32 InNumWarmupBlocks, int32 InNumBlocks, bool bInCountAllocations = true);
+
+		/**
+		 * Times the top submix twice, mixing its source voices one at a time and then as one tiled batch
+		 * (au.Submix.BatchedSourceMixing), and returns both results. Build a graph of Depth 1 so every voice
+		 * sends to the timed submix.
+		 */
+		TArray<FMixerBenchmarkResult> RunSourceMixComparison(const FString& InName, int32 InNumWarmupBlocks, int32 InNumBlocks, bool bInCountAllocations = true);
+
+		/**
+		 * Times whole device blocks once per render pool size, from serial rendering up to InMaxRenderWorkers
+		 * workers (au.Submix.ParallelRender), and returns one result per size. Requires the execution plan
+		 * (au.Submix.UseExecutionPlan); a graph with a large FanOut gives the pool independent subtrees to spread.
+		 */
+		TArray<FMixerBenchmarkResult> RunParallelRenderSweep(const FString& InName, int32 InMaxRenderWorkers, int32 InNumWarmupBlocks, int32 InNumBlocks, bool bInCountAllocations = true);
+
+		/** Returns a JSON document holding all results. */
+		static FString ResultsToJson(TArrayView<const FMixerBenchmarkResult> InResults);
+
+		/** Writes the results as JSON. Returns false if the file can't be written. */
+		static bool SaveResultsToFile(TArrayView<const FMixerBenchmarkResult> InResults, const FString& InFilePath);
+
+	private:
+		/** Creates and registers a submix of the given class below InParent (or the master submix). */
+		USoundSubmixBase* AddSubmix(UClass* InSubmixClass, USoundSubmixBase* InParent, int32 InNumEffects);
+
+		/** Starts a looping noise voice sending to InSubmix. */
+		void AddVoice(USoundSubmixBase* InSubmix);
+
+		/** Runs a benchmark, calling InRenderBlock once per block. */
+		FMixerBenchmarkResult Run(const FString& InName, int32 InNumWarmupBlocks, int32 InNumBlocks, bool bInCountAllocations, TFunctionRef<void()> InRenderBlock);
+
+		FMixerDevice& StubDevice;
+		FMixerBenchmarkGraphSettings GraphSettings;
+
+		/** Everything the graph created, rooted until ClearGraph. */
+		TArray<USoundSubmixBase*> Submixes;
+		TArray<USoundWaveProcedural*> Voices;
+
+		/** Top submix of the tree. */
+		USoundSubmixBase* TopSubmix;
+
+		/** 16 bit noise the voices loop over. */
+		TArray<uint8> NoiseBlock;
+
+		AlignedFloatBuffer RenderBuffer;
+		FMixerBlockTimingStats TimingStats;
+
+		/** Counts allocations during runs that ask for it. Created by the first such run and reinstalled by the others. */
+		FMallocCountingProxy* CountingMalloc;
+	};
+}
@@ -0,0 +1,207 @@
+#include "audio_mixer_render_pool.h"
+#include "audio_mixer_frame_arena.h"
+
+namespace Audio
+{
+	FMixerRenderThreadPool::FWorker::FWorker(FMixerRenderThreadPool& InPool, int32 InQueueIndex)
+		: Pool(InPool)
+		, QueueIndex(InQueueIndex)
+		, WakeEvent(FPlatformProcess::GetSynchEventFromPool(false))
+		, Thread(nullptr)
+		, bStopping(false)
+	{
+		Thread = FRunnableThread::Create(this, *FString::Printf(TEXT("AudioMixerRenderWorker%d"), InQueueIndex), 0, TPri_TimeCritical);
+	}
+
+	FMixerRenderThreadPool::FWorker::~FWorker()
+	{
+		Join();
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	}
+
+	uint32 FMixerRenderThreadPool::FWorker::Run()
+	{
+		while (true)
+		{
+			WakeEvent->Wait();
+
+			if (bStopping.load())
+			{
+				break;
+			}
+
+			// A batch is one render block, so this is the worker's once-per-block arena reset.
+			FMixerFrameArena::Get().Reset();
+
+			Pool.WorkUntilBatchDone(QueueIndex);
+		}
+
+		return 0;
+	}
+
+	void FMixerRenderThreadPool::FWorker::Stop()
+	{
+		bStopping.store(true);
+		WakeEvent->Trigger();
+	}
+
+	void FMixerRenderThreadPool::FWorker::Wake()
+	{
+		WakeEvent->Trigger();
+	}
+
+	void FMixerRenderThreadPool::FWorker::Join()
+	{
+		if (Thread)
+		{
+			Stop();
+			Thread->WaitForCompletion();
+			delete Thread;
+			Thread = nullptr;
+		}
+	}
+
+	FMixerRenderThreadPool::FMixerRenderThreadPool()
+		: CurrentTaskFunction(nullptr)
+		, NumTasksRemaining(0)
+	{
+		Queues.Add(MakeUnique<FWorkQueue>());
+	}
+
+	FMixerRenderThreadPool::~FMixerRenderThreadPool()
+	{
+		Shutdown();
+	}
+
+	void FMixerRenderThreadPool::Init(int32 InNumWorkers)
+	{
+		Shutdown();
+
+		for (int32 WorkerIndex = 0; WorkerIndex < InNumWorkers; ++WorkerIndex)
+		{
+			const int32 QueueIndex = Queues.Add(MakeUnique<FWorkQueue>());
+			Workers.Add(MakeUnique<FWorker>(*this, QueueIndex));
+		}
+	}
+
+	void FMixerRenderThreadPool::Shutdown()
+	{
+		check(NumTasksRemaining.load() == 0);
+
+		for (TUniquePtr<FWorker>& Worker : Workers)
+		{
+			Worker->Join();
+		}
+
+		Workers.Reset();
+		Queues.SetNum(1);
+	}
+
+	void FMixerRenderThreadPool::Execute(TArrayView<const int32> InReadyTasks, int32 InNumTasks, FTaskFunction InTaskFunction)
+	{
+		check(NumTasksRemaining.load() == 0);
+
+		if (InNumTasks == 0)
+		{
+			return;
+		}
+
+		CurrentTaskFunction = &InTaskFunction;
+
+		// Set the count before any task is published. A worker still spinning from the previous batch may
+		// take a task as soon as it is queued, and its completion must not be overwritten by this store.
+		NumTasksRemaining.store(InNumTasks, std::memory_order_release);
+
+		// Deal the ready tasks round-robin so every participant starts with local work.
+		for (int32 ReadyIndex = 0; ReadyIndex < InReadyTasks.Num(); ++ReadyIndex)
+		{
+			FWorkQueue& Queue = *Queues[ReadyIndex % Queues.Num()];
+			FScopeLock Lock(&Queue.Lock);
+			Queue.Tasks.Add(InReadyTasks[ReadyIndex]);
+		}
+
+		const int32 NumWorkersToWake = FMath::Min(Workers.Num(), InReadyTasks.Num() - 1);
+		for (int32 WorkerIndex = 0; WorkerIndex < NumWorkersToWake; ++WorkerIndex)
+		{
+			Workers[WorkerIndex]->Wake();
+		}
+
+		WorkUntilBatchDone(0);
+
+		CurrentTaskFunction = nullptr;
+	}
+
+	void FMixerRenderThreadPool::WorkUntilBatchDone(int32 QueueIndex)
+	{
+		while (NumTasksRemaining.load(std::memory_order_acquire) > 0)
+		{
+			if (!RunOneTask(QueueIndex))
+			{
+				// Remaining tasks are in flight elsewhere; their continuations will finish the batch.
+				FPlatformProcess::Yield();
+			}
+		}
+	}
+
+	bool FMixerRenderThreadPool::RunOneTask(int32 QueueIndex)
+	{
+		int32 TaskIndex = PopTask(QueueIndex);
+
+		for (int32 Offset = 1; TaskIndex == INDEX_NONE && Offset < Queues.Num(); ++Offset)
+		{
+			TaskIndex = StealTask((QueueIndex + Offset) % Queues.Num());
+		}
+
+		if (TaskIndex == INDEX_NONE)
+		{
+			return false;
+		}
+
+		while (TaskIndex != INDEX_NONE)
+		{
+			const int32 NextTaskIndex = (*CurrentTaskFunction)(TaskIndex);
+			NumTasksRemaining.fetch_sub(1, std::memory_order_acq_rel);
+			TaskIndex = NextTaskIndex;
+		}
+
+		return true;
+	}
+
+	int32 FMixerRenderThreadPool::PopTask(int32 QueueIndex)
+	{
+		FWorkQueue& Queue = *Queues[QueueIndex];
+		FScopeLock Lock(&Queue.Lock);
+
+		if (Queue.Tasks.Num() > Queue.StealIndex)
+		{
+			const int32 TaskIndex = Queue.Tasks.Pop(false);
+			if (Queue.Tasks.Num() == Queue.StealIndex)
+			{
+				Queue.Tasks.Reset();
+				Queue.StealIndex = 0;
+			}
+			return TaskIndex;
+		}
+
+		return INDEX_NONE;
+	}
+
+	int32 FMixerRenderThreadPool::StealTask(int32 QueueIndex)
+	{
+		FWorkQueue& Queue = *Queues[QueueIndex];
+		FScopeLock Lock(&Queue.Lock);
+
+		if (Queue.Tasks.Num() > Queue.StealIndex)
+		{
+			const int32 TaskIndex = Queue.Tasks[Queue.StealIndex++];
+			if (Queue.Tasks.Num() == Queue.StealIndex)
+			{
+				Queue.Tasks.Reset();
+				Queue.StealIndex = 0;
+			}
+			return TaskIndex;
+		}
+
+		return INDEX_NONE;
+	}
+}
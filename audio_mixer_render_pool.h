@@ -0,0 +1,106 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include <atomic>
+
+namespace Audio
+{
+	/**
+	 * Small work-stealing thread pool used by the audio render thread to run a batch of
+	 * dependent render tasks (e.g. the nodes of a submix graph).
+	 *
+	 * Each participating thread owns a task deque. Owners pop from the back of their own
+	 * deque and steal from the front of the others when they run dry. A task may hand back
+	 * one task that it made ready, which the same thread then runs directly. The thread that
+	 * calls Execute participates as well, and Execute only returns once every task of the
+	 * batch has completed.
+	 */
+	class FMixerRenderThreadPool
+	{
+	public:
+
+		/** Runs a task and returns the index of a task it made ready, or INDEX_NONE. */
+		typedef TFunctionRef<int32(int32 TaskIndex)> FTaskFunction;
+
+		FMixerRenderThreadPool();
+		~FMixerRenderThreadPool();
+
+		/** Starts the given number of worker threads, stopping any previous ones. */
+		void Init(int32 InNumWorkers);
+
+		/** Stops and joins all worker threads. */
+		void Shutdown();
+
+		/** Returns the number of worker threads (not counting the thread calling Execute). */
+		int32 GetNumWorkers() const { return Workers.Num(); }
+
+		/**
+		 * Executes a batch of tasks.
+		 *
+		 * @param InReadyTasks The tasks that can run immediately.
+		 * @param InNumTasks The total number of tasks in the batch, including those made ready later.
+		 * @param InTaskFunction Called once per task.
+		 * @note Not reentrant. To be called only from the audio render thread.
+		 */
+		void Execute(TArrayView<const int32> InReadyTasks, int32 InNumTasks, FTaskFunction InTaskFunction);
+
+	private:
+
+		/** A task deque owned by one participating thread. */
+		struct FWorkQueue
+		{
+			FCriticalSection Lock;
+			TArray<int32> Tasks;
+			int32 StealIndex = 0;
+		};
+
+		/** A pool worker thread. */
+		class FWorker : public FRunnable
+		{
+		public:
+			FWorker(FMixerRenderThreadPool& InPool, int32 InQueueIndex);
+			virtual ~FWorker();
+
+			//~ Begin FRunnable
+			virtual uint32 Run() override;
+			virtual void Stop() override;
+			//~ End FRunnable
+
+			void Wake();
+			void Join();
+
+		private:
+			FMixerRenderThreadPool& Pool;
+			int32 QueueIndex;
+			FEvent* WakeEvent;
+			FRunnableThread* Thread;
+			std::atomic<bool> bStopping;
+		};
+
+		/** Runs tasks on behalf of the given queue until the current batch is complete. */
+		void WorkUntilBatchDone(int32 QueueIndex);
+
+		/** Pops or steals a task and runs it along with any continuation. Returns false if no task was found. */
+		bool RunOneTask(int32 QueueIndex);
+
+		/** Pops a task from the back of the given queue. */
+		int32 PopTask(int32 QueueIndex);
+
+		/** Steals a task from the front of the given queue. */
+		int32 StealTask(int32 QueueIndex);
+
+		/** Deques for the calling thread (index 0) and each worker. */
+		TArray<TUniquePtr<FWorkQueue>> Queues;
+
+		TArray<TUniquePtr<FWorker>> Workers;
+
+		/** Task function of the batch in flight. */
+		const FTaskFunction* CurrentTaskFunction;
+
+		/** Number of tasks of the batch in flight that have not completed yet. */
+		std::atomic<int32> NumTasksRemaining;
+	};
+}
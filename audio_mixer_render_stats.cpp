@@ -0,0 +1,104 @@
+#include "audio_mixer_render_stats.h"
+#include "HAL/PlatformTime.h"
+
+namespace Audio
+{
+	FMixerBlockTimingStats::FMixerBlockTimingStats()
+	{
+		Histogram.Reset();
+	}
+
+	void FMixerBlockTimingStats::Reset()
+	{
+		Histogram.Reset();
+	}
+
+	double FMixerBlockTimingStats::GetPercentileMicroseconds(double InPercentile) const
+	{
+		return FPlatformTime::ToMilliseconds64(Histogram.GetPercentile(InPercentile)) * 1000.0;
+	}
+
+	double FMixerBlockTimingStats::GetMeanMicroseconds() const
+	{
+		const int32 NumBlocks = GetNumBlocks();
+		return NumBlocks > 0 ? GetTotalSeconds() * 1000000.0 / NumBlocks : 0.0;
+	}
+
+	double FMixerBlockTimingStats::GetMaxMicroseconds() const
+	{
+		// Exact, unlike the bucketed percentiles.
+		return FPlatformTime::ToMilliseconds64(Histogram.MaxCycles.load(std::memory_order_relaxed)) * 1000.0;
+	}
+
+	double FMixerBlockTimingStats::GetTotalSeconds() const
+	{
+		return FPlatformTime::ToSeconds64(Histogram.TotalCycles.load(std::memory_order_relaxed));
+	}
+
+	FMallocCountingProxy::FMallocCountingProxy(FMalloc* InInnerMalloc)
+		: InnerMalloc(InInnerMalloc)
+		, NumAllocations(0)
+	{
+		check(InnerMalloc);
+	}
+
+	FMallocCountingProxy* FMallocCountingProxy::Install(FMallocCountingProxy* InProxy)
+	{
+		FMalloc* InnerMalloc = GMalloc;
+		check(InnerMalloc != InProxy);
+
+		FMallocCountingProxy* Proxy = InProxy;
+		if (Proxy)
+		{
+			Proxy->InnerMalloc = InnerMalloc;
+			Proxy->NumAllocations.store(0, std::memory_order_relaxed);
+		}
+		else
+		{
+			// The proxy itself must come from the allocator it wraps, not from itself.
+			Proxy = new(InnerMalloc->Malloc(sizeof(FMallocCountingProxy), alignof(FMallocCountingProxy))) FMallocCountingProxy(InnerMalloc);
+		}
+
+		GMalloc = Proxy;
+		return Proxy;
+	}
+
+	void FMallocCountingProxy::Uninstall(FMallocCountingProxy* InProxy)
+	{
+		if (InProxy)
+		{
+			check(GMalloc == InProxy);
+			GMalloc = InProxy->InnerMalloc;
+
+			// Another thread may still be inside one of the proxy's calls, so the proxy is kept until Destroy.
+		}
+	}
+
+	void FMallocCountingProxy::Destroy(FMallocCountingProxy* InProxy)
+	{
+		if (InProxy)
+		{
+			check(GMalloc != InProxy);
+			FMalloc* InnerMalloc = InProxy->InnerMalloc;
+			InProxy->~FMallocCountingProxy();
+			InnerMalloc->Free(InProxy);
+		}
+	}
+
+	void* FMallocCountingProxy::Malloc(SIZE_T Count, uint32 Alignment)
+	{
+		NumAllocations.fetch_add(1, std::memory_order_relaxed);
+		return InnerMalloc->Malloc(Count, Alignment);
+	}
+
+	void* FMallocCountingProxy::Realloc(void* Original, SIZE_T Count, uint32 Alignment)
+	{
+		NumAllocations.fetch_add(1, std::memory_order_relaxed);
+		return InnerMalloc->Realloc(Original, Count, Alignment);
+	}
+
+	void FMallocCountingProxy::Free(void* Original)
+	{
+		InnerMalloc->Free(Original);
+	}
+}
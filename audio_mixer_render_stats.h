@@ -0,0 +1,87 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/MemoryBase.h"
+#include "audio_mixer_timing_stats.h"
+#include <atomic>
+
+namespace Audio
+{
+	/**
+	 * Per-block render times of a run, for latency percentiles.
+	 *
+	 * Block times go into the same fixed-size histogram the submix timing stats use, so recording
+	 * a block never allocates and doesn't disturb allocation counts taken around the run.
+	 */
+	class FMixerBlockTimingStats
+	{
+	public:
+		FMixerBlockTimingStats();
+
+		/** Clears the stats. */
+		void Reset();
+
+		/** Records the time one block took, in FPlatformTime cycles. */
+		void AddBlock(uint64 InCycles)
+		{
+			Histogram.Record(InCycles);
+		}
+
+		int32 GetNumBlocks() const { return (int32)Histogram.Count.load(std::memory_order_relaxed); }
+
+		/** Returns the given percentile (0 to 100) of the block times, in microseconds, to within the histogram's resolution. */
+		double GetPercentileMicroseconds(double InPercentile) const;
+
+		double GetMeanMicroseconds() const;
+		double GetMaxMicroseconds() const;
+
+		/** Sum of all block times, in seconds. */
+		double GetTotalSeconds() const;
+
+	private:
+		FMixerCycleHistogram Histogram;
+	};
+
+	/**
+	 * Allocator that counts the allocations made through GMalloc and forwards everything to the allocator it replaced.
+	 *
+	 * Meant for benchmark processes: Install swaps GMalloc while other threads may be allocating,
+	 * which is harmless for forwarding but not something to do in a shipping game. Blocks allocated
+	 * before installation are freed correctly because every call is forwarded.
+	 */
+	class FMallocCountingProxy : public FMalloc
+	{
+	public:
+		explicit FMallocCountingProxy(FMalloc* InInnerMalloc);
+
+		/** Replaces GMalloc with a counting proxy and returns it. Reinstalls InProxy, with its count cleared, if given. */
+		static FMallocCountingProxy* Install(FMallocCountingProxy* InProxy = nullptr);
+
+		/** Restores the allocator the proxy replaced. The proxy stays readable afterwards, and can be installed again. */
+		static void Uninstall(FMallocCountingProxy* InProxy);
+
+		/** Frees an uninstalled proxy. Only once no other thread can still be inside one of its calls. */
+		static void Destroy(FMallocCountingProxy* InProxy);
+
+		/** Allocations and reallocations counted so far, on all threads. */
+		uint64 GetNumAllocations() const { return NumAllocations.load(std::memory_order_relaxed); }
+
+		//~ Begin FMalloc
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment = DEFAULT_ALIGNMENT) override;
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment = DEFAULT_ALIGNMENT) override;
+		virtual void Free(void* Original) override;
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return InnerMalloc->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return InnerMalloc->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { InnerMalloc->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { InnerMalloc->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { InnerMalloc->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual bool IsInternallyThreadSafe() const override { return InnerMalloc->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return InnerMalloc->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return TEXT("AudioMixerCountingProxy"); }
+		//~ End FMalloc
+
+	private:
+		FMalloc* InnerMalloc;
+		std::atomic<uint64> NumAllocations;
+	};
+}
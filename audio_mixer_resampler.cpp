@@ -0,0 +1,170 @@
+#include "audio_mixer_resampler.h"
+
+namespace Audio
+{
+	namespace PolyphaseResampler
+	{
+		static constexpr int32 HalfTaps = FMixerPolyphaseResampler::NumTaps / 2;
+
+		/** History lanes start on 64 byte boundaries. */
+		static constexpr int32 LaneAlignment = 16;
+
+		/** Passband edge as a fraction of the lower Nyquist frequency. The rest is the filter's transition band. */
+		static const float CutoffScale = 0.9f;
+
+		/** Returns sin(pi x) / (pi x). */
+		static float Sinc(float X)
+		{
+			if (FMath::Abs(X) < SMALL_NUMBER)
+			{
+				return 1.0f;
+			}
+			const float PiX = PI * X;
+			return FMath::Sin(PiX) / PiX;
+		}
+
+		/** 4-term Blackman-Harris window over [-HalfTaps, HalfTaps], around 92 dB of sidelobe rejection. */
+		static float Window(float Distance)
+		{
+			const float X = (Distance + HalfTaps) / (2.0f * HalfTaps);
+			if (X <= 0.0f || X >= 1.0f)
+			{
+				return 0.0f;
+			}
+			return 0.35875f - 0.48829f * FMath::Cos(2.0f * PI * X) + 0.14128f * FMath::Cos(4.0f * PI * X) - 0.01168f * FMath::Cos(6.0f * PI * X);
+		}
+	}
+
+	FMixerPolyphaseResampler::FMixerPolyphaseResampler()
+		: NumChannels(0)
+		, InputSampleRate(0)
+		, OutputSampleRate(0)
+		, MaxInputFrames(0)
+		, LaneStride(0)
+		, NumBufferedFrames(0)
+		, Position(0.0)
+		, NominalStep(1.0)
+		, Step(1.0)
+	{
+	}
+
+	void FMixerPolyphaseResampler::Init(int32 InNumChannels, int32 InInputSampleRate, int32 InOutputSampleRate, int32 InMaxInputFrames)
+	{
+		check(InNumChannels > 0 && InInputSampleRate > 0 && InOutputSampleRate > 0 && InMaxInputFrames > 0);
+
+		NumChannels = InNumChannels;
+		InputSampleRate = InInputSampleRate;
+		OutputSampleRate = InOutputSampleRate;
+		MaxInputFrames = InMaxInputFrames;
+		NominalStep = (double)InInputSampleRate / InOutputSampleRate;
+		Step = NominalStep;
+
+		// Between calls the lanes hold at most NumTaps - 1 frames of history, which new input is appended to.
+		LaneStride = Align(NumTaps - 1 + InMaxInputFrames, PolyphaseResampler::LaneAlignment);
+		Lanes.SetNumZeroed(LaneStride * InNumChannels);
+
+		DesignFilterBank();
+		Reset();
+	}
+
+	void FMixerPolyphaseResampler::Reset()
+	{
+		// Start on a half window of silence, so the first output frame is centered on the first input frame.
+		FMemory::Memzero(Lanes.GetData(), Lanes.Num() * sizeof(float));
+		NumBufferedFrames = PolyphaseResampler::HalfTaps - 1;
+		Position = PolyphaseResampler::HalfTaps - 1;
+	}
+
+	void FMixerPolyphaseResampler::SetRatioCorrection(double InCorrection)
+	{
+		Step = NominalStep * (1.0 + FMath::Clamp(InCorrection, -MaxRatioCorrection, MaxRatioCorrection));
+	}
+
+	int32 FMixerPolyphaseResampler::GetMaxOutputFrames(int32 InNumInputFrames) const
+	{
+		const double MinStep = NominalStep * (1.0 - MaxRatioCorrection);
+		// The history left by the previous call can complete at most one more frame's worth of input.
+		return (int32)((InNumInputFrames + 1) / MinStep) + 2;
+	}
+
+	int32 FMixerPolyphaseResampler::Process(const FMixerKernels& InKernels, const float* InBuffer, int32 InNumInputFrames, float* OutBuffer)
+	{
+		check(InNumInputFrames <= MaxInputFrames);
+
+		InKernels.Deinterleave(InBuffer, Lanes.GetData() + NumBufferedFrames, LaneStride, InNumInputFrames, NumChannels);
+		NumBufferedFrames += InNumInputFrames;
+
+		int32 NumOutputFrames = 0;
+		for (;;)
+		{
+			// The window of an output frame covers NumTaps input frames centered on its position.
+			const int32 Index = (int32)Position;
+			const int32 FirstFrame = Index - PolyphaseResampler::HalfTaps + 1;
+			if (FirstFrame + NumTaps > NumBufferedFrames)
+			{
+				break;
+			}
+
+			const double Phase = (Position - Index) * NumPhases;
+			const int32 PhaseIndex = (int32)Phase;
+			const float PhaseFraction = (float)(Phase - PhaseIndex);
+			const float* Row = Coefficients.GetData() + PhaseIndex * NumTaps;
+
+			float* OutFrame = OutBuffer + NumOutputFrames * NumChannels;
+			for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+			{
+				const float* Window = Lanes.GetData() + Channel * LaneStride + FirstFrame;
+				const float Lower = InKernels.DotProduct(Window, Row, NumTaps);
+				const float Upper = InKernels.DotProduct(Window, Row + NumTaps, NumTaps);
+				OutFrame[Channel] = Lower + (Upper - Lower) * PhaseFraction;
+			}
+
+			++NumOutputFrames;
+			Position += Step;
+		}
+
+		// Drop the frames that no later output frame reaches.
+		const int32 NumConsumedFrames = FMath::Min((int32)Position - PolyphaseResampler::HalfTaps + 1, NumBufferedFrames);
+		if (NumConsumedFrames > 0)
+		{
+			const int32 NumRemainingFrames = NumBufferedFrames - NumConsumedFrames;
+			for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+			{
+				float* Lane = Lanes.GetData() + Channel * LaneStride;
+				FMemory::Memmove(Lane, Lane + NumConsumedFrames, NumRemainingFrames * sizeof(float));
+			}
+			NumBufferedFrames = NumRemainingFrames;
+			Position -= NumConsumedFrames;
+		}
+
+		return NumOutputFrames;
+	}
+
+	void FMixerPolyphaseResampler::DesignFilterBank()
+	{
+		// Downsampling moves the cutoff below the output Nyquist frequency, so nothing above it aliases.
+		const float Cutoff = PolyphaseResampler::CutoffScale * FMath::Min(1.0f, (float)OutputSampleRate / InputSampleRate);
+
+		Coefficients.SetNumUninitialized((NumPhases + 1) * NumTaps);
+		for (int32 PhaseIndex = 0; PhaseIndex <= NumPhases; ++PhaseIndex)
+		{
+			float* Row = Coefficients.GetData() + PhaseIndex * NumTaps;
+
+			// Tap t weighs input frame FirstFrame + t, which lies Distance frames before the output position.
+			double Sum = 0.0;
+			for (int32 Tap = 0; Tap < NumTaps; ++Tap)
+			{
+				const float Distance = (float)PhaseIndex / NumPhases + PolyphaseResampler::HalfTaps - 1 - Tap;
+				Row[Tap] = Cutoff * PolyphaseResampler::Sinc(Cutoff * Distance) * PolyphaseResampler::Window(Distance);
+				Sum += Row[Tap];
+			}
+
+			// Unity gain at DC for every phase, so the interpolation between phases doesn't ripple.
+			const float Normalization = (float)(1.0 / Sum);
+			for (int32 Tap = 0; Tap < NumTaps; ++Tap)
+			{
+				Row[Tap] *= Normalization;
+			}
+		}
+	}
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "audio_mixer_kernels.h"
+
+namespace Audio
+{
+	/**
+	 * Streaming sample rate converter for interleaved audio, built on a windowed-sinc polyphase filter bank.
+	 *
+	 * Each output frame is filtered with the two phases of the bank that bracket its fractional input
+	 * position, and the two results are interpolated, so any ratio works and the ratio can be nudged
+	 * between blocks (see SetRatioCorrection) to absorb clock drift without a discontinuity. The filter
+	 * taps run through FMixerKernels::DotProduct over per-channel history lanes, so the inner loop is
+	 * the SIMD dot product and every instruction set produces the same output.
+	 *
+	 * Everything is allocated in Init. Process never allocates and may be called with any number of
+	 * frames up to the maximum given to Init; frames that can't produce output yet are kept as history.
+	 */
+	class FMixerPolyphaseResampler
+	{
+	public:
+		/** Filter taps per phase. A multiple of the eight DotProduct lanes. */
+		static constexpr int32 NumTaps = 32;
+
+		/** Phases in the filter bank; positions in between are interpolated. */
+		static constexpr int32 NumPhases = 128;
+
+		/** Largest relative adjustment SetRatioCorrection accepts. */
+		static constexpr double MaxRatioCorrection = 0.01;
+
+		FMixerPolyphaseResampler();
+
+		/**
+		 * Designs the filter bank for the given rates, allocates the history and clears it.
+		 *
+		 * @param InNumChannels Channels of the interleaved audio.
+		 * @param InInputSampleRate Rate of the audio given to Process.
+		 * @param InOutputSampleRate Rate of the audio Process writes.
+		 * @param InMaxInputFrames Largest number of frames passed to one Process call.
+		 */
+		void Init(int32 InNumChannels, int32 InInputSampleRate, int32 InOutputSampleRate, int32 InMaxInputFrames);
+
+		/** Clears the history, as if no audio had been processed. Keeps the ratio correction. */
+		void Reset();
+
+		/**
+		 * Adjusts the conversion ratio by a relative amount, clamped to +/-MaxRatioCorrection. Positive values
+		 * consume input faster, so fewer frames come out; negative values produce more. Takes effect on the
+		 * next output frame.
+		 */
+		void SetRatioCorrection(double InCorrection);
+
+		/** Largest number of frames one Process call with InNumInputFrames frames can write, at any ratio correction. */
+		int32 GetMaxOutputFrames(int32 InNumInputFrames) const;
+
+		/**
+		 * Converts a block of interleaved audio.
+		 *
+		 * @param InKernels The kernels to filter with.
+		 * @param InBuffer InNumInputFrames interleaved input frames.
+		 * @param InNumInputFrames At most the InMaxInputFrames given to Init.
+		 * @param OutBuffer Receives the output frames; must hold GetMaxOutputFrames(InNumInputFrames) frames.
+		 * @return The number of frames written.
+		 */
+		int32 Process(const FMixerKernels& InKernels, const float* InBuffer, int32 InNumInputFrames, float* OutBuffer);
+
+		int32 GetNumChannels() const { return NumChannels; }
+		int32 GetInputSampleRate() const { return InputSampleRate; }
+		int32 GetOutputSampleRate() const { return OutputSampleRate; }
+
+	private:
+		/** Fills the filter bank with NumPhases + 1 rows of NumTaps coefficients, each normalized to unity gain. */
+		void DesignFilterBank();
+
+		/** Filter bank, row-major by phase. Row NumPhases is the last phase shifted a whole input frame, so every phase has a successor. */
+		TArray<float> Coefficients;
+
+		/** One history lane of LaneStride floats per channel. */
+		TArray<float> Lanes;
+
+		int32 NumChannels;
+		int32 InputSampleRate;
+		int32 OutputSampleRate;
+		int32 MaxInputFrames;
+		int32 LaneStride;
+
+		/** Frames held in each lane. */
+		int32 NumBufferedFrames;
+
+		/** Input position of the next output frame, in frames from the start of the lanes. */
+		double Position;
+
+		/** Input frames per output frame at the nominal rates. */
+		double NominalStep;
+
+		/** Input frames per output frame, including the ratio correction. */
+		double Step;
+	};
+}
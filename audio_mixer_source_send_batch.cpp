@@ -0,0 +1,29 @@
+#include "audio_mixer_source_send_batch.h"
+
+static int32 SourceSendTileSizeCVar = 4096;
+FAutoConsoleVariableRef CVarSourceSendTileSize(
+	TEXT("au.Submix.SourceSendTileSize"),
+	SourceSendTileSizeCVar,
+	TEXT("Samples per tile when summing source voice sends into a submix, rounded down to a multiple of 16.\n")
+	TEXT("A tile of the submix buffer should stay in L1 next to the voice data streaming through it (default: 4096, 16 KB)."),
+	ECVF_Default);
+
+namespace Audio
+{
+	void FMixerSourceSendBatch::MixIn(const FMixerKernels& InKernels, float* BufferToSumTo, int32 NumSamples) const
+	{
+		if (NumSends == 0)
+		{
+			return;
+		}
+
+		// Whole vectors per tile, so only the last tile of the block has a scalar tail.
+		const int32 TileSize = FMath::Max(SourceSendTileSizeCVar & ~15, 16);
+
+		for (int32 TileStart = 0; TileStart < NumSamples; TileStart += TileSize)
+		{
+			const int32 TileLength = FMath::Min(TileSize, NumSamples - TileStart);
+			InKernels.GainAndMixInMultiple(Buffers, Gains, NumSends, TileStart, BufferToSumTo + TileStart, TileLength);
+		}
+	}
+}
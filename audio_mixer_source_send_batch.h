@@ -0,0 +1,58 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "audio_mixer_frame_arena.h"
+#include "audio_mixer_kernels.h"
+
+namespace Audio
+{
+	/**
+	 * Sums the sends of all source voices feeding a submix in one pass over the submix buffer.
+	 *
+	 * Mixing voice by voice loads and stores every sample of the submix buffer once per voice. A
+	 * batch gathers each voice's output buffer and send level first, then walks the submix buffer in
+	 * tiles small enough to stay in L1 and sums all voices into a tile before moving to the next,
+	 * with the GainAndMixInMultiple kernel adding groups of voices in registers. Sends are added in
+	 * the order they were gathered, so the result is the same as mixing the voices one by one.
+	 */
+	class FMixerSourceSendBatch
+	{
+	public:
+		FMixerSourceSendBatch()
+			: Buffers(nullptr)
+			, Gains(nullptr)
+			, NumSends(0)
+			, MaxSends(0)
+		{
+		}
+
+		/** Takes room for up to InMaxSends sends from the arena, valid until the enclosing arena scope ends. */
+		void Init(FMixerFrameArena& InArena, int32 InMaxSends)
+		{
+			Buffers = InArena.Allocate<const float*>(InMaxSends);
+			Gains = InArena.Allocate<float>(InMaxSends);
+			NumSends = 0;
+			MaxSends = InMaxSends;
+		}
+
+		/** Adds a send. The buffer must hold at least as many samples as are later mixed. */
+		void Add(const float* InBuffer, float InGain)
+		{
+			check(NumSends < MaxSends);
+			Buffers[NumSends] = InBuffer;
+			Gains[NumSends] = InGain;
+			++NumSends;
+		}
+
+		int32 Num() const { return NumSends; }
+
+		/** BufferToSumTo[i] += Buffer[i] * Gain for every send. */
+		void MixIn(const FMixerKernels& InKernels, float* BufferToSumTo, int32 NumSamples) const;
+
+	private:
+		const float** Buffers;
+		float* Gains;
+		int32 NumSends;
+		int32 MaxSends;
+	};
+}
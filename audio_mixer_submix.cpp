@@ -1,3 +1,42 @@
+static int32 SubmixSkipSilenceCVar = 1;
+FAutoConsoleVariableRef CVarSubmixSkipSilence(
+	TEXT("au.Submix.SkipSilence"),
+	SubmixSkipSilenceCVar,
+	TEXT("Skips effect chains, gain stages and mixing into the parent for submixes whose audio is silent.\n")
+	TEXT("0: Always process, 1: Skip silent work (default)."),
+	ECVF_Default);
+
+static float SubmixSilenceThresholdCVar = 0.00001f;
+FAutoConsoleVariableRef CVarSubmixSilenceThreshold(
+	TEXT("au.Submix.SilenceThreshold"),
+	SubmixSilenceThresholdCVar,
+	TEXT("Peak level below which an effect tail on a silent input counts as decayed (default: 0.00001, -100 dB)."),
+	ECVF_Default);
+
+static float SubmixEffectTailHoldMsCVar = 2000.0f;
+FAutoConsoleVariableRef CVarSubmixEffectTailHoldMs(
+	TEXT("au.Submix.EffectTailHoldMs"),
+	SubmixEffectTailHoldMsCVar,
+	TEXT("How long effect output on a silent input must stay below au.Submix.SilenceThreshold before the effect chain is skipped, in milliseconds (default: 2000).\n")
+	TEXT("Covers gaps in effect tails, e.g. a delay's echoes or a reverb's pre-delay, so they aren't cut off and don't play back stale when input returns."),
+	ECVF_Default);
+
+static int32 SubmixBatchedSourceMixingCVar = 1;
+FAutoConsoleVariableRef CVarSubmixBatchedSourceMixing(
+	TEXT("au.Submix.BatchedSourceMixing"),
+	SubmixBatchedSourceMixingCVar,
+	TEXT("Sums all source voice sends of a submix tile by tile, so the submix buffer stays in cache across voices.\n")
+	TEXT("0: Mix one voice at a time over the whole buffer, 1: Batch the voices (default). Both give identical results."),
+	ECVF_Default);
+
+static int32 SubmixTimingStatsCVar = 1;
+FAutoConsoleVariableRef CVarSubmixTimingStats(
+	TEXT("au.Submix.TimingStats"),
+	SubmixTimingStatsCVar,
+	TEXT("Records per-submix and per-effect render times and lock waits into the submix timing stats.\n")
+	TEXT("0: Off, 1: On (default). Submixes created or given new effects while it is off don't get entries."),
+	ECVF_Default);
+
 	void FMixerSubmix::ProcessAudio(AlignedFloatBuffer& OutAudioBuffer)
 	{
 		AUDIO_MIXER_CHECK_AUDIO_PLAT_THREAD(MixerDevice);
@@ -5,297 +44,574 @@
 		// If this is a Soundfield Submix, process our soundfield and decode it to a OutAudioBuffer.
 		if (IsSoundfieldSubmix())
 		{
-			FScopeLock ScopeLock(&SoundfieldStreams.StreamsLock);
+			ProcessSoundfieldAudio(OutAudioBuffer);
+			return;
+		}
+
+		// Pump pending command queues. For Soundfield Submixes this occurs in ProcessAudio(ISoundfieldAudioPacket&).
+		PumpCommandQueue();
+		PumpParamCommands();
+
+		if (!BeginProcessAudio(OutAudioBuffer.Num()))
+		{
+			return;
+		}
+
+		// Silent children skip mixing into InputBuffer, so it stays silent only if all of them are.
+		bool bChildrenAreSilent = true;
+
+		// Mix all submix audio into this submix's input scratch buffer
+		{
+			CSV_SCOPED_TIMING_STAT(Audio, SubmixChildren);
 
-			// Initialize or clear the mixed down audio packet.
-			if (!SoundfieldStreams.MixedDownAudio.IsValid())
+			// First loop this submix's child submixes mixing in their output into this submix's dry/wet buffers.
+			TArray<uint32> ToRemove;
+			for (auto& ChildSubmixEntry : ChildSubmixes)
 			{
-				SoundfieldStreams.MixedDownAudio = SoundfieldStreams.Factory->CreateEmptyPacket();
+				TSharedPtr<Audio::FMixerSubmix, ESPMode::ThreadSafe> ChildSubmix = ChildSubmixEntry.Value.SubmixPtr.Pin();
+				if (ChildSubmix.IsValid())
+				{
+					ChildSubmix->ProcessAudio(InputBuffer);
+					bChildrenAreSilent &= ChildSubmix->bIsOutputSilent;
+				}
+				else
+				{
+					ToRemove.Add(ChildSubmixEntry.Key);
+				}
 			}
-			else
+
+			for (uint32 Key : ToRemove)
 			{
-				SoundfieldStreams.MixedDownAudio->Reset();
+				ChildSubmixes.Remove(Key);
 			}
+		}
+
+		FinishProcessAudio(OutAudioBuffer, bChildrenAreSilent);
+	}
+
+	bool FMixerSubmix::ProcessAudioFromChildOutputs(TArrayView<const AlignedFloatBuffer* const> InChildOutputs, AlignedFloatBuffer& OutAudioBuffer)
+	{
+		// Called from the compiled submix graph, possibly on render pool workers on behalf of the audio render thread.
+		if (IsSoundfieldSubmix())
+		{
+			ProcessSoundfieldAudio(OutAudioBuffer);
+			return false;
+		}
+
+		// Commands that add, remove or reparent children mark the graph dirty themselves (see SubmixTopologyCommand).
+		PumpCommandQueue();
+		PumpParamCommands();
 
-			check(SoundfieldStreams.MixedDownAudio.IsValid());
+		if (!BeginProcessAudio(OutAudioBuffer.Num()))
+		{
+			return true;
+		}
 
-			ProcessAudio(*SoundfieldStreams.MixedDownAudio);
+		float* BufferPtr = InputBuffer.GetData();
 
-			if (!SoundfieldStreams.ParentDecoder.IsValid())
+		{
+			CSV_SCOPED_TIMING_STAT(Audio, SubmixChildren);
+
+			// Sum the children in the order the serial recursion would have mixed them in, so the result is identical.
+			const FMixerKernels& Kernels = GetMixerKernels();
+			for (const AlignedFloatBuffer* ChildOutput : InChildOutputs)
 			{
-				return;
+				Kernels.MixIn(ChildOutput->GetData(), BufferPtr, NumSamples);
 			}
+		}
 
-			//Decode soundfield to interleaved float audio.
-			FSoundfieldDecoderInputData DecoderInput =
+		// The graph only passes the children that were not silent.
+		return FinishProcessAudio(OutAudioBuffer, InChildOutputs.Num() == 0);
+	}
+
+	void FMixerSubmix::GatherChildSubmixes(TArray<FMixerSubmixPtr>& OutChildSubmixes)
+	{
+		TArray<uint32, TInlineAllocator<4>> ToRemove;
+		for (auto& ChildSubmixEntry : ChildSubmixes)
+		{
+			FMixerSubmixPtr ChildSubmix = ChildSubmixEntry.Value.SubmixPtr.Pin();
+			if (ChildSubmix.IsValid())
 			{
-				*SoundfieldStreams.MixedDownAudio, /* SoundfieldBuffer */
-				SoundfieldStreams.CachedPositionalData, /* PositionalData */
-				MixerDevice ? MixerDevice->GetNumOutputFrames() : 0, /* NumFrames */
-				MixerDevice ? MixerDevice->GetSampleRate() : 0.0f /* SampleRate */
-			};
+				OutChildSubmixes.Add(MoveTemp(ChildSubmix));
+			}
+			else
+			{
+				ToRemove.Add(ChildSubmixEntry.Key);
+			}
+		}
 
-			FSoundfieldDecoderOutputData DecoderOutput = { OutAudioBuffer };
+		for (uint32 Key : ToRemove)
+		{
+			ChildSubmixes.Remove(Key);
+		}
+	}
 
-			SoundfieldStreams.ParentDecoder->DecodeAndMixIn(DecoderInput, DecoderOutput);
-			return;
+	void FMixerSubmix::SubmixTopologyCommand(TFunction<void()> InCommand)
+	{
+		// Has the graph recompile before the next block. Commands that don't change the tree skip this, so they don't cost a recompile.
+		SubmixCommand([this, Command = MoveTemp(InCommand)]()
+		{
+			Command();
+			MixerDevice->MarkSubmixGraphDirty();
+		});
+	}
+
+	void FMixerSubmix::ProcessSoundfieldAudio(AlignedFloatBuffer& OutAudioBuffer)
+	{
+		// Soundfield packets are opaque, so their silence can't be tracked.
+		bIsOutputSilent = false;
+
+		FMixerStatsEntry* StatsEntry = GetTimingStatsEntry();
+		FMixerTimedScopeLock ScopeLock(&SoundfieldStreams.StreamsLock, StatsEntry ? &StatsEntry->LockWaits : nullptr);
+
+		// Initialize or clear the mixed down audio packet.
+		if (!SoundfieldStreams.MixedDownAudio.IsValid())
+		{
+			SoundfieldStreams.MixedDownAudio = SoundfieldStreams.Factory->CreateEmptyPacket();
 		}
 		else
 		{
-			// Pump pending command queues. For Soundfield Submixes this occurs in ProcessAudio(ISoundfieldAudioPacket&).
-			PumpCommandQueue();
+			SoundfieldStreams.MixedDownAudio->Reset();
+		}
+
+		check(SoundfieldStreams.MixedDownAudio.IsValid());
+
+		ProcessAudio(*SoundfieldStreams.MixedDownAudio);
+
+		if (!SoundfieldStreams.ParentDecoder.IsValid())
+		{
+			return;
 		}
 
+		//Decode soundfield to interleaved float audio.
+		FSoundfieldDecoderInputData DecoderInput =
+		{
+			*SoundfieldStreams.MixedDownAudio, /* SoundfieldBuffer */
+			SoundfieldStreams.CachedPositionalData, /* PositionalData */
+			MixerDevice ? MixerDevice->GetNumOutputFrames() : 0, /* NumFrames */
+			MixerDevice ? MixerDevice->GetSampleRate() : 0.0f /* SampleRate */
+		};
+
+		FSoundfieldDecoderOutputData DecoderOutput = { OutAudioBuffer };
+
+		SoundfieldStreams.ParentDecoder->DecodeAndMixIn(DecoderInput, DecoderOutput);
+	}
+
+	void FMixerSubmix::ProcessAudioAndQueueForEndpoint()
+	{
+		AUDIO_MIXER_CHECK_AUDIO_PLAT_THREAD(MixerDevice);
+
+		// Soundfield endpoints take encoded packets, which the worker doesn't carry.
+		if (IsSoundfieldSubmix() || !EndpointWorker.IsValid())
+		{
+			ProcessAudioAndSendToEndpoint();
+			return;
+		}
+
+		// Render on the audio render thread as before; only the delivery to the endpoint moves to its worker.
+		const int32 NumFrames = MixerDevice->GetNumOutputFrames();
+		const int32 NumDeviceChannels = MixerDevice->GetNumDeviceChannels();
+		EndpointBuffer.Reset(NumFrames * NumDeviceChannels);
+		EndpointBuffer.AddZeroed(NumFrames * NumDeviceChannels);
+
+		ProcessAudio(EndpointBuffer);
+
+		// Never waits. A worker a whole latency budget behind loses this block instead.
+		EndpointWorker->QueueBlock(EndpointBuffer.GetData(), NumFrames, NumDeviceChannels);
+	}
+
+	bool FMixerSubmix::BeginProcessAudio(int32 InNumOutputSamples)
+	{
 		// Device format may change channels if device is hot swapped
 		NumChannels = MixerDevice->GetNumDeviceChannels();
 
 		// If we hit this, it means that platform info gave us an invalid NumChannel count.
 		if (!ensure(NumChannels != 0 && NumChannels <= AUDIO_MIXER_MAX_OUTPUT_CHANNELS))
 		{
-			return;
+			bIsOutputSilent = true;
+			return false;
 		}
 
-		const int32 NumOutputFrames = OutAudioBuffer.Num() / NumChannels;
+		const int32 NumOutputFrames = InNumOutputSamples / NumChannels;
 		NumSamples = NumChannels * NumOutputFrames;
 
- 		InputBuffer.Reset(NumSamples);
- 		InputBuffer.AddZeroed(NumSamples);
+		// A silent block leaves InputBuffer zeroed, so it only needs clearing again after something wrote to it.
+		if (!bInputBufferIsCleared || InputBuffer.Num() != NumSamples)
+		{
+ 			InputBuffer.Reset(NumSamples);
+ 			InputBuffer.AddZeroed(NumSamples);
+		}
+		bInputBufferIsCleared = false;
 
+		return true;
+	}
+
+	bool FMixerSubmix::FinishProcessAudio(AlignedFloatBuffer& OutAudioBuffer, bool bInputIsSilent)
+	{
+		// Children time themselves, so this records the submix's own work.
+		FMixerStatsEntry* StatsEntry = GetTimingStatsEntry();
+		FMixerScopeCycleCounter SubmixTimer(StatsEntry ? &StatsEntry->Histogram : nullptr);
+		FMixerLockWaitCounters* LockWaits = StatsEntry ? &StatsEntry->LockWaits : nullptr;
+
+		// Scratch buffers that only live for this block come from the thread's frame arena and are handed back when this submix is done.
+		FMixerFrameArena& FrameArena = FMixerFrameArena::Get();
+		FMixerFrameArena::FScope FrameArenaScope(FrameArena);
+
+		const FMixerKernels& Kernels = GetMixerKernels();
+		const FMixerChannelKernels& ChannelKernels = GetMixerChannelKernels(NumChannels);
+		const int32 NumOutputFrames = NumSamples / NumChannels;
 		float* BufferPtr = InputBuffer.GetData();
 
-		// Mix all submix audio into this submix's input scratch buffer
+		bool bWroteInputBuffer = false;
+		int32 NumMixedVoices = 0;
+
 		{
-			CSV_SCOPED_TIMING_STAT(Audio, SubmixChildren);
+			CSV_SCOPED_TIMING_STAT(Audio, SubmixSource);
 
-			// First loop this submix's child submixes mixing in their output into this submix's dry/wet buffers.
-			TArray<uint32> ToRemove;
-			for (auto& ChildSubmixEntry : ChildSubmixes)
+			// Virtual voices rendered nothing this block, so their buffers hold stale audio.
+			const FMixerVoiceAudibility& VoiceAudibility = MixerDevice->GetVoiceAudibility();
+
+			// Voices going virtual or coming back ramp their send over the first frames of the block, and a voice
+			// that faded out stays silent for the rest of it.
+			const int32 NumFadeSamples = FMixerVoiceAudibility::GetNumFadeFrames(NumOutputFrames, MixerDevice->GetSampleRate()) * NumChannels;
+			auto FadeAndMixInVoice = [&Kernels, BufferPtr, NumSamples, NumFadeSamples](const float* SendBuffer, float SendLevel, EMixerVoiceFade Fade)
 			{
-				TSharedPtr<Audio::FMixerSubmix, ESPMode::ThreadSafe> ChildSubmix = ChildSubmixEntry.Value.SubmixPtr.Pin();
-				if (ChildSubmix.IsValid())
+				const float EndGain = Fade == EMixerVoiceFade::In ? SendLevel : 0.0f;
+				Kernels.FadeAndMixIn(SendBuffer, BufferPtr, NumFadeSamples, SendLevel - EndGain, EndGain);
+				if (EndGain > 0.0f && NumFadeSamples < NumSamples)
 				{
-					ChildSubmix->ProcessAudio(InputBuffer);
+					Kernels.GainAndMixIn(SendBuffer + NumFadeSamples, BufferPtr + NumFadeSamples, NumSamples - NumFadeSamples, EndGain);
 				}
-				else
+			};
+
+			if (SubmixBatchedSourceMixingCVar)
+			{
+				// Gather the audible sends first, then sum them all into one cache-sized tile of the input buffer at a time.
+				FMixerSourceSendBatch SendBatch;
+				SendBatch.Init(FrameArena, MixerSourceVoices.Num());
+				for (const auto& MixerSourceVoiceIter : MixerSourceVoices)
 				{
-					ToRemove.Add(ChildSubmixEntry.Key);
+					const float SendLevel = MixerSourceVoiceIter.Value.SendLevel;
+					if (SendLevel > 0.0f && !VoiceAudibility.IsVirtual(MixerSourceVoiceIter.Key->GetSourceId()))
+					{
+						if (const float* SendBuffer = MixerSourceVoiceIter.Key->GetSubmixSendBuffer(NumChannels, MixerSourceVoiceIter.Value.SubmixSendStage))
+						{
+							// The few fading voices ramp on their own rather than holding up the batch.
+							const EMixerVoiceFade Fade = VoiceAudibility.GetFade(MixerSourceVoiceIter.Key->GetSourceId());
+							if (Fade == EMixerVoiceFade::None)
+							{
+								SendBatch.Add(SendBuffer, SendLevel);
+							}
+							else
+							{
+								FadeAndMixInVoice(SendBuffer, SendLevel, Fade);
+								++NumMixedVoices;
+							}
+						}
+					}
 				}
+				SendBatch.MixIn(Kernels, BufferPtr, NumSamples);
+				NumMixedVoices += SendBatch.Num();
 			}
-
-			for (uint32 Key : ToRemove)
+			else
 			{
-				ChildSubmixes.Remove(Key);
-			}
-		}
-
-		{
-			CSV_SCOPED_TIMING_STAT(Audio, SubmixSource);
+				// Loop through this submix's sound sources
+				for (const auto& MixerSourceVoiceIter : MixerSourceVoices)
+				{
+					const FMixerSourceVoice* MixerSourceVoice = MixerSourceVoiceIter.Key;
+					if (VoiceAudibility.IsVirtual(MixerSourceVoice->GetSourceId()))
+					{
+						continue;
+					}
 
-			// Loop through this submix's sound sources
-			for (const auto& MixerSourceVoiceIter : MixerSourceVoices)
-			{
-				const FMixerSourceVoice* MixerSourceVoice = MixerSourceVoiceIter.Key;
-				const float SendLevel = MixerSourceVoiceIter.Value.SendLevel;
-				const EMixerSourceSubmixSendStage SubmixSendStage = MixerSourceVoiceIter.Value.SubmixSendStage;
+					const float SendLevel = MixerSourceVoiceIter.Value.SendLevel;
+					const EMixerSourceSubmixSendStage SubmixSendStage = MixerSourceVoiceIter.Value.SubmixSendStage;
 
-				MixerSourceVoice->MixOutputBuffers(NumChannels, SendLevel, SubmixSendStage, InputBuffer);
+					const EMixerVoiceFade Fade = VoiceAudibility.GetFade(MixerSourceVoice->GetSourceId());
+					if (Fade == EMixerVoiceFade::None)
+					{
+						MixerSourceVoice->MixOutputBuffers(NumChannels, SendLevel, SubmixSendStage, InputBuffer);
+					}
+					else if (const float* SendBuffer = MixerSourceVoice->GetSubmixSendBuffer(NumChannels, SubmixSendStage))
+					{
+						FadeAndMixInVoice(SendBuffer, SendLevel, Fade);
+					}
+					++NumMixedVoices;
+				}
 			}
 		}
 
-		DryChannelBuffer.Reset();
+		// Without voices mixed in, the input is exactly the (silent) children.
+		bool bIsSilent = SubmixSkipSilenceCVar != 0 && bInputIsSilent && NumMixedVoices == 0;
+
+		float* DryChannelBuffer = nullptr;
 
 		// Check if we need to allocate a dry buffer. This is stored here before effects processing. We mix in with wet buffer after effects processing.
 		if (!FMath::IsNearlyEqual(CurrentDryLevel, TargetDryLevel) || !FMath::IsNearlyZero(CurrentDryLevel))
 		{
-			DryChannelBuffer.Append(InputBuffer);
+			if (bIsSilent)
+			{
+				// The dry copy of a silent input would add nothing, so skip both the copy and its gain.
+				CurrentDryLevel = TargetDryLevel;
+				FMixerSubmixSilenceCounters::Increment(SilenceCounters.NumGainStagesSkipped);
+			}
+			else
+			{
+				DryChannelBuffer = FrameArena.Allocate<float>(NumSamples);
+				FMemory::Memcpy(DryChannelBuffer, BufferPtr, sizeof(float) * NumSamples);
+			}
 		}
 
+		// Under overload, low priority effect chains are bypassed and analysis and listeners are skipped.
+		const FMixerOverloadGovernor& OverloadGovernor = MixerDevice->GetOverloadGovernor();
+		const bool bBypassEffects = BypassAllSubmixEffectsCVar || (EffectPriority == EMixerSubmixEffectPriority::Low && OverloadGovernor.IsAtLeast(EMixerOverloadLevel::BypassLowPriorityEffects));
+		const bool bSkipAnalysis = OverloadGovernor.IsAtLeast(EMixerOverloadLevel::SkipAnalysisAndListeners);
+
 		{
-			FScopeLock ScopeLock(&EffectChainMutationCriticalSection);
+			// Effect chain edits publish a new snapshot instead of locking, and retired snapshots are freed by the writer.
+			const FMixerEffectChainSnapshot* EffectChainSnapshot = EffectChainPublisher.Acquire();
+			const int32 NumEffectChains = EffectChainSnapshot ? EffectChainSnapshot->Chains.Num() : 0;
 
-			if (!BypassAllSubmixEffectsCVar && EffectChains.Num() > 0)
-			{		
-				CSV_SCOPED_TIMING_STAT(Audio, SubmixEffectProcessing);
+			// Effects can still ring out after their input goes silent, so they are only skipped once their output has decayed
+			// and stayed decayed for the tail hold.
+			const bool bSkipEffects = bIsSilent && bEffectTailIsSilent;
 
+			if (!bBypassEffects && NumEffectChains > 0)
+			{
 				float SampleRate = MixerDevice->GetSampleRate();
 				check(SampleRate > 0.0f);
 				float DeltaTimeSec = NumOutputFrames / SampleRate;
 
-				// Setup the input data buffer
-				FSoundEffectSubmixInputData InputData;
-				InputData.AudioClock = MixerDevice->GetAudioTime();
-
-				// Compute the number of frames of audio. This will be independent of if we downmix our wet buffer.
-				InputData.NumFrames = NumSamples / NumChannels;
-				InputData.NumChannels = NumChannels;
-				InputData.NumDeviceChannels = MixerDevice->GetNumDeviceChannels();
-				InputData.ListenerTransforms = MixerDevice->GetListenerTransforms();
-				InputData.AudioClock = MixerDevice->GetAudioClock();
-
-				SubmixChainMixBuffer.Reset(NumSamples);
-				SubmixChainMixBuffer.AddZeroed(NumSamples);
-				bool bProcessedAnEffect = false;
-
-				for (int32 EffectChainIndex = EffectChains.Num() - 1; EffectChainIndex >= 0; --EffectChainIndex)
+				// Applies a fade the snapshot asks for and retires chains that have faded out. Returns whether the chain still plays.
+				auto UpdateEffectChainFade = [this](const FSubmixEffectFadeInfo& FadeInfo)
 				{
-					FSubmixEffectFadeInfo& FadeInfo = EffectChains[EffectChainIndex];
+					FMixerEffectChainFade& Fade = *FadeInfo.Fade;
 
-					if (!FadeInfo.EffectChain.Num())
+					if (!FadeInfo.EffectChain.Num() || Fade.bIsFinished.load(std::memory_order_relaxed))
 					{
-						continue;
+						return false;
 					}
 
-					// If we're not the current chain and we've finished fading out, lets remove it from the effect chains
-					if (!FadeInfo.bIsCurrentChain && FadeInfo.FadeVolume.IsDone())
+					// Start a fade requested by the snapshot. The fade state carries over between snapshots, so it's only restarted when the target changes.
+					if (FadeInfo.FadeTargetVolume != Fade.AppliedTargetVolume)
+					{
+						Fade.FadeVolume.Set(FadeInfo.FadeTargetVolume, FadeInfo.FadeTimeSec);
+						Fade.AppliedTargetVolume = FadeInfo.FadeTargetVolume;
+					}
+
+					// If we're not the current chain and we've finished fading out, mark it so the next snapshot drops it
+					if (!FadeInfo.bIsCurrentChain && Fade.FadeVolume.IsDone())
 					{
 						// only remove effect chain if it's not the base effect chain
 						if (!FadeInfo.bIsBaseEffect)
 						{
-							EffectChains.RemoveAtSwap(EffectChainIndex, 1, true);
+							Fade.bIsFinished.store(true, std::memory_order_relaxed);
+							bHasFinishedEffectChains.store(true, std::memory_order_release);
 						}
-						continue;
+						return false;
 					}
 
-					// Prepare the scratch buffer for effect chain processing
-					EffectChainOutputBuffer.SetNumUninitialized(NumSamples);
-
-					bProcessedAnEffect |= GenerateEffectChainAudio(InputData, InputBuffer, FadeInfo.EffectChain, EffectChainOutputBuffer);
+					return true;
+				};
 
-					float StartFadeVolume = FadeInfo.FadeVolume.GetValue();
-					FadeInfo.FadeVolume.Update(DeltaTimeSec);
-					float EndFadeVolume = FadeInfo.FadeVolume.GetValue();
+				if (bSkipEffects)
+				{
+					FMixerSubmixSilenceCounters::Increment(SilenceCounters.NumEffectBlocksSkipped);
 
-					MixInBufferFast(EffectChainOutputBuffer, SubmixChainMixBuffer, StartFadeVolume, EndFadeVolume);
+					// Nothing renders, but fades keep time, so a chain swapped while silent is where it should be when input returns.
+					for (const FSubmixEffectFadeInfo& FadeInfo : EffectChainSnapshot->Chains)
+					{
+						if (UpdateEffectChainFade(FadeInfo))
+						{
+							FadeInfo.Fade->FadeVolume.Update(DeltaTimeSec);
+						}
+					}
+					CurrentWetLevel = TargetWetLevel;
 				}
-
-				// If we processed any effects, write over the old input buffer vs mixing into it. This is basically the "wet channel" audio in a submix.
-				if (bProcessedAnEffect)
+				else
 				{
-					FMemory::Memcpy((void*)BufferPtr, (void*)SubmixChainMixBuffer.GetData(), sizeof(float)* NumSamples);
-				}
+					CSV_SCOPED_TIMING_STAT(Audio, SubmixEffectProcessing);
 
-				// Apply the wet level here after processing effects. 
-				if (!FMath::IsNearlyEqual(TargetWetLevel, CurrentWetLevel) || !FMath::IsNearlyEqual(CurrentWetLevel, 1.0f))
-				{
-					if (FMath::IsNearlyEqual(TargetWetLevel, CurrentWetLevel))
+					// Setup the input data buffer
+					FSoundEffectSubmixInputData InputData;
+					InputData.AudioClock = MixerDevice->GetAudioTime();
+
+					// Compute the number of frames of audio. This will be independent of if we downmix our wet buffer.
+					InputData.NumFrames = NumSamples / NumChannels;
+					InputData.NumChannels = NumChannels;
+					InputData.NumDeviceChannels = MixerDevice->GetNumDeviceChannels();
+					InputData.ListenerTransforms = MixerDevice->GetListenerTransforms();
+					InputData.AudioClock = MixerDevice->GetAudioClock();
+
+					float* SubmixChainMixBuffer = FrameArena.Allocate<float>(NumSamples);
+					FMemory::Memzero(SubmixChainMixBuffer, sizeof(float) * NumSamples);
+					bool bProcessedAnEffect = false;
+
+					for (int32 EffectChainIndex = NumEffectChains - 1; EffectChainIndex >= 0; --EffectChainIndex)
+					{
+						const FSubmixEffectFadeInfo& FadeInfo = EffectChainSnapshot->Chains[EffectChainIndex];
+						if (!UpdateEffectChainFade(FadeInfo))
+						{
+							continue;
+						}
+						FMixerEffectChainFade& Fade = *FadeInfo.Fade;
+
+						// Prepare the scratch buffer for effect chain processing
+						EffectChainOutputBuffer.SetNumUninitialized(NumSamples);
+
+						bProcessedAnEffect |= GenerateEffectChainAudio(InputData, InputBuffer, FadeInfo.EffectChain, EffectChainOutputBuffer);
+
+						float StartFadeVolume = Fade.FadeVolume.GetValue();
+						Fade.FadeVolume.Update(DeltaTimeSec);
+						float EndFadeVolume = Fade.FadeVolume.GetValue();
+
+						if (StartFadeVolume == EndFadeVolume)
+						{
+							Kernels.GainAndMixIn(EffectChainOutputBuffer.GetData(), SubmixChainMixBuffer, NumSamples, EndFadeVolume);
+						}
+						else
+						{
+							Kernels.FadeAndMixIn(EffectChainOutputBuffer.GetData(), SubmixChainMixBuffer, NumSamples, StartFadeVolume, EndFadeVolume);
+						}
+					}
+
+					// If we processed any effects, write over the old input buffer vs mixing into it. This is basically the "wet channel" audio in a submix.
+					if (bProcessedAnEffect)
+					{
+						FMemory::Memcpy((void*)BufferPtr, (void*)SubmixChainMixBuffer, sizeof(float)* NumSamples);
+						bWroteInputBuffer = true;
+					}
+
+					// On a silent input, the block stays silent only if the effect tail has decayed below the threshold. The chain keeps
+					// running until the tail has stayed there for the hold, since a quiet block can be a gap between echoes.
+					if (bIsSilent)
 					{
-						MultiplyBufferByConstantInPlace(InputBuffer, TargetWetLevel);
+						const bool bTailIsBelowThreshold = !bProcessedAnEffect || Kernels.MaxAbs(BufferPtr, NumSamples) <= SubmixSilenceThresholdCVar;
+						NumSilentEffectTailFrames = bTailIsBelowThreshold ? NumSilentEffectTailFrames + NumOutputFrames : 0;
+
+						const int32 NumTailHoldFrames = FMath::CeilToInt(FMath::Max(SubmixEffectTailHoldMsCVar, 0.0f) * 0.001f * SampleRate);
+						bEffectTailIsSilent = !bProcessedAnEffect || NumSilentEffectTailFrames >= NumTailHoldFrames;
+						bIsSilent = bTailIsBelowThreshold;
 					}
 					else
 					{
-						FadeBufferFast(InputBuffer, CurrentWetLevel, TargetWetLevel);
-						CurrentWetLevel = TargetWetLevel;
+						NumSilentEffectTailFrames = 0;
+						bEffectTailIsSilent = false;
+					}
+
+					// Apply the wet level here after processing effects. 
+					if (!FMath::IsNearlyEqual(TargetWetLevel, CurrentWetLevel) || !FMath::IsNearlyEqual(CurrentWetLevel, 1.0f))
+					{
+						if (bIsSilent)
+						{
+							CurrentWetLevel = TargetWetLevel;
+							FMixerSubmixSilenceCounters::Increment(SilenceCounters.NumGainStagesSkipped);
+						}
+						else
+						{
+							ApplyGain(BufferPtr, NumSamples, CurrentWetLevel, TargetWetLevel, ParamRampStartFrames[(int32)EMixerParam::WetLevel]);
+						}
 					}
 				}
 			}
+
+			// Let the writer free the snapshot if it is replaced before the next block.
+			EffectChainPublisher.Release();
 		}
 
 		// Mix in the dry channel buffer
-		if (DryChannelBuffer.Num() > 0)
+		if (DryChannelBuffer)
 		{
-			// If we've already set the volume, only need to multiply by constant
-			if (FMath::IsNearlyEqual(TargetDryLevel, CurrentDryLevel))
-			{
-				MultiplyBufferByConstantInPlace(DryChannelBuffer, TargetDryLevel);
-			}
-			else
-			{
-				// To avoid popping, we do a fade on the buffer to the target volume
-				FadeBufferFast(DryChannelBuffer, CurrentDryLevel, TargetDryLevel);
-				CurrentDryLevel = TargetDryLevel;
-			}
-			MixInBufferFast(DryChannelBuffer, InputBuffer);
+			// Apply the dry level while mixing in, so the dry path makes one pass over memory.
+			ApplyGainAndMixIn(DryChannelBuffer, BufferPtr, NumSamples, CurrentDryLevel, TargetDryLevel, ParamRampStartFrames[(int32)EMixerParam::DryLevel]);
 		}
 
 		// If we're muted, memzero the buffer. Note we are still doing all the work to maintain buffer state between mutings.
 		if (bIsBackgroundMuted)
 		{
 			FMemory::Memzero((void*)BufferPtr, sizeof(float) * NumSamples);
+			bIsSilent = SubmixSkipSilenceCVar != 0;
+			bWroteInputBuffer = false;
 		}
 	
-		// If we are recording, Add out buffer to the RecordingData buffer:
+		// Recordings hand the block to the recorder's writer thread without locking or allocating.
+		if (StreamingRecorder.IsRecording() && !bIsRecordingPaused.load(std::memory_order_relaxed))
 		{
-			FScopeLock ScopedLock(&RecordingCriticalSection);
-			if (bIsRecording)
-			{
-				// TODO: Consider a scope lock between here and OnStopRecordingOutput.
-				RecordingData.Append((float*)BufferPtr, NumSamples);
-			}
+			StreamingRecorder.PushAudio(BufferPtr, NumSamples, NumChannels);
 		}
 
 		// If spectrum analysis is enabled for this submix, downmix the resulting audio
-		// and push it to the spectrum analyzer.
+		// and queue it for the device's analysis thread, which runs the FFT.
 		{
 			FScopeTryLock TryLock(&SpectrumAnalyzerCriticalSection);
 
-			if (TryLock.IsLocked() && SpectrumAnalyzer.IsValid())
+			if (!bSkipAnalysis && TryLock.IsLocked() && SpectrumAnalysisJob.IsValid())
 			{
-				MixBufferDownToMono(InputBuffer, NumChannels, MonoMixBuffer);
-				SpectrumAnalyzer->PushAudio(MonoMixBuffer.GetData(), MonoMixBuffer.Num());
-				SpectrumAnalyzer->PerformAnalysisIfPossible(true, true);
-			}
-		}
-
-		// Perform any envelope following if we're told to do so
-		if (bIsEnvelopeFollowing)
-		{
-			const int32 BufferSamples = InputBuffer.Num();
-			const float* AudioBufferPtr = InputBuffer.GetData();
+				float* MonoMixBuffer = FrameArena.Allocate<float>(NumOutputFrames);
 
-			// Perform envelope following per channel
-			FScopeLock EnvelopeScopeLock(&EnvelopeCriticalSection);
-			FMemory::Memset(EnvelopeValues, sizeof(float) * AUDIO_MIXER_MAX_OUTPUT_CHANNELS);
-
-			for (int32 ChannelIndex = 0; ChannelIndex < NumChannels; ++ChannelIndex)
-			{
-				// Get the envelope follower for the channel
-				FEnvelopeFollower& EnvFollower = EnvelopeFollowers[ChannelIndex];
-
-				// Track the last sample
-				for (int32 SampleIndex = ChannelIndex; SampleIndex < BufferSamples; SampleIndex += NumChannels)
+				// Standard layouts have a downmix compiled for their channel count that reads the interleaved buffer directly.
+				if (ChannelKernels.NumChannels != 0)
 				{
-					const float SampleValue = AudioBufferPtr[SampleIndex];
-					EnvFollower.ProcessAudio(SampleValue);
+					ChannelKernels.MixDownToMono(BufferPtr, MonoMixBuffer, NumOutputFrames, NumChannels);
 				}
-
-				EnvelopeValues[ChannelIndex] = EnvFollower.GetCurrentValue();
+				else
+				{
+					Kernels.MixDownToMono(BufferPtr, MonoMixBuffer, NumOutputFrames, NumChannels);
+				}
+				SpectrumAnalysisJob->PushAudio(MonoMixBuffer, NumOutputFrames);
 			}
+		}
 
-			EnvelopeNumChannels = NumChannels;
+		// Perform any envelope following if we're told to do so. The values are published
+		// without a lock, so meter readers never stall the render thread.
+		if (bIsEnvelopeFollowing && !bSkipAnalysis)
+		{
+			EnvelopeFollower.ProcessAudio(BufferPtr, NumOutputFrames, NumChannels);
 		}
 
 		// Now apply the output volume
 		if (!FMath::IsNearlyEqual(TargetOutputVolume, CurrentOutputVolume) || !FMath::IsNearlyEqual(CurrentOutputVolume, 1.0f))
 		{
-			// If we've already set the output volume, only need to multiply by constant
-			if (FMath::IsNearlyEqual(TargetOutputVolume, CurrentOutputVolume))
+			if (bIsSilent)
 			{
-				Audio::MultiplyBufferByConstantInPlace(InputBuffer, TargetOutputVolume);
+				CurrentOutputVolume = TargetOutputVolume;
+				FMixerSubmixSilenceCounters::Increment(SilenceCounters.NumGainStagesSkipped);
 			}
 			else
 			{
-				// To avoid popping, we do a fade on the buffer to the target volume
-				Audio::FadeBufferFast(InputBuffer, CurrentOutputVolume, TargetOutputVolume);
-				CurrentOutputVolume = TargetOutputVolume;
+				ApplyGain(BufferPtr, NumSamples, CurrentOutputVolume, TargetOutputVolume, ParamRampStartFrames[(int32)EMixerParam::OutputVolume]);
 			}
 		}
 
-		// Mix the audio buffer of this submix with the audio buffer of the output buffer (i.e. with other submixes)
-		Audio::MixInBufferFast(InputBuffer, OutAudioBuffer);
+		// Ramp offsets only apply to the block following the parameter change.
+		FMemory::Memzero(ParamRampStartFrames, sizeof(ParamRampStartFrames));
 
-		// Now loop through any buffer listeners and feed the listeners the result of this audio callback
-		if(const USoundSubmix* SoundSubmix = Cast<const USoundSubmix>(OwningSubmixObject))
+		// Mix the audio buffer of this submix with the audio buffer of the output buffer (i.e. with other submixes).
+		// A silent submix leaves the output untouched and tells its parent, which then skips it too.
+		if (bIsSilent)
+		{
+			FMixerSubmixSilenceCounters::Increment(SilenceCounters.NumSilentBlocks);
+		}
+		else
+		{
+			Kernels.MixIn(BufferPtr, OutAudioBuffer.GetData(), NumSamples);
+		}
+
+		bIsOutputSilent = bIsSilent;
+		bInputBufferIsCleared = bIsSilent && !bWroteInputBuffer;
+
+		// Now feed any buffer listeners the result of this audio callback. Synchronous listeners are called here;
+		// asynchronous ones pick the block up from the fanout's ring on their own threads. Neither takes a lock.
+		const USoundSubmix* SoundSubmix = Cast<const USoundSubmix>(OwningSubmixObject);
+		if (SoundSubmix && !bSkipAnalysis)
 		{
 			CSV_SCOPED_TIMING_STAT(Audio, SubmixBufferListeners);
 			double AudioClock = MixerDevice->GetAudioTime();
 			float SampleRate = MixerDevice->GetSampleRate();
-			FScopeLock Lock(&BufferListenerCriticalSection);
-			for (ISubmixBufferListener* BufferListener : BufferListeners)
-			{
-				check(BufferListener);
-				BufferListener->OnNewSubmixBuffer(SoundSubmix, OutAudioBuffer.GetData(), OutAudioBuffer.Num(), NumChannels, SampleRate, AudioClock);
-			}
+			BufferListenerFanout.Broadcast(SoundSubmix, OutAudioBuffer.GetData(), OutAudioBuffer.Num(), NumChannels, SampleRate, AudioClock);
 		}
+
+		return bIsSilent;
 	}
 
 	void FMixerSubmix::MixInChildSubmix(FChildSubmixInfo& Child, ISoundfieldAudioPacket& PacketToSumTo)
@@ -365,3 +681,417 @@
 			UpdateListenerRotation(ChildSubmixSharedPtr->SoundfieldStreams.CachedPositionalData.Rotation);
 		}
 	}
+
+	void FMixerSubmix::SetOutputVolume(float InOutputVolume, int32 InSampleOffset)
+	{
+		InOutputVolume = FMath::Clamp(InOutputVolume, 0.0f, 1.0f);
+		PushParamCommand(GetId(), EMixerParam::OutputVolume, InOutputVolume, InSampleOffset);
+	}
+
+	void FMixerSubmix::SetWetLevel(float InWetLevel, int32 InSampleOffset)
+	{
+		InWetLevel = FMath::Clamp(InWetLevel, 0.0f, 1.0f);
+		PushParamCommand(GetId(), EMixerParam::WetLevel, InWetLevel, InSampleOffset);
+	}
+
+	void FMixerSubmix::SetDryLevel(float InDryLevel, int32 InSampleOffset)
+	{
+		InDryLevel = FMath::Clamp(InDryLevel, 0.0f, 1.0f);
+		PushParamCommand(GetId(), EMixerParam::DryLevel, InDryLevel, InSampleOffset);
+	}
+
+	void FMixerSubmix::SetSourceVoiceSendLevel(const FMixerSourceVoice* InSourceVoice, float InSendLevel)
+	{
+		check(InSourceVoice);
+		PushParamCommand(InSourceVoice->GetSourceId(), EMixerParam::SendLevel, InSendLevel, 0);
+	}
+
+	void FMixerSubmix::PushParamCommand(uint32 InTargetId, EMixerParam InParam, float InValue, int32 InSampleOffset)
+	{
+		// If the stream is full, the value goes to its overflow list, which the pump applies after the queued values.
+		// A closure on the command queue would be pumped first and let older queued values overwrite it.
+		ParamCommands.Push(InTargetId, InParam, InValue, InSampleOffset);
+	}
+
+	void FMixerSubmix::PumpParamCommands()
+	{
+		ParamCommands.Pump([this](const FMixerParamCommand& Command)
+		{
+			ApplyParamCommand(Command);
+		});
+	}
+
+	void FMixerSubmix::ApplyParamCommand(const FMixerParamCommand& InCommand)
+	{
+		switch (InCommand.Param)
+		{
+		case EMixerParam::OutputVolume:
+			TargetOutputVolume = InCommand.Value;
+			break;
+
+		case EMixerParam::WetLevel:
+			TargetWetLevel = InCommand.Value;
+			break;
+
+		case EMixerParam::DryLevel:
+			TargetDryLevel = InCommand.Value;
+			break;
+
+		case EMixerParam::SendLevel:
+		{
+			// Send levels take effect at the start of the block; the voice mix has no notion of an intra-block ramp.
+			if (FSubmixVoiceData* VoiceData = FindSourceVoiceData((int32)InCommand.TargetId))
+			{
+				VoiceData->SendLevel = InCommand.Value;
+			}
+			return;
+		}
+
+		default:
+			checkNoEntry();
+			return;
+		}
+
+		ParamRampStartFrames[(int32)InCommand.Param] = InCommand.SampleOffset;
+	}
+
+	void FMixerSubmix::AddOrSetSourceVoice(FMixerSourceVoice* InSourceVoice, const float InSendLevel, EMixerSourceSubmixSendStage InSubmixSendStage)
+	{
+		AUDIO_MIXER_CHECK_AUDIO_PLAT_THREAD(MixerDevice);
+
+		FSubmixVoiceData NewVoiceData;
+		NewVoiceData.SendLevel = InSendLevel;
+		NewVoiceData.SubmixSendStage = InSubmixSendStage;
+		NewVoiceData.SourceId = InSourceVoice->GetSourceId();
+
+		MixerSourceVoices.Add(InSourceVoice, NewVoiceData);
+		SourceVoicesById.Add(NewVoiceData.SourceId, InSourceVoice);
+	}
+
+	void FMixerSubmix::RemoveSourceVoice(FMixerSourceVoice* InSourceVoice)
+	{
+		AUDIO_MIXER_CHECK_AUDIO_PLAT_THREAD(MixerDevice);
+
+		// The voice may already have been handed to another source, so unindex it by the id it was added with.
+		if (const FSubmixVoiceData* VoiceData = MixerSourceVoices.Find(InSourceVoice))
+		{
+			if (SourceVoicesById.FindRef(VoiceData->SourceId) == InSourceVoice)
+			{
+				SourceVoicesById.Remove(VoiceData->SourceId);
+			}
+		}
+
+		int32 NumRemoved = MixerSourceVoices.Remove(InSourceVoice);
+		AUDIO_MIXER_CHECK(NumRemoved == 1);
+	}
+
+	FMixerSubmix::FSubmixVoiceData* FMixerSubmix::FindSourceVoiceData(int32 InSourceId)
+	{
+		// The index is kept up to date as voices are added and removed, so a miss means the voice doesn't send here.
+		FMixerSourceVoice** SourceVoice = SourceVoicesById.Find(InSourceId);
+		return SourceVoice ? MixerSourceVoices.Find(*SourceVoice) : nullptr;
+	}
+
+	void FMixerSubmix::ApplyGain(float* InBuffer, int32 InNumSamples, float& InOutCurrentGain, float InTargetGain, int32 InRampStartFrame)
+	{
+		const FMixerKernels& Kernels = GetMixerKernels();
+
+		// If we've already reached the target, only need to multiply by constant
+		if (FMath::IsNearlyEqual(InTargetGain, InOutCurrentGain))
+		{
+			Kernels.MultiplyByConstantInPlace(InBuffer, InNumSamples, InTargetGain);
+			return;
+		}
+
+		// Hold the current gain up to the requested frame, then fade to the target to avoid popping. The kernels take any
+		// offset, so the ramp starts on the frame boundary and every channel of a frame gets the same gain stage.
+		const int32 RampStartSample = FMath::Clamp(InRampStartFrame, 0, InNumSamples / NumChannels) * NumChannels;
+
+		if (RampStartSample > 0)
+		{
+			Kernels.MultiplyByConstantInPlace(InBuffer, RampStartSample, InOutCurrentGain);
+		}
+
+		if (RampStartSample < InNumSamples)
+		{
+			Kernels.FadeInPlace(InBuffer + RampStartSample, InNumSamples - RampStartSample, InOutCurrentGain, InTargetGain);
+		}
+
+		InOutCurrentGain = InTargetGain;
+	}
+
+	void FMixerSubmix::ApplyGainAndMixIn(const float* InBuffer, float* BufferToSumTo, int32 InNumSamples, float& InOutCurrentGain, float InTargetGain, int32 InRampStartFrame)
+	{
+		const FMixerKernels& Kernels = GetMixerKernels();
+
+		if (FMath::IsNearlyEqual(InTargetGain, InOutCurrentGain))
+		{
+			Kernels.GainAndMixIn(InBuffer, BufferToSumTo, InNumSamples, InTargetGain);
+			return;
+		}
+
+		const int32 RampStartSample = FMath::Clamp(InRampStartFrame, 0, InNumSamples / NumChannels) * NumChannels;
+
+		if (RampStartSample > 0)
+		{
+			Kernels.GainAndMixIn(InBuffer, BufferToSumTo, RampStartSample, InOutCurrentGain);
+		}
+
+		if (RampStartSample < InNumSamples)
+		{
+			Kernels.FadeAndMixIn(InBuffer + RampStartSample, BufferToSumTo + RampStartSample, InNumSamples - RampStartSample, InOutCurrentGain, InTargetGain);
+		}
+
+		InOutCurrentGain = InTargetGain;
+	}
+
+	bool FMixerSubmix::StartStreamingRecording(const FString& InFilePath, ESubmixRecordingFormat InFormat)
+	{
+		FSubmixRecorderSettings Settings;
+		Settings.FilePath = InFilePath;
+		Settings.NumChannels = MixerDevice->GetNumDeviceChannels();
+		Settings.SampleRate = (int32)MixerDevice->GetSampleRate();
+		Settings.Format = InFormat;
+
+		return StreamingRecorder.StartRecording(Settings);
+	}
+
+	void FMixerSubmix::StopStreamingRecording()
+	{
+		StreamingRecorder.StopRecording();
+	}
+
+	void FMixerSubmix::OnStartRecordingOutput(float ExpectedDuration)
+	{
+		// The recording streams to a scratch file and is read back when it stops, so memory doesn't grow with its length
+		// and ExpectedDuration no longer needs to preallocate anything.
+		RecordingData.Reset();
+		bIsRecordingPaused.store(false, std::memory_order_relaxed);
+
+		const FString FilePath = FPaths::CreateTempFilename(*FPaths::ProjectIntermediateDir(), TEXT("SubmixRecording"), TEXT(".wav"));
+		if (StartStreamingRecording(FilePath, ESubmixRecordingFormat::Float32))
+		{
+			RecordingFilePath = FilePath;
+		}
+	}
+
+	AlignedFloatBuffer& FMixerSubmix::OnStopRecordingOutput(float& OutNumChannels, float& OutSampleRate)
+	{
+		OutNumChannels = NumChannels;
+		OutSampleRate = MixerDevice->GetSampleRate();
+
+		// Leave recordings started with StartStreamingRecording alone.
+		if (!RecordingFilePath.IsEmpty())
+		{
+			StopStreamingRecording();
+			StreamingRecorder.ReadRecording(RecordingData);
+
+			IFileManager::Get().Delete(*RecordingFilePath);
+			RecordingFilePath.Reset();
+		}
+
+		return RecordingData;
+	}
+
+	void FMixerSubmix::PauseRecordingOutput()
+	{
+		bIsRecordingPaused.store(true, std::memory_order_relaxed);
+	}
+
+	void FMixerSubmix::ResumeRecordingOutput()
+	{
+		bIsRecordingPaused.store(false, std::memory_order_relaxed);
+	}
+
+	void FMixerSubmix::RegisterAsyncBufferListener(ISubmixBufferListener* BufferListener)
+	{
+		check(BufferListener);
+
+		// Size the shared ring for the largest block the device can render.
+		BufferListenerFanout.AddListener(BufferListener, true, MixerDevice->GetNumOutputFrames() * AUDIO_MIXER_MAX_OUTPUT_CHANNELS);
+	}
+
+	uint64 FMixerSubmix::GetBufferListenerOverruns(const ISubmixBufferListener* BufferListener) const
+	{
+		return BufferListenerFanout.GetNumOverruns(BufferListener);
+	}
+
+	void FMixerSubmix::StartSpectrumAnalysisJob(const FSpectrumAnalyzerSettings& InSettings)
+	{
+		StopSpectrumAnalysisJob();
+
+		// Give the analysis thread a few blocks of slack before audio is dropped.
+		const int32 RingBufferFrames = FMath::Max(MixerDevice->GetNumOutputFrames() * 8, (int32)InSettings.FFTSize * 2);
+		FSpectrumAnalysisJobPtr NewJob = MakeShared<FSpectrumAnalysisJob, ESPMode::ThreadSafe>(InSettings, MixerDevice->GetSampleRate(), RingBufferFrames);
+		MixerDevice->GetAnalysisService().AddJob(NewJob);
+
+		FScopeLock Lock(&SpectrumAnalyzerCriticalSection);
+		SpectrumAnalysisJob = NewJob;
+	}
+
+	void FMixerSubmix::StopSpectrumAnalysisJob()
+	{
+		FSpectrumAnalysisJobPtr OldJob;
+		{
+			FScopeLock Lock(&SpectrumAnalyzerCriticalSection);
+			OldJob = MoveTemp(SpectrumAnalysisJob);
+		}
+
+		if (OldJob.IsValid())
+		{
+			MixerDevice->GetAnalysisService().RemoveJob(OldJob);
+		}
+	}
+
+	void FMixerSubmix::GetSpectrumMagnitudesForFrequencies(const TArray<float>& InFrequencies, TArray<float>& OutMagnitudes)
+	{
+		FSpectrumAnalysisJobPtr Job;
+		{
+			FScopeLock Lock(&SpectrumAnalyzerCriticalSection);
+			Job = SpectrumAnalysisJob;
+		}
+
+		if (Job.IsValid())
+		{
+			Job->GetMagnitudesForFrequencies(InFrequencies, OutMagnitudes);
+		}
+		else
+		{
+			OutMagnitudes.Reset();
+			OutMagnitudes.AddZeroed(InFrequencies.Num());
+		}
+	}
+
+	void FMixerSubmix::GetSpectrumPhasesForFrequencies(const TArray<float>& InFrequencies, TArray<float>& OutPhases)
+	{
+		FSpectrumAnalysisJobPtr Job;
+		{
+			FScopeLock Lock(&SpectrumAnalyzerCriticalSection);
+			Job = SpectrumAnalysisJob;
+		}
+
+		if (Job.IsValid())
+		{
+			Job->GetPhasesForFrequencies(InFrequencies, OutPhases);
+		}
+		else
+		{
+			OutPhases.Reset();
+			OutPhases.AddZeroed(InFrequencies.Num());
+		}
+	}
+
+	FMixerStatsEntry* FMixerSubmix::GetTimingStatsEntry()
+	{
+		// Entries are claimed off the render thread (see ClaimTimingStats), so rendering only reads the pointer.
+		return SubmixTimingStatsCVar ? TimingStatsEntry.load(std::memory_order_acquire) : nullptr;
+	}
+
+	FMixerCycleHistogram* FMixerSubmix::GetEffectTimingHistogram(int32 InEffectIndex)
+	{
+		// Called by GenerateEffectChainAudio around each effect's ProcessAudio.
+		if (!SubmixTimingStatsCVar || InEffectIndex < 0 || InEffectIndex >= AUDIO_MIXER_MAX_TIMED_SUBMIX_EFFECTS)
+		{
+			return nullptr;
+		}
+
+		FMixerStatsEntry* EffectEntry = EffectTimingStatsEntries[InEffectIndex].load(std::memory_order_acquire);
+		return EffectEntry ? &EffectEntry->Histogram : nullptr;
+	}
+
+	void FMixerSubmix::ClaimTimingStats(int32 InNumEffects)
+	{
+		// Called from Init and from UpdateEffectChains, never from the render thread: naming an entry allocates.
+		// Entries stay claimed until the submix goes away, so a chain that shrinks and grows again keeps its history.
+		if (!SubmixTimingStatsCVar)
+		{
+			return;
+		}
+
+		FMixerStatsRegistry& Registry = FMixerStatsRegistry::Get();
+		const FString SubmixName = OwningSubmixObject ? OwningSubmixObject->GetName() : FString::Printf(TEXT("Submix %u"), GetId());
+
+		if (!TimingStatsEntry.load(std::memory_order_relaxed))
+		{
+			TimingStatsEntry.store(Registry.AcquireEntry(EMixerStatsEntryKind::Submix, SubmixName), std::memory_order_release);
+		}
+
+		const int32 NumTimedEffects = FMath::Min(InNumEffects, AUDIO_MIXER_MAX_TIMED_SUBMIX_EFFECTS);
+		for (int32 EffectIndex = 0; EffectIndex < NumTimedEffects; ++EffectIndex)
+		{
+			std::atomic<FMixerStatsEntry*>& EffectEntry = EffectTimingStatsEntries[EffectIndex];
+			if (!EffectEntry.load(std::memory_order_relaxed))
+			{
+				EffectEntry.store(Registry.AcquireEntry(EMixerStatsEntryKind::Effect, FString::Printf(TEXT("%s/Effect %d"), *SubmixName, EffectIndex)), std::memory_order_release);
+			}
+		}
+	}
+
+	void FMixerSubmix::ReleaseTimingStats()
+	{
+		FMixerStatsRegistry& Registry = FMixerStatsRegistry::Get();
+
+		Registry.ReleaseEntry(TimingStatsEntry.exchange(nullptr, std::memory_order_acq_rel));
+
+		for (std::atomic<FMixerStatsEntry*>& EffectEntry : EffectTimingStatsEntries)
+		{
+			Registry.ReleaseEntry(EffectEntry.exchange(nullptr, std::memory_order_acq_rel));
+		}
+	}
+
+	void FMixerSubmix::SetEffectPriority(EMixerSubmixEffectPriority InEffectPriority)
+	{
+		SubmixCommand([this, InEffectPriority]()
+		{
+			EffectPriority = InEffectPriority;
+		});
+	}
+
+	void FMixerSubmix::UpdateEffectChains(TFunctionRef<void(TArray<FSubmixEffectFadeInfo>&)> InEditFunction)
+	{
+		// Writers are serialized by the mutation lock. The render thread never takes it; it picks up the published snapshot on its next block.
+		FScopeLock ScopeLock(&EffectChainMutationCriticalSection);
+
+		// Clear the flag before looking at the chains, so a chain finishing meanwhile raises it again.
+		bHasFinishedEffectChains.store(false, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		FMixerEffectChainSnapshot* Snapshot = new FMixerEffectChainSnapshot();
+		if (const FMixerEffectChainSnapshot* Latest = EffectChainPublisher.GetLatest())
+		{
+			Snapshot->Chains.Reserve(Latest->Chains.Num() + 1);
+			for (const FSubmixEffectFadeInfo& FadeInfo : Latest->Chains)
+			{
+				// Chains the render thread has finished fading out are dropped here, off the render thread.
+				if (!FadeInfo.Fade->bIsFinished.load(std::memory_order_acquire))
+				{
+					Snapshot->Chains.Add(FadeInfo);
+				}
+			}
+		}
+
+		InEditFunction(Snapshot->Chains);
+
+		// Claim timing entries for any new effects before the render thread can see them.
+		int32 MaxNumEffects = 0;
+		for (const FSubmixEffectFadeInfo& FadeInfo : Snapshot->Chains)
+		{
+			MaxNumEffects = FMath::Max(MaxNumEffects, FadeInfo.EffectChain.Num());
+		}
+		ClaimTimingStats(MaxNumEffects);
+
+		EffectChainPublisher.Publish(Snapshot);
+	}
+
+	void FMixerSubmix::CollectRetiredEffectChains()
+	{
+		if (bHasFinishedEffectChains.load(std::memory_order_acquire))
+		{
+			UpdateEffectChains([](TArray<FSubmixEffectFadeInfo>&) {});
+		}
+		else
+		{
+			FScopeLock ScopeLock(&EffectChainMutationCriticalSection);
+			EffectChainPublisher.Reclaim();
+		}
+	}
@@ -0,0 +1,245 @@
+#include "audio_mixer_submix_graph.h"
+
+namespace Audio
+{
+	void FMixerSubmixGraph::MarkDirty()
+	{
+		bIsDirty.store(true, std::memory_order_release);
+	}
+
+	void FMixerSubmixGraph::Render(const FMixerSubmixPtr& InRootSubmix, AlignedFloatBuffer& OutAudioBuffer, FMixerRenderThreadPool* InThreadPool)
+	{
+		check(InRootSubmix.IsValid());
+
+		if (bIsDirty.exchange(false, std::memory_order_acquire) || RootSubmix != InRootSubmix)
+		{
+			Compile(InRootSubmix);
+		}
+
+		RootOutputBuffer = &OutAudioBuffer;
+
+		if (InThreadPool && InThreadPool->GetNumWorkers() > 0)
+		{
+			for (FNode& Node : Nodes)
+			{
+				Node.NumPendingChildren.Set(Node.NumChildren);
+			}
+
+			// Soundfield nodes render here on the audio render thread. Parents they complete join the leaves as ready tasks.
+			ReadyNodes.Reset();
+			ReadyNodes.Append(LeafNodes);
+			for (int32 NodeIndex : SoundfieldNodes)
+			{
+				const int32 ReadyNodeIndex = RenderNode(NodeIndex);
+				if (ReadyNodeIndex != INDEX_NONE)
+				{
+					ReadyNodes.Add(ReadyNodeIndex);
+				}
+			}
+
+			InThreadPool->Execute(ReadyNodes, Nodes.Num() - SoundfieldNodes.Num(), [this](int32 NodeIndex)
+			{
+				return RenderNode(NodeIndex);
+			});
+		}
+		else
+		{
+			// Topological order guarantees every child has rendered before its parent sums it.
+			for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+			{
+				RenderNode(NodeIndex);
+			}
+		}
+
+		RootOutputBuffer = nullptr;
+	}
+
+	void FMixerSubmixGraph::Reset()
+	{
+		ResetPlan();
+		OutputBuffers.Reset();
+		MarkDirty();
+	}
+
+	void FMixerSubmixGraph::ResetPlan()
+	{
+		Nodes.Reset();
+		ChildNodes.Reset();
+		ChildOutputs.Reset();
+		AudibleChildOutputs.Reset();
+		NodeIsSilent.Reset();
+		OutputIsZeroed.Reset();
+		LeafNodes.Reset();
+		SoundfieldNodes.Reset();
+		ReadyNodes.Reset();
+		PinnedSubmixes.Reset();
+		RootSubmix.Reset();
+	}
+
+	void FMixerSubmixGraph::Compile(const FMixerSubmixPtr& InRootSubmix)
+	{
+		// Drop the previous plan's references first so children that were destroyed elsewhere fail to pin and get pruned.
+		// The arrays and output buffers keep their memory, so recompiling a tree that didn't grow doesn't allocate.
+		ResetPlan();
+
+		RootSubmix = InRootSubmix;
+		AddSubtree(*RootSubmix);
+
+		// Buffers are only assigned once every node exists, so the pointers handed to parents stay valid.
+		AssignOutputBuffers();
+		NodeIsSilent.SetNumZeroed(Nodes.Num());
+		OutputIsZeroed.SetNumZeroed(OutputBuffers.Num());
+
+		ChildOutputs.SetNumUninitialized(ChildNodes.Num());
+		for (int32 ChildIndex = 0; ChildIndex < ChildNodes.Num(); ++ChildIndex)
+		{
+			ChildOutputs[ChildIndex] = &OutputBuffers[Nodes[ChildNodes[ChildIndex]].OutputBufferIndex];
+		}
+		AudibleChildOutputs.SetNumUninitialized(ChildNodes.Num());
+		ReadyNodes.Reserve(Nodes.Num());
+	}
+
+	void FMixerSubmixGraph::AssignOutputBuffers()
+	{
+		// Subtrees are contiguous and end with their root, so a node's descendants are the nodes from FirstDescendant up to it.
+		FirstDescendants.SetNumUninitialized(Nodes.Num(), false);
+		for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+		{
+			FirstDescendants[NodeIndex] = NodeIndex;
+		}
+		for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+		{
+			const int32 ParentIndex = Nodes[NodeIndex].ParentIndex;
+			if (ParentIndex != INDEX_NONE)
+			{
+				FirstDescendants[ParentIndex] = FMath::Min(FirstDescendants[ParentIndex], FirstDescendants[NodeIndex]);
+			}
+		}
+
+		// The node that reads each buffer last, i.e. the parent of its latest owner.
+		BufferReaders.Reset();
+
+		for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+		{
+			FNode& Node = Nodes[NodeIndex];
+			if (Node.ParentIndex == INDEX_NONE)
+			{
+				continue;
+			}
+
+			// A node only starts after all its descendants have finished, so a buffer whose reader is a
+			// strict descendant has been consumed by then, on any thread and in any order.
+			Node.OutputBufferIndex = INDEX_NONE;
+			for (int32 BufferIndex = 0; BufferIndex < BufferReaders.Num(); ++BufferIndex)
+			{
+				const int32 Reader = BufferReaders[BufferIndex];
+				if (Reader >= FirstDescendants[NodeIndex] && Reader < NodeIndex)
+				{
+					Node.OutputBufferIndex = BufferIndex;
+					break;
+				}
+			}
+
+			if (Node.OutputBufferIndex == INDEX_NONE)
+			{
+				Node.OutputBufferIndex = BufferReaders.Add(Node.ParentIndex);
+			}
+			else
+			{
+				BufferReaders[Node.OutputBufferIndex] = Node.ParentIndex;
+			}
+		}
+
+		// Buffers beyond the new count are freed, the rest keep their storage.
+		OutputBuffers.SetNum(BufferReaders.Num(), false);
+	}
+
+	int32 FMixerSubmixGraph::AddSubtree(FMixerSubmix& InSubmix)
+	{
+		// Soundfield submixes mix their children through their own encoders, so their whole subtree renders as one node.
+		const int32 FirstChild = PinnedSubmixes.Num();
+		if (!InSubmix.IsSoundfieldSubmix())
+		{
+			InSubmix.GatherChildSubmixes(PinnedSubmixes);
+		}
+		const int32 NumChildren = PinnedSubmixes.Num() - FirstChild;
+
+		// The children's node indices are stacked in a member array, so the recursion doesn't allocate once it has grown.
+		const int32 FirstPendingChild = PendingChildNodes.Num();
+		for (int32 ChildIndex = 0; ChildIndex < NumChildren; ++ChildIndex)
+		{
+			const int32 ChildNodeIndex = AddSubtree(*PinnedSubmixes[FirstChild + ChildIndex]);
+			PendingChildNodes.Add(ChildNodeIndex);
+		}
+
+		const int32 NodeIndex = Nodes.AddDefaulted();
+		FNode& Node = Nodes[NodeIndex];
+		Node.Submix = &InSubmix;
+		Node.FirstChild = ChildNodes.Num();
+		Node.NumChildren = NumChildren;
+
+		for (int32 ChildIndex = FirstPendingChild; ChildIndex < FirstPendingChild + NumChildren; ++ChildIndex)
+		{
+			const int32 ChildNodeIndex = PendingChildNodes[ChildIndex];
+			Nodes[ChildNodeIndex].ParentIndex = NodeIndex;
+			ChildNodes.Add(ChildNodeIndex);
+		}
+		PendingChildNodes.SetNum(FirstPendingChild, false);
+
+		if (InSubmix.IsSoundfieldSubmix())
+		{
+			SoundfieldNodes.Add(NodeIndex);
+		}
+		else if (NumChildren == 0)
+		{
+			LeafNodes.Add(NodeIndex);
+		}
+
+		return NodeIndex;
+	}
+
+	int32 FMixerSubmixGraph::RenderNode(int32 NodeIndex)
+	{
+		FNode& Node = Nodes[NodeIndex];
+
+		AlignedFloatBuffer* OutputBuffer = RootOutputBuffer;
+		if (Node.ParentIndex != INDEX_NONE)
+		{
+			// Children render into a zeroed buffer of their own so their parent can sum them in a fixed order.
+			// A buffer its last user left silent is still zeroed. Only the first block after a compile
+			// or a device format change resizes the buffer.
+			OutputBuffer = &OutputBuffers[Node.OutputBufferIndex];
+			if (!OutputIsZeroed[Node.OutputBufferIndex] || OutputBuffer->Num() != RootOutputBuffer->Num())
+			{
+				OutputBuffer->Reset(RootOutputBuffer->Num());
+				OutputBuffer->AddZeroed(RootOutputBuffer->Num());
+			}
+		}
+
+		// Skipping silent children keeps the mixing order of the rest, so serial and parallel rendering still match.
+		// Each node only writes its own range of the scratch array.
+		int32 NumAudibleChildren = 0;
+		for (int32 ChildIndex = Node.FirstChild; ChildIndex < Node.FirstChild + Node.NumChildren; ++ChildIndex)
+		{
+			if (!NodeIsSilent[ChildNodes[ChildIndex]])
+			{
+				AudibleChildOutputs[Node.FirstChild + NumAudibleChildren++] = ChildOutputs[ChildIndex];
+			}
+		}
+
+		const bool bIsSilent = Node.Submix->ProcessAudioFromChildOutputs(TArrayView<const AlignedFloatBuffer* const>(AudibleChildOutputs.GetData() + Node.FirstChild, NumAudibleChildren), *OutputBuffer);
+
+		NodeIsSilent[NodeIndex] = bIsSilent;
+		if (Node.ParentIndex != INDEX_NONE)
+		{
+			OutputIsZeroed[Node.OutputBufferIndex] = bIsSilent;
+		}
+
+		if (Node.ParentIndex != INDEX_NONE && Nodes[Node.ParentIndex].NumPendingChildren.Decrement() == 0)
+		{
+			return Node.ParentIndex;
+		}
+
+		return INDEX_NONE;
+	}
+}
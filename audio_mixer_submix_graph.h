@@ -0,0 +1,137 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AudioMixerSubmix.h"
+#include "audio_mixer_render_pool.h"
+#include <atomic>
+
+namespace Audio
+{
+	/**
+	 * Precompiled execution plan for a submix tree.
+	 *
+	 * The tree is compiled into a flat array of nodes in topological order (children before
+	 * their parent) with raw submix pointers and preassigned output buffers. The plan is only
+	 * recompiled when it is marked dirty or the root changes, and dead children are pruned
+	 * during compilation, so rendering a block does not pin weak pointers, walk hash maps or
+	 * allocate.
+	 *
+	 * The plan can be rendered serially by walking the array, or in parallel on a
+	 * FMixerRenderThreadPool. Each non-root node renders into its own output buffer and a
+	 * parent sums its children's outputs in the same order the serial FMixerSubmix::ProcessAudio
+	 * recursion visits them, so every mode produces bit-identical output. Soundfield submixes
+	 * are compiled into a single node together with their subtree. That node recurses through
+	 * FMixerSubmix::ProcessAudio, which may only run on the audio render thread, so soundfield
+	 * nodes are always rendered by the thread calling Render, before the pool takes the rest.
+	 *
+	 * Output buffers are shared between nodes whose outputs are never live at the same time: a node
+	 * reuses a buffer once the parent reading it is one of the node's own descendants, which holds
+	 * for any schedule of the thread pool. The plan therefore holds as many buffers as the tree's
+	 * largest number of simultaneously live outputs rather than one per submix.
+	 *
+	 * A silent child is left out of its parent's mix. It also leaves its buffer zeroed, which each
+	 * buffer tracks so it isn't cleared again before its next use.
+	 */
+	class FMixerSubmixGraph
+	{
+	public:
+
+		/** Requests a recompile before the next block, e.g. because a submix was added, removed or reparented. Thread safe. */
+		void MarkDirty();
+
+		/**
+		 * Renders the tree below the given root, recompiling the plan first if needed.
+		 *
+		 * @param InRootSubmix The submix at the root of the tree (usually the master submix).
+		 * @param OutAudioBuffer The buffer the root submix mixes its output into.
+		 * @param InThreadPool The pool to render on, or nullptr to render serially on the calling thread.
+		 */
+		void Render(const FMixerSubmixPtr& InRootSubmix, AlignedFloatBuffer& OutAudioBuffer, FMixerRenderThreadPool* InThreadPool);
+
+		/** Releases the compiled plan, its output buffers and the submixes it keeps alive. */
+		void Reset();
+
+	private:
+
+		struct FNode
+		{
+			/** The submix rendered by this node. */
+			FMixerSubmix* Submix = nullptr;
+
+			/** Index of the parent node, or INDEX_NONE for the root. */
+			int32 ParentIndex = INDEX_NONE;
+
+			/** Range of this node's children in ChildNodes and ChildOutputs. */
+			int32 FirstChild = 0;
+			int32 NumChildren = 0;
+
+			/** Index of this node's output buffer in OutputBuffers, or INDEX_NONE for the root. Shared with other nodes whose outputs are live at other times. */
+			int32 OutputBufferIndex = INDEX_NONE;
+
+			/** Number of children that have not finished rendering in the current block. */
+			FThreadSafeCounter NumPendingChildren;
+		};
+
+		/** Rebuilds the plan below the given root. */
+		void Compile(const FMixerSubmixPtr& InRootSubmix);
+
+		/** Empties the plan but keeps the allocations of its arrays and the output buffers for the next compile. */
+		void ResetPlan();
+
+		/** Assigns the output buffers of the non-root nodes, sharing buffers whose lifetimes can't overlap. */
+		void AssignOutputBuffers();
+
+		/** Appends the subtree below the given submix, children before their parent. Returns the submix's node index. */
+		int32 AddSubtree(FMixerSubmix& InSubmix);
+
+		/** Renders one node and returns its parent if this was the parent's last pending child. */
+		int32 RenderNode(int32 NodeIndex);
+
+		/** Nodes in topological order. The root is always last. */
+		TArray<FNode> Nodes;
+
+		/** Output buffers of the non-root nodes. */
+		TArray<AlignedFloatBuffer> OutputBuffers;
+
+		/** Node indices of each node's children, grouped per parent in serial mixing order. */
+		TArray<int32> ChildNodes;
+
+		/** Output buffers matching ChildNodes. */
+		TArray<const AlignedFloatBuffer*> ChildOutputs;
+
+		/** Per node scratch, laid out like ChildOutputs, holding the outputs of the children that were not silent. */
+		TArray<const AlignedFloatBuffer*> AudibleChildOutputs;
+
+		/** Whether each node's output was silent in the current block. */
+		TArray<bool> NodeIsSilent;
+
+		/** Whether each output buffer is known to be all zeros. */
+		TArray<bool> OutputIsZeroed;
+
+		/** Nodes without children, which can start rendering immediately. Excludes soundfield nodes. */
+		TArray<int32> LeafNodes;
+
+		/** Soundfield nodes, which are always leaves and render on the thread calling Render. */
+		TArray<int32> SoundfieldNodes;
+
+		/** Scratch for the nodes handed to the pool, sized when compiling. */
+		TArray<int32> ReadyNodes;
+
+		/** Compile scratch: child node indices still waiting for their parent's node, and the working sets of AssignOutputBuffers. */
+		TArray<int32> PendingChildNodes;
+		TArray<int32> FirstDescendants;
+		TArray<int32> BufferReaders;
+
+		/** Keeps every submix in the plan alive until the next recompile. */
+		TArray<FMixerSubmixPtr> PinnedSubmixes;
+
+		/** Root the plan was compiled for. */
+		FMixerSubmixPtr RootSubmix;
+
+		/** Output of the root node for the block being rendered. */
+		AlignedFloatBuffer* RootOutputBuffer = nullptr;
+
+		/** Set when the topology may have changed since the last compile. */
+		std::atomic<bool> bIsDirty { true };
+	};
+}
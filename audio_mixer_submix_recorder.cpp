@@ -0,0 +1,526 @@
+#include "audio_mixer_submix_recorder.h"
+#include "audio_mixer_kernels.h"
+#include "AudioMixerLog.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Serialization/Archive.h"
+
+namespace Audio
+{
+	namespace SubmixRecorder
+	{
+		/** How long the writer sleeps when the ring is empty. The ring holds seconds of audio, so this only needs to be short enough to keep the file current. */
+		static const float WriterPollIntervalSeconds = 0.01f;
+
+		static const uint16 WaveFormatPcm = 0x0001;
+		static const uint16 WaveFormatIeeeFloat = 0x0003;
+		static const uint16 WaveFormatImaAdpcm = 0x0011;
+
+		/** Size of the JUNK chunk body that is rewritten as a ds64 chunk if the file needs RF64. */
+		static const uint32 Ds64ChunkSize = 28;
+
+		/** ADPCM block size per channel. Each block holds a 4 byte header and 508 bytes of nibbles per channel. */
+		static const int32 AdpcmBlockAlignPerChannel = 512;
+		static const int32 AdpcmSamplesPerBlock = (AdpcmBlockAlignPerChannel - 4) * 2 + 1;
+
+		static const int32 AdpcmIndexTable[16] =
+		{
+			-1, -1, -1, -1, 2, 4, 6, 8,
+			-1, -1, -1, -1, 2, 4, 6, 8
+		};
+
+		static const int32 AdpcmStepTable[89] =
+		{
+			7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+			50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+			337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+			2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+			15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+		};
+
+		/** Encodes one sample and updates the channel's predictor and step index. */
+		static uint8 EncodeAdpcmSample(int32 Sample, int32& InOutPredictor, int32& InOutStepIndex)
+		{
+			int32 Difference = Sample - InOutPredictor;
+			uint8 Nibble = 0;
+			if (Difference < 0)
+			{
+				Nibble = 8;
+				Difference = -Difference;
+			}
+
+			// Quantize the difference the same way the decoder will reconstruct it, so the predictors stay in sync.
+			int32 Step = AdpcmStepTable[InOutStepIndex];
+			int32 Delta = Step >> 3;
+			if (Difference >= Step)
+			{
+				Nibble |= 4;
+				Difference -= Step;
+				Delta += Step;
+			}
+			Step >>= 1;
+			if (Difference >= Step)
+			{
+				Nibble |= 2;
+				Difference -= Step;
+				Delta += Step;
+			}
+			Step >>= 1;
+			if (Difference >= Step)
+			{
+				Nibble |= 1;
+				Delta += Step;
+			}
+
+			InOutPredictor = FMath::Clamp(InOutPredictor + ((Nibble & 8) ? -Delta : Delta), -32768, 32767);
+			InOutStepIndex = FMath::Clamp(InOutStepIndex + AdpcmIndexTable[Nibble], 0, 88);
+			return Nibble;
+		}
+
+		static void AppendTag(TArray<uint8>& Out, const char* Tag)
+		{
+			Out.Append(reinterpret_cast<const uint8*>(Tag), 4);
+		}
+
+		static void AppendUInt16(TArray<uint8>& Out, uint16 Value)
+		{
+			Out.Add((uint8)(Value & 0xFF));
+			Out.Add((uint8)(Value >> 8));
+		}
+
+		static void AppendUInt32(TArray<uint8>& Out, uint32 Value)
+		{
+			AppendUInt16(Out, (uint16)(Value & 0xFFFF));
+			AppendUInt16(Out, (uint16)(Value >> 16));
+		}
+
+		static void AppendUInt64(TArray<uint8>& Out, uint64 Value)
+		{
+			AppendUInt32(Out, (uint32)(Value & 0xFFFFFFFF));
+			AppendUInt32(Out, (uint32)(Value >> 32));
+		}
+	}
+
+	FMixerSubmixRecorder::FMixerSubmixRecorder()
+		: NumAdpcmBlockSamples(0)
+		, FileWriter(nullptr)
+		, Thread(nullptr)
+		, HeaderSize(0)
+		, NumDataBytes(0)
+		, bWriteFailed(false)
+		, bIsAcceptingAudio(false)
+		, bIsPushing(false)
+		, bStopRequested(false)
+		, NumDroppedBlocks(0)
+		, NumDroppedSamples(0)
+		, NumSamplesWritten(0)
+	{
+	}
+
+	FMixerSubmixRecorder::~FMixerSubmixRecorder()
+	{
+		StopRecording();
+	}
+
+	bool FMixerSubmixRecorder::StartRecording(const FSubmixRecorderSettings& InSettings)
+	{
+		using namespace SubmixRecorder;
+
+		if (Thread)
+		{
+			UE_LOG(LogAudioMixer, Warning, TEXT("Can't start recording to %s: the submix is already being recorded to %s."), *InSettings.FilePath, *Settings.FilePath);
+			return false;
+		}
+
+		if (!ensure(InSettings.NumChannels > 0 && InSettings.SampleRate > 0))
+		{
+			return false;
+		}
+
+		FileWriter = IFileManager::Get().CreateFileWriter(*InSettings.FilePath);
+		if (!FileWriter)
+		{
+			UE_LOG(LogAudioMixer, Warning, TEXT("Failed to open %s for submix recording."), *InSettings.FilePath);
+			return false;
+		}
+
+		Settings = InSettings;
+		NumDataBytes = 0;
+		bWriteFailed = false;
+		NumAdpcmBlockSamples = 0;
+		NumDroppedBlocks.store(0, std::memory_order_relaxed);
+		NumDroppedSamples.store(0, std::memory_order_relaxed);
+		NumSamplesWritten.store(0, std::memory_order_relaxed);
+
+		// Everything the recording needs is allocated here, so neither thread allocates while recording.
+		const uint32 RingCapacity = FMath::Max(1, FMath::CeilToInt(Settings.RingBufferSeconds * Settings.SampleRate) * Settings.NumChannels);
+		RingBuffer.SetCapacity(RingCapacity);
+
+		if (Settings.Format == ESubmixRecordingFormat::ImaAdpcm)
+		{
+			AdpcmBlockSamples.SetNumZeroed(AdpcmSamplesPerBlock * Settings.NumChannels);
+			AdpcmBlock.SetNumZeroed(AdpcmBlockAlignPerChannel * Settings.NumChannels);
+			AdpcmPredictors.Init(0, Settings.NumChannels);
+			AdpcmStepIndices.Init(0, Settings.NumChannels);
+			Int16Buffer.SetNumZeroed(AdpcmBlockSamples.Num());
+		}
+		else if (Settings.Format == ESubmixRecordingFormat::Int16)
+		{
+			Int16Buffer.SetNumZeroed(FMath::Min<int32>(RingBuffer.GetCapacity(), 16384));
+		}
+
+		// Reserve the header; it is rewritten with the final sizes when the recording stops.
+		WriteHeader(false);
+
+		bStopRequested.store(false, std::memory_order_relaxed);
+		Thread = FRunnableThread::Create(this, TEXT("AudioSubmixRecorder"), 0, TPri_BelowNormal);
+		if (!Thread)
+		{
+			FileWriter->Close();
+			delete FileWriter;
+			FileWriter = nullptr;
+			return false;
+		}
+
+		bIsAcceptingAudio.store(true, std::memory_order_seq_cst);
+		return true;
+	}
+
+	void FMixerSubmixRecorder::StopRecording()
+	{
+		if (!Thread)
+		{
+			return;
+		}
+
+		// Once the render thread is seen outside PushAudio after the flag is cleared, it won't touch the ring again.
+		bIsAcceptingAudio.store(false, std::memory_order_seq_cst);
+		while (bIsPushing.load(std::memory_order_seq_cst))
+		{
+			FPlatformProcess::Yield();
+		}
+
+		// The writer drains what is left and finalizes the file before it exits.
+		Stop();
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+
+		UE_LOG(LogAudioMixer, Display, TEXT("Finished submix recording to %s: %llu frames written, %llu blocks (%llu samples) dropped."),
+			*Settings.FilePath, GetNumFramesWritten(), GetNumDroppedBlocks(), GetNumDroppedSamples());
+	}
+
+	bool FMixerSubmixRecorder::ReadRecording(AlignedFloatBuffer& OutSamples) const
+	{
+		OutSamples.Reset();
+
+		if (!ensure(!Thread && Settings.Format == ESubmixRecordingFormat::Float32) || bWriteFailed || Settings.FilePath.IsEmpty())
+		{
+			return false;
+		}
+
+		const uint64 NumSamples = NumDataBytes / sizeof(float);
+		if (NumSamples > MAX_int32)
+		{
+			UE_LOG(LogAudioMixer, Warning, TEXT("Submix recording %s is too long to read into memory."), *Settings.FilePath);
+			return false;
+		}
+
+		FArchive* FileReader = IFileManager::Get().CreateFileReader(*Settings.FilePath);
+		if (!FileReader)
+		{
+			UE_LOG(LogAudioMixer, Warning, TEXT("Failed to open %s to read back the submix recording."), *Settings.FilePath);
+			return false;
+		}
+
+		// The recorder wrote the header, so the audio starts right after it.
+		OutSamples.SetNumUninitialized((int32)NumSamples);
+		FileReader->Seek(HeaderSize);
+		FileReader->Serialize(OutSamples.GetData(), NumSamples * sizeof(float));
+
+		const bool bSucceeded = !FileReader->IsError();
+		FileReader->Close();
+		delete FileReader;
+
+		if (!bSucceeded)
+		{
+			OutSamples.Reset();
+		}
+		return bSucceeded;
+	}
+
+	void FMixerSubmixRecorder::PushAudio(const float* InAudio, int32 InNumSamples, int32 InNumChannels)
+	{
+		bIsPushing.store(true, std::memory_order_seq_cst);
+
+		if (bIsAcceptingAudio.load(std::memory_order_seq_cst))
+		{
+			// The writer keeps draining the ring even after a write error, so this always makes progress.
+			if (Settings.bWaitWhenFull && (uint32)InNumSamples <= RingBuffer.GetCapacity())
+			{
+				while (RingBuffer.Remainder() < (uint32)InNumSamples)
+				{
+					FPlatformProcess::Yield();
+				}
+			}
+
+			// Only whole blocks are dropped, so the recording never loses its channel alignment.
+			if (InNumChannels != Settings.NumChannels || RingBuffer.Remainder() < (uint32)InNumSamples)
+			{
+				NumDroppedBlocks.store(NumDroppedBlocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+				NumDroppedSamples.store(NumDroppedSamples.load(std::memory_order_relaxed) + InNumSamples, std::memory_order_relaxed);
+			}
+			else
+			{
+				RingBuffer.Push(InAudio, InNumSamples);
+			}
+		}
+
+		bIsPushing.store(false, std::memory_order_release);
+	}
+
+	uint32 FMixerSubmixRecorder::Run()
+	{
+		while (!bStopRequested.load(std::memory_order_acquire))
+		{
+			DrainRingBuffer();
+			FPlatformProcess::Sleep(SubmixRecorder::WriterPollIntervalSeconds);
+		}
+
+		DrainRingBuffer();
+		FinalizeFile();
+		return 0;
+	}
+
+	void FMixerSubmixRecorder::Stop()
+	{
+		bStopRequested.store(true, std::memory_order_release);
+	}
+
+	void FMixerSubmixRecorder::DrainRingBuffer()
+	{
+		for (;;)
+		{
+			TArrayView<const float> Span = RingBuffer.AcquireRead(RingBuffer.GetCapacity());
+			if (Span.Num() == 0)
+			{
+				break;
+			}
+
+			WriteSamples(Span.GetData(), Span.Num());
+			RingBuffer.CommitRead(Span.Num());
+		}
+	}
+
+	void FMixerSubmixRecorder::WriteSamples(const float* InSamples, int32 InNumSamples)
+	{
+		if (bWriteFailed)
+		{
+			return;
+		}
+
+		switch (Settings.Format)
+		{
+		case ESubmixRecordingFormat::Float32:
+		{
+			FileWriter->Serialize(const_cast<float*>(InSamples), InNumSamples * sizeof(float));
+			NumDataBytes += InNumSamples * sizeof(float);
+		}
+		break;
+
+		case ESubmixRecordingFormat::Int16:
+		{
+			const FMixerKernels& Kernels = GetMixerKernels();
+			for (int32 Offset = 0; Offset < InNumSamples; Offset += Int16Buffer.Num())
+			{
+				const int32 NumToConvert = FMath::Min(Int16Buffer.Num(), InNumSamples - Offset);
+				Kernels.ConvertToInt16(InSamples + Offset, Int16Buffer.GetData(), NumToConvert, 1.0f, 0.0f, 0);
+				FileWriter->Serialize(Int16Buffer.GetData(), NumToConvert * sizeof(int16));
+				NumDataBytes += NumToConvert * sizeof(int16);
+			}
+		}
+		break;
+
+		case ESubmixRecordingFormat::ImaAdpcm:
+		{
+			// ADPCM is written in whole blocks, so stage samples until a block is full.
+			int32 Offset = 0;
+			while (Offset < InNumSamples)
+			{
+				const int32 NumToStage = FMath::Min(AdpcmBlockSamples.Num() - NumAdpcmBlockSamples, InNumSamples - Offset);
+				FMemory::Memcpy(AdpcmBlockSamples.GetData() + NumAdpcmBlockSamples, InSamples + Offset, NumToStage * sizeof(float));
+				NumAdpcmBlockSamples += NumToStage;
+				Offset += NumToStage;
+
+				if (NumAdpcmBlockSamples == AdpcmBlockSamples.Num())
+				{
+					WriteAdpcmBlock();
+				}
+			}
+		}
+		break;
+
+		default:
+			checkNoEntry();
+			break;
+		}
+
+		NumSamplesWritten.store(NumSamplesWritten.load(std::memory_order_relaxed) + InNumSamples, std::memory_order_relaxed);
+
+		if (FileWriter->IsError())
+		{
+			UE_LOG(LogAudioMixer, Error, TEXT("Failed to write submix recording to %s; discarding the rest of the recording."), *Settings.FilePath);
+			bWriteFailed = true;
+		}
+	}
+
+	void FMixerSubmixRecorder::WriteAdpcmBlock()
+	{
+		using namespace SubmixRecorder;
+
+		const int32 NumChannels = Settings.NumChannels;
+
+		// A partial final block is padded with silence; the fact chunk holds the real length.
+		FMemory::Memzero(AdpcmBlockSamples.GetData() + NumAdpcmBlockSamples, (AdpcmBlockSamples.Num() - NumAdpcmBlockSamples) * sizeof(float));
+		GetMixerKernels().ConvertToInt16(AdpcmBlockSamples.GetData(), Int16Buffer.GetData(), AdpcmBlockSamples.Num(), 1.0f, 0.0f, 0);
+
+		// Block header: the first sample of each channel stored verbatim, followed by the step index.
+		uint8* Out = AdpcmBlock.GetData();
+		for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+		{
+			const int16 FirstSample = Int16Buffer[Channel];
+			AdpcmPredictors[Channel] = FirstSample;
+
+			*Out++ = (uint8)(FirstSample & 0xFF);
+			*Out++ = (uint8)((FirstSample >> 8) & 0xFF);
+			*Out++ = (uint8)AdpcmStepIndices[Channel];
+			*Out++ = 0;
+		}
+
+		// The rest of the block interleaves 4 bytes (8 samples, low nibble first) per channel.
+		for (int32 FrameIndex = 1; FrameIndex < AdpcmSamplesPerBlock; FrameIndex += 8)
+		{
+			for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+			{
+				for (int32 BytePair = 0; BytePair < 8; BytePair += 2)
+				{
+					const int32 LowSample = Int16Buffer[(FrameIndex + BytePair) * NumChannels + Channel];
+					const int32 HighSample = Int16Buffer[(FrameIndex + BytePair + 1) * NumChannels + Channel];
+					const uint8 Low = EncodeAdpcmSample(LowSample, AdpcmPredictors[Channel], AdpcmStepIndices[Channel]);
+					const uint8 High = EncodeAdpcmSample(HighSample, AdpcmPredictors[Channel], AdpcmStepIndices[Channel]);
+					*Out++ = (uint8)(Low | (High << 4));
+				}
+			}
+		}
+
+		FileWriter->Serialize(AdpcmBlock.GetData(), AdpcmBlock.Num());
+		NumDataBytes += AdpcmBlock.Num();
+		NumAdpcmBlockSamples = 0;
+	}
+
+	void FMixerSubmixRecorder::WriteHeader(bool bFinal)
+	{
+		using namespace SubmixRecorder;
+
+		const int32 NumChannels = Settings.NumChannels;
+		const bool bIsAdpcm = Settings.Format == ESubmixRecordingFormat::ImaAdpcm;
+		const bool bIsFloat = Settings.Format == ESubmixRecordingFormat::Float32;
+
+		uint16 FormatTag = WaveFormatPcm;
+		uint16 BitsPerSample = 16;
+		if (bIsFloat)
+		{
+			FormatTag = WaveFormatIeeeFloat;
+			BitsPerSample = 32;
+		}
+		else if (bIsAdpcm)
+		{
+			FormatTag = WaveFormatImaAdpcm;
+			BitsPerSample = 4;
+		}
+
+		const uint16 BlockAlign = bIsAdpcm ? AdpcmBlockAlignPerChannel * NumChannels : NumChannels * BitsPerSample / 8;
+		const uint32 ByteRate = bIsAdpcm ? (uint32)((uint64)Settings.SampleRate * BlockAlign / AdpcmSamplesPerBlock) : Settings.SampleRate * BlockAlign;
+		const uint64 NumFrames = GetNumFramesWritten();
+
+		// Sizes are only known once the recording stops; RF64 is only needed if they don't fit in 32 bits.
+		const uint64 RiffSize = bFinal ? (uint64)HeaderSize - 8 + NumDataBytes : 0;
+		const bool bIsRf64 = RiffSize > MAX_uint32;
+
+		TArray<uint8> Header;
+		AppendTag(Header, bIsRf64 ? "RF64" : "RIFF");
+		AppendUInt32(Header, bIsRf64 ? MAX_uint32 : (uint32)RiffSize);
+		AppendTag(Header, "WAVE");
+
+		// Reserved for a ds64 chunk, which readers of plain WAV files skip as JUNK.
+		AppendTag(Header, bIsRf64 ? "ds64" : "JUNK");
+		AppendUInt32(Header, Ds64ChunkSize);
+		AppendUInt64(Header, bIsRf64 ? RiffSize : 0);
+		AppendUInt64(Header, bIsRf64 ? NumDataBytes : 0);
+		AppendUInt64(Header, bIsRf64 ? NumFrames : 0);
+		AppendUInt32(Header, 0);
+
+		AppendTag(Header, "fmt ");
+		AppendUInt32(Header, bIsAdpcm ? 20 : (bIsFloat ? 18 : 16));
+		AppendUInt16(Header, FormatTag);
+		AppendUInt16(Header, (uint16)NumChannels);
+		AppendUInt32(Header, Settings.SampleRate);
+		AppendUInt32(Header, ByteRate);
+		AppendUInt16(Header, BlockAlign);
+		AppendUInt16(Header, BitsPerSample);
+		if (bIsAdpcm)
+		{
+			AppendUInt16(Header, 2);
+			AppendUInt16(Header, (uint16)AdpcmSamplesPerBlock);
+		}
+		else if (bIsFloat)
+		{
+			AppendUInt16(Header, 0);
+		}
+
+		// Formats other than integer PCM need a fact chunk with the length in frames.
+		if (FormatTag != WaveFormatPcm)
+		{
+			AppendTag(Header, "fact");
+			AppendUInt32(Header, 4);
+			AppendUInt32(Header, bIsRf64 ? MAX_uint32 : (uint32)NumFrames);
+		}
+
+		AppendTag(Header, "data");
+		AppendUInt32(Header, bIsRf64 ? MAX_uint32 : (uint32)NumDataBytes);
+
+		if (bFinal)
+		{
+			check(Header.Num() == HeaderSize);
+			FileWriter->Seek(0);
+		}
+		else
+		{
+			HeaderSize = Header.Num();
+		}
+
+		FileWriter->Serialize(Header.GetData(), Header.Num());
+	}
+
+	void FMixerSubmixRecorder::FinalizeFile()
+	{
+		if (!FileWriter)
+		{
+			return;
+		}
+
+		if (!bWriteFailed && Settings.Format == ESubmixRecordingFormat::ImaAdpcm && NumAdpcmBlockSamples > 0)
+		{
+			WriteAdpcmBlock();
+		}
+
+		if (!bWriteFailed)
+		{
+			WriteHeader(true);
+		}
+
+		FileWriter->Close();
+		delete FileWriter;
+		FileWriter = nullptr;
+	}
+}
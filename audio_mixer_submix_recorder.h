@@ -0,0 +1,152 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "DSP/BufferVectorOperations.h"
+#include "spsc_circular_buffer.h"
+#include <atomic>
+
+class FArchive;
+
+namespace Audio
+{
+	/** Sample format of a streaming submix recording. */
+	enum class ESubmixRecordingFormat : uint8
+	{
+		/** 32 bit float PCM, bit exact with the submix output. */
+		Float32,
+
+		/** 16 bit PCM. */
+		Int16,
+
+		/** 4 bit IMA ADPCM, a quarter the size of 16 bit PCM. */
+		ImaAdpcm
+	};
+
+	/** Settings of a streaming submix recording. */
+	struct FSubmixRecorderSettings
+	{
+		/** The .wav file to write. Recordings that outgrow 4 GB are finalized as RF64. */
+		FString FilePath;
+
+		int32 NumChannels = 0;
+		int32 SampleRate = 0;
+
+		ESubmixRecordingFormat Format = ESubmixRecordingFormat::Float32;
+
+		/** Audio the ring buffer holds before blocks are dropped, in seconds. This is all the memory a recording uses. */
+		float RingBufferSeconds = 2.0f;
+
+		/**
+		 * Makes PushAudio wait for the writer when the ring is full instead of dropping the block. Only for producers
+		 * that may block, such as offline renders; never set it for recordings fed by the audio render thread.
+		 */
+		bool bWaitWhenFull = false;
+	};
+
+	/**
+	 * Streams submix output to a WAV file on a background thread.
+	 *
+	 * The audio render thread copies each block into a ring buffer that is allocated when the
+	 * recording starts; it never locks, allocates or touches the file. A writer thread drains
+	 * the ring, converts or encodes the audio and writes it through a buffered file writer,
+	 * then patches the header sizes when the recording stops. Memory use therefore doesn't
+	 * grow with the length of the recording. If the writer falls behind far enough to fill the
+	 * ring, whole blocks are dropped and counted.
+	 */
+	class FMixerSubmixRecorder : public FRunnable
+	{
+	public:
+		FMixerSubmixRecorder();
+		virtual ~FMixerSubmixRecorder();
+
+		/** Opens the file and starts the writer thread. Returns false if already recording or the file can't be opened. */
+		bool StartRecording(const FSubmixRecorderSettings& InSettings);
+
+		/** Stops accepting audio, writes out what is buffered, finalizes the file and joins the writer thread. */
+		void StopRecording();
+
+		/**
+		 * Reads the audio of the last finished Float32 recording back from its file. For callers that want the
+		 * recording in memory; call it after StopRecording, off the audio render thread.
+		 */
+		bool ReadRecording(AlignedFloatBuffer& OutSamples) const;
+
+		/** Whether audio pushed now would be recorded. */
+		bool IsRecording() const
+		{
+			return bIsAcceptingAudio.load(std::memory_order_relaxed);
+		}
+
+		/**
+		 * Queues a block of interleaved audio. Never allocates, and never blocks unless bWaitWhenFull is set.
+		 * Drops the whole block if the ring is full or the channel count changed since the recording started.
+		 */
+		void PushAudio(const float* InAudio, int32 InNumSamples, int32 InNumChannels);
+
+		/** Blocks dropped because the writer fell behind or the channel count changed. */
+		uint64 GetNumDroppedBlocks() const { return NumDroppedBlocks.load(std::memory_order_relaxed); }
+
+		/** Samples in the dropped blocks. */
+		uint64 GetNumDroppedSamples() const { return NumDroppedSamples.load(std::memory_order_relaxed); }
+
+		/** Frames written to the file so far. */
+		uint64 GetNumFramesWritten() const { return NumSamplesWritten.load(std::memory_order_relaxed) / FMath::Max(Settings.NumChannels, 1); }
+
+		//~ Begin FRunnable
+		virtual uint32 Run() override;
+		virtual void Stop() override;
+		//~ End FRunnable
+
+	private:
+		/** Writes everything currently in the ring. Writer thread only. */
+		void DrainRingBuffer();
+
+		/** Converts or encodes samples and writes them to the file. Writer thread only. */
+		void WriteSamples(const float* InSamples, int32 InNumSamples);
+
+		/** Encodes and writes the staged ADPCM block. Writer thread only. */
+		void WriteAdpcmBlock();
+
+		/** Writes the header, patched with the final sizes when bFinal is set. */
+		void WriteHeader(bool bFinal);
+
+		/** Writes the final header and closes the file. */
+		void FinalizeFile();
+
+		FSubmixRecorderSettings Settings;
+
+		/** Render thread to writer thread. */
+		TSpscCircularBuffer<float> RingBuffer;
+
+		/** Staging for converted or encoded samples, allocated with the recording. */
+		TArray<int16> Int16Buffer;
+		TArray<float> AdpcmBlockSamples;
+		TArray<uint8> AdpcmBlock;
+		int32 NumAdpcmBlockSamples;
+
+		/** ADPCM encoder state per channel. */
+		TArray<int32> AdpcmPredictors;
+		TArray<int32> AdpcmStepIndices;
+
+		FArchive* FileWriter;
+		FRunnableThread* Thread;
+
+		/** Size of the header and the offset of the audio data in the file. */
+		int64 HeaderSize;
+
+		/** Bytes of audio data written, excluding any ADPCM block still being staged. */
+		uint64 NumDataBytes;
+
+		bool bWriteFailed;
+
+		std::atomic<bool> bIsAcceptingAudio;
+		std::atomic<bool> bIsPushing;
+		std::atomic<bool> bStopRequested;
+
+		std::atomic<uint64> NumDroppedBlocks;
+		std::atomic<uint64> NumDroppedSamples;
+		std::atomic<uint64> NumSamplesWritten;
+	};
+}
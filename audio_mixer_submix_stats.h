@@ -0,0 +1,39 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+namespace Audio
+{
+	/**
+	 * Counts the work a submix skipped because its audio was silent.
+	 *
+	 * Only the audio render thread writes the counters, so increments are a plain load and store
+	 * rather than a locked read-modify-write. Any thread can read them.
+	 */
+	struct FMixerSubmixSilenceCounters
+	{
+		/** Blocks whose output was silent and was not mixed into the parent. */
+		std::atomic<uint32> NumSilentBlocks { 0 };
+
+		/** Blocks where the effect chains were not run because the input was silent and their tail had decayed. */
+		std::atomic<uint32> NumEffectBlocksSkipped { 0 };
+
+		/** Wet, dry and output gain stages that were not applied because the buffer was silent. */
+		std::atomic<uint32> NumGainStagesSkipped { 0 };
+
+		/** Increments a counter. Audio render thread only. */
+		static void Increment(std::atomic<uint32>& Counter)
+		{
+			Counter.store(Counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+
+		/** Not synchronized with the render thread, so an increment racing the reset may survive it. */
+		void Reset()
+		{
+			NumSilentBlocks.store(0, std::memory_order_relaxed);
+			NumEffectBlocksSkipped.store(0, std::memory_order_relaxed);
+			NumGainStagesSkipped.store(0, std::memory_order_relaxed);
+		}
+	};
+}
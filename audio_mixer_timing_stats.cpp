@@ -0,0 +1,197 @@
+#include "audio_mixer_timing_stats.h"
+#include "AudioMixerLog.h"
+#include "HAL/PlatformProcess.h"
+
+static int32 SubmixTimingStatsSharedMemoryCVar = 0;
+FAutoConsoleVariableRef CVarSubmixTimingStatsSharedMemory(
+	TEXT("au.Submix.TimingStats.SharedMemory"),
+	SubmixTimingStatsSharedMemoryCVar,
+	TEXT("Places the submix timing stats in a named shared memory region (AudioMixerStats_<process id>) that external tools can poll.\n")
+	TEXT("Read when the stats are first used. 0: Process memory (default), 1: Shared memory."),
+	ECVF_Default);
+
+static int32 SubmixTimingStatsMaxEntriesCVar = 256;
+FAutoConsoleVariableRef CVarSubmixTimingStatsMaxEntries(
+	TEXT("au.Submix.TimingStats.MaxEntries"),
+	SubmixTimingStatsMaxEntriesCVar,
+	TEXT("Number of submixes and submix effects that can be timed at once. Read when the stats are first used (default: 256)."),
+	ECVF_Default);
+
+namespace Audio
+{
+	uint64 FMixerCycleHistogram::GetPercentile(double InPercentile) const
+	{
+		const uint64 NumValues = Count.load(std::memory_order_acquire);
+		if (NumValues == 0)
+		{
+			return 0;
+		}
+
+		// Nearest rank, so the 100th percentile is the bucket of the largest value.
+		const uint64 Rank = FMath::Max<uint64>((uint64)FMath::CeilToDouble(FMath::Clamp(InPercentile, 0.0, 100.0) / 100.0 * NumValues), 1);
+
+		uint64 NumCounted = 0;
+		for (int32 BucketIndex = 0; BucketIndex < NumBuckets; ++BucketIndex)
+		{
+			NumCounted += Buckets[BucketIndex].load(std::memory_order_relaxed);
+			if (NumCounted >= Rank)
+			{
+				return GetBucketLowerBound(BucketIndex);
+			}
+		}
+
+		// Buckets were written after Count was read, so the rank lies among the values recorded since.
+		return MaxCycles.load(std::memory_order_relaxed);
+	}
+
+	void FMixerCycleHistogram::Reset()
+	{
+		Count.store(0, std::memory_order_relaxed);
+		TotalCycles.store(0, std::memory_order_relaxed);
+		MaxCycles.store(0, std::memory_order_relaxed);
+		for (std::atomic<uint64>& Bucket : Buckets)
+		{
+			Bucket.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	FMixerStatsRegistry& FMixerStatsRegistry::Get()
+	{
+		static FMixerStatsRegistry Registry;
+		return Registry;
+	}
+
+	FMixerStatsRegistry::FMixerStatsRegistry()
+		: SharedMemoryRegion(nullptr)
+		, ProcessMemory(nullptr)
+		, Header(nullptr)
+		, Entries(nullptr)
+		, MaxEntries(FMath::Max(SubmixTimingStatsMaxEntriesCVar, 1))
+	{
+		const SIZE_T HeaderSize = Align(sizeof(FMixerStatsHeader), alignof(FMixerStatsEntry));
+		const SIZE_T RegionSize = HeaderSize + sizeof(FMixerStatsEntry) * MaxEntries;
+
+		void* Memory = nullptr;
+		if (SubmixTimingStatsSharedMemoryCVar)
+		{
+			const FString RegionName = FString::Printf(TEXT("AudioMixerStats_%u"), FPlatformProcess::GetCurrentProcessId());
+			SharedMemoryRegion = FPlatformMemory::MapNamedSharedMemoryRegion(RegionName, true, FPlatformMemory::ESharedMemoryAccess::Read | FPlatformMemory::ESharedMemoryAccess::Write, RegionSize);
+			if (SharedMemoryRegion)
+			{
+				SharedMemoryName = RegionName;
+				Memory = SharedMemoryRegion->GetAddress();
+			}
+			else
+			{
+				UE_LOG(LogAudioMixer, Warning, TEXT("Failed to map shared memory region %s for submix timing stats, keeping them in process memory."), *RegionName);
+			}
+		}
+
+		if (!Memory)
+		{
+			ProcessMemory = FMemory::Malloc(RegionSize, alignof(FMixerStatsEntry));
+			Memory = ProcessMemory;
+		}
+
+		FMemory::Memzero(Memory, RegionSize);
+
+		Header = new (Memory) FMixerStatsHeader();
+		Entries = reinterpret_cast<FMixerStatsEntry*>((uint8*)Memory + HeaderSize);
+
+		for (int32 EntryIndex = 0; EntryIndex < MaxEntries; ++EntryIndex)
+		{
+			FMixerStatsEntry* Entry = new (&Entries[EntryIndex]) FMixerStatsEntry();
+			Entry->Kind.store((uint32)EMixerStatsEntryKind::Free, std::memory_order_relaxed);
+			Entry->Histogram.Reset();
+			Entry->LockWaits.Reset();
+		}
+
+		Header->Version = FMixerStatsHeader::CurrentVersion;
+		Header->HeaderSize = (uint32)HeaderSize;
+		Header->EntrySize = (uint32)sizeof(FMixerStatsEntry);
+		Header->MaxEntries = (uint32)MaxEntries;
+		Header->NumBuckets = (uint32)FMixerCycleHistogram::NumBuckets;
+		Header->SubBucketBits = (uint32)FMixerCycleHistogram::SubBucketBits;
+		Header->MaxValueBits = (uint32)FMixerCycleHistogram::MaxValueBits;
+		Header->CyclesPerSecond = 1.0 / FPlatformTime::GetSecondsPerCycle64();
+		Header->Magic.store(FMixerStatsHeader::MagicValue, std::memory_order_release);
+	}
+
+	FMixerStatsRegistry::~FMixerStatsRegistry()
+	{
+		// The entries are plain atomics, so the memory can go without running their destructors.
+		if (SharedMemoryRegion)
+		{
+			FPlatformMemory::UnmapNamedSharedMemoryRegion(SharedMemoryRegion);
+			SharedMemoryRegion = nullptr;
+		}
+
+		if (ProcessMemory)
+		{
+			FMemory::Free(ProcessMemory);
+			ProcessMemory = nullptr;
+		}
+	}
+
+	FMixerStatsEntry* FMixerStatsRegistry::AcquireEntry(EMixerStatsEntryKind InKind, const FString& InName)
+	{
+		check(InKind != EMixerStatsEntryKind::Free && InKind != EMixerStatsEntryKind::Claiming);
+
+		for (int32 EntryIndex = 0; EntryIndex < MaxEntries; ++EntryIndex)
+		{
+			FMixerStatsEntry& Entry = Entries[EntryIndex];
+
+			uint32 Expected = (uint32)EMixerStatsEntryKind::Free;
+			if (Entry.Kind.load(std::memory_order_relaxed) != Expected || !Entry.Kind.compare_exchange_strong(Expected, (uint32)EMixerStatsEntryKind::Claiming, std::memory_order_acquire))
+			{
+				continue;
+			}
+
+			Entry.Histogram.Reset();
+			Entry.LockWaits.Reset();
+			FCStringAnsi::Strncpy(Entry.Name, TCHAR_TO_UTF8(*InName), FMixerStatsEntry::MaxNameLength);
+
+			Entry.Kind.store((uint32)InKind, std::memory_order_release);
+			return &Entry;
+		}
+
+		return nullptr;
+	}
+
+	void FMixerStatsRegistry::ReleaseEntry(FMixerStatsEntry* InEntry)
+	{
+		if (InEntry)
+		{
+			check(InEntry >= Entries && InEntry < Entries + MaxEntries);
+			InEntry->Kind.store((uint32)EMixerStatsEntryKind::Free, std::memory_order_release);
+		}
+	}
+
+	FMixerTimedScopeLock::FMixerTimedScopeLock(FCriticalSection* InCriticalSection, FMixerLockWaitCounters* InCounters)
+		: CriticalSection(InCriticalSection)
+	{
+		// Uncontended locks cost the same as a plain FScopeLock; only waits are timed.
+		if (!CriticalSection->TryLock())
+		{
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			CriticalSection->Lock();
+
+			if (InCounters)
+			{
+				const uint64 WaitCycles = FPlatformTime::Cycles64() - StartCycles;
+				InCounters->NumContended.store(InCounters->NumContended.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+				InCounters->WaitCycles.store(InCounters->WaitCycles.load(std::memory_order_relaxed) + WaitCycles, std::memory_order_relaxed);
+			}
+		}
+
+		if (InCounters)
+		{
+			InCounters->NumAcquisitions.store(InCounters->NumAcquisitions.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+	}
+
+	FMixerTimedScopeLock::~FMixerTimedScopeLock()
+	{
+		CriticalSection->Unlock();
+	}
+}
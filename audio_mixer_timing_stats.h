@@ -0,0 +1,230 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformTime.h"
+#include <atomic>
+
+/** Number of effects per submix chain that get their own timing entry. */
+#define AUDIO_MIXER_MAX_TIMED_SUBMIX_EFFECTS 16
+
+namespace Audio
+{
+	/**
+	 * High dynamic range histogram of cycle counts.
+	 *
+	 * Values below 2 * SubBucketCount get a bucket each; above that every power of two is split
+	 * into SubBucketCount buckets, so any recorded value is known to within 1 / SubBucketCount
+	 * (about 3%) with a fixed, small footprint. All counters are atomics written by a single
+	 * thread at a time, which makes the histogram safe to place in shared memory and to read
+	 * from anywhere while it is being recorded into.
+	 */
+	struct FMixerCycleHistogram
+	{
+		static constexpr int32 SubBucketBits = 5;
+		static constexpr int32 SubBucketCount = 1 << SubBucketBits;
+
+		/** Values are clamped to this many bits, minutes of cycles on any current CPU. */
+		static constexpr int32 MaxValueBits = 40;
+
+		static constexpr int32 NumBuckets = (MaxValueBits - SubBucketBits + 1) * SubBucketCount;
+
+		std::atomic<uint64> Count;
+		std::atomic<uint64> TotalCycles;
+		std::atomic<uint64> MaxCycles;
+		std::atomic<uint64> Buckets[NumBuckets];
+
+		/** Returns the bucket a value is counted in. */
+		static int32 GetBucketIndex(uint64 InCycles)
+		{
+			InCycles = FMath::Min<uint64>(InCycles, (1ull << MaxValueBits) - 1);
+			if (InCycles < 2 * SubBucketCount)
+			{
+				return (int32)InCycles;
+			}
+
+			const int32 Shift = (int32)FMath::FloorLog2_64(InCycles) - SubBucketBits;
+			return (Shift + 1) * SubBucketCount + (int32)((InCycles >> Shift) - SubBucketCount);
+		}
+
+		/** Returns the smallest value counted in a bucket. */
+		static uint64 GetBucketLowerBound(int32 InBucketIndex)
+		{
+			if (InBucketIndex < 2 * SubBucketCount)
+			{
+				return (uint64)InBucketIndex;
+			}
+
+			const int32 Shift = InBucketIndex / SubBucketCount - 1;
+			return (uint64)(InBucketIndex % SubBucketCount + SubBucketCount) << Shift;
+		}
+
+		/** Records a value. Only one thread may record at a time. */
+		void Record(uint64 InCycles)
+		{
+			std::atomic<uint64>& Bucket = Buckets[GetBucketIndex(InCycles)];
+			Bucket.store(Bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			TotalCycles.store(TotalCycles.load(std::memory_order_relaxed) + InCycles, std::memory_order_relaxed);
+			if (InCycles > MaxCycles.load(std::memory_order_relaxed))
+			{
+				MaxCycles.store(InCycles, std::memory_order_relaxed);
+			}
+
+			// Count last, so a reader never sees more values counted than are in the buckets.
+			Count.store(Count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		/** Returns the lower bound of the bucket holding the given percentile (0 to 100). Any thread. */
+		uint64 GetPercentile(double InPercentile) const;
+
+		/** Clears the histogram. Not to be called while it is being recorded into. */
+		void Reset();
+	};
+
+	/** Counts how often a lock was taken and how long its holders made the render thread wait. */
+	struct FMixerLockWaitCounters
+	{
+		std::atomic<uint64> NumAcquisitions;
+		std::atomic<uint64> NumContended;
+		std::atomic<uint64> WaitCycles;
+
+		void Reset()
+		{
+			NumAcquisitions.store(0, std::memory_order_relaxed);
+			NumContended.store(0, std::memory_order_relaxed);
+			WaitCycles.store(0, std::memory_order_relaxed);
+		}
+	};
+
+	/** What a stats entry measures. */
+	enum class EMixerStatsEntryKind : uint32
+	{
+		/** The entry is unused. */
+		Free,
+
+		/** The entry is being claimed and not yet readable. */
+		Claiming,
+
+		/** Render time of one submix, excluding its children. */
+		Submix,
+
+		/** Render time of one submix effect. */
+		Effect
+	};
+
+	/** One timed thing in the stats surface. Cache line aligned, so recording into one entry never contends with another. */
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FMixerStatsEntry
+	{
+		static constexpr int32 MaxNameLength = 64;
+
+		/**
+		 * An EMixerStatsEntryKind. Readers skip entries that are Free or Claiming, and should check
+		 * that it is unchanged after reading an entry, since a released entry may be reclaimed and reset.
+		 */
+		std::atomic<uint32> Kind;
+
+		/** UTF-8, null terminated. */
+		char Name[MaxNameLength];
+
+		FMixerCycleHistogram Histogram;
+		FMixerLockWaitCounters LockWaits;
+	};
+
+	/**
+	 * Start of the stats surface. An external tool maps the region named by
+	 * FMixerStatsRegistry::GetSharedMemoryName, checks Magic and Version, and reads MaxEntries
+	 * FMixerStatsEntry structs, starting HeaderSize bytes into the region, whenever it likes.
+	 * Magic is written last, so a region whose Magic matches is fully initialized.
+	 */
+	struct FMixerStatsHeader
+	{
+		static constexpr uint32 MagicValue = 0x5841554D; // "MUAX"
+		static constexpr uint32 CurrentVersion = 1;
+
+		std::atomic<uint32> Magic;
+		uint32 Version;
+		/** Offset of the first entry, a multiple of the entry alignment. */
+		uint32 HeaderSize;
+		uint32 EntrySize;
+		uint32 MaxEntries;
+		uint32 NumBuckets;
+		uint32 SubBucketBits;
+		uint32 MaxValueBits;
+
+		/** Converts the recorded cycle counts to seconds. */
+		double CyclesPerSecond;
+	};
+
+	/**
+	 * Owner of the per-submix and per-effect timing entries.
+	 *
+	 * The entries are allocated once, in a named shared memory region when
+	 * au.Submix.TimingStats.SharedMemory is set (so tools can poll them without touching the audio
+	 * threads), or in process memory otherwise. Acquiring and releasing an entry is lock-free and
+	 * doesn't allocate. Submixes claim their entries, and build their names, off the render thread.
+	 */
+	class FMixerStatsRegistry
+	{
+	public:
+		static FMixerStatsRegistry& Get();
+
+		~FMixerStatsRegistry();
+
+		/** Claims a free entry and resets it. Returns nullptr when all entries are in use. */
+		FMixerStatsEntry* AcquireEntry(EMixerStatsEntryKind InKind, const FString& InName);
+
+		/** Returns an entry to the pool. The owner must have stopped recording into it. */
+		void ReleaseEntry(FMixerStatsEntry* InEntry);
+
+		/** Name of the shared memory region, or an empty string if the entries live in process memory. */
+		const FString& GetSharedMemoryName() const { return SharedMemoryName; }
+
+		int32 GetMaxEntries() const { return MaxEntries; }
+		const FMixerStatsEntry& GetEntry(int32 InIndex) const { return Entries[InIndex]; }
+
+	private:
+		FMixerStatsRegistry();
+
+		FString SharedMemoryName;
+		FPlatformMemory::FSharedMemoryRegion* SharedMemoryRegion;
+		void* ProcessMemory;
+
+		FMixerStatsHeader* Header;
+		FMixerStatsEntry* Entries;
+		int32 MaxEntries;
+	};
+
+	/** Records the cycles spent in a scope into a histogram, if there is one. */
+	class FMixerScopeCycleCounter
+	{
+	public:
+		explicit FMixerScopeCycleCounter(FMixerCycleHistogram* InHistogram)
+			: Histogram(InHistogram)
+			, StartCycles(InHistogram ? FPlatformTime::Cycles64() : 0)
+		{
+		}
+
+		~FMixerScopeCycleCounter()
+		{
+			if (Histogram)
+			{
+				Histogram->Record(FPlatformTime::Cycles64() - StartCycles);
+			}
+		}
+
+	private:
+		FMixerCycleHistogram* Histogram;
+		uint64 StartCycles;
+	};
+
+	/** Scope lock that counts acquisitions and, when the lock is contended, the cycles spent waiting for it. */
+	class FMixerTimedScopeLock
+	{
+	public:
+		FMixerTimedScopeLock(FCriticalSection* InCriticalSection, FMixerLockWaitCounters* InCounters);
+		~FMixerTimedScopeLock();
+
+	private:
+		FCriticalSection* CriticalSection;
+	};
+}
@@ -0,0 +1,225 @@
+#include "audio_mixer_voice_audibility.h"
+
+static float VoiceVirtualizeThresholdCVar = 0.0001f;
+FAutoConsoleVariableRef CVarVoiceVirtualizeThreshold(
+	TEXT("au.Voice.VirtualizeThreshold"),
+	VoiceVirtualizeThresholdCVar,
+	TEXT("Estimated output level (send gain times recent peak) below which a voice is virtualized (default: 0.0001, -80 dB)."),
+	ECVF_Default);
+
+static int32 VoiceMaxRealVoicesCVar = 0;
+FAutoConsoleVariableRef CVarVoiceMaxRealVoices(
+	TEXT("au.Voice.MaxRealVoices"),
+	VoiceMaxRealVoicesCVar,
+	TEXT("Most voices that render at once; the quietest voices beyond it are virtualized.\n")
+	TEXT("0: No budget, only the threshold applies (default)."),
+	ECVF_Default);
+
+static float VoiceVirtualizeHysteresisCVar = 2.0f;
+FAutoConsoleVariableRef CVarVoiceVirtualizeHysteresis(
+	TEXT("au.Voice.VirtualizeHysteresis"),
+	VoiceVirtualizeHysteresisCVar,
+	TEXT("Factor real voices are ranked louder by than virtual ones, so voices near the threshold or the budget don't flap (default: 2, 6 dB)."),
+	ECVF_Default);
+
+static int32 VoiceVirtualProbeIntervalCVar = 24;
+FAutoConsoleVariableRef CVarVoiceVirtualProbeInterval(
+	TEXT("au.Voice.VirtualProbeInterval"),
+	VoiceVirtualProbeIntervalCVar,
+	TEXT("Blocks a voice stays virtual before it renders again to re-measure its level, so voices that get louder while virtual, e.g. after a pause, come back (default: 24).\n")
+	TEXT("Each voice probes at a different offset within the interval, so voices virtualized together don't probe together."),
+	ECVF_Default);
+
+static float VoiceVirtualizeFadeMsCVar = 5.0f;
+FAutoConsoleVariableRef CVarVoiceVirtualizeFadeMs(
+	TEXT("au.Voice.VirtualizeFadeMs"),
+	VoiceVirtualizeFadeMsCVar,
+	TEXT("Length of the fade out before a voice goes virtual, and of the fade in when it becomes real again, in milliseconds (default: 5).\n")
+	TEXT("Fades are at most one block long. 0: Switch at once, which may click."),
+	ECVF_Default);
+
+namespace Audio
+{
+	namespace VoiceAudibility
+	{
+		/** Blocks a new voice renders before it can be virtualized, and a resumed one before its envelope is trusted again. */
+		static const int32 NumWarmupUpdates = 2;
+	}
+
+	FMixerVoiceAudibility::FMixerVoiceAudibility()
+		: UpdateIndex(0)
+		, bFadeTransitions(false)
+	{
+	}
+
+	int32 FMixerVoiceAudibility::GetNumFadeFrames(int32 InNumFrames, float InSampleRate)
+	{
+		return FMath::Clamp(FMath::RoundToInt(VoiceVirtualizeFadeMsCVar * InSampleRate / 1000.0f), 1, FMath::Max(InNumFrames, 1));
+	}
+
+	void FMixerVoiceAudibility::Init(int32 InMaxSources)
+	{
+		States.Reset();
+		States.AddZeroed(InMaxSources);
+
+		RankedVoices.Reset(InMaxSources);
+		VirtualizedVoices.Reset(InMaxSources);
+		RealizedVoices.Reset(InMaxSources);
+
+		// Nothing has been seen in the current update, so every voice reads as real.
+		UpdateIndex = 1;
+	}
+
+	void FMixerVoiceAudibility::SetVirtual(FVoiceState& InState, int32 InSourceId, bool bInIsVirtual)
+	{
+		if (!bInIsVirtual && !InState.bIsVirtual)
+		{
+			// A voice that faded out but ranks audible again fades back in without ever going virtual.
+			if (InState.bIsFadedOut)
+			{
+				InState.bIsFadedOut = false;
+				InState.Fade = EMixerVoiceFade::In;
+			}
+			else if (InState.Fade == EMixerVoiceFade::Out)
+			{
+				InState.Fade = EMixerVoiceFade::None;
+			}
+			return;
+		}
+
+		if (bInIsVirtual == InState.bIsVirtual)
+		{
+			return;
+		}
+
+		if (bInIsVirtual)
+		{
+			// Render one more block, fading out, and only go virtual if the voice still ranks inaudible after it.
+			if (bFadeTransitions && !InState.bIsFadedOut)
+			{
+				InState.Fade = EMixerVoiceFade::Out;
+				return;
+			}
+
+			InState.bIsVirtual = true;
+			InState.bIsFadedOut = false;
+			InState.Fade = EMixerVoiceFade::None;
+			InState.NumVirtualUpdates = 0;
+			VirtualizedVoices.Add(InSourceId);
+			FMixerVoiceCounters::Increment(Counters.NumVirtualizations);
+		}
+		else
+		{
+			// The voice's envelope follower decayed while nothing rendered, so it warms up again before it replaces the held envelope.
+			InState.bIsVirtual = false;
+			InState.Fade = bFadeTransitions ? EMixerVoiceFade::In : EMixerVoiceFade::None;
+			InState.NumRealUpdates = 0;
+			RealizedVoices.Add(InSourceId);
+			FMixerVoiceCounters::Increment(Counters.NumRealizations);
+		}
+	}
+
+	void FMixerVoiceAudibility::Update(TArrayView<const FMixerVoiceAudibilityInput> InVoices, bool bInAllowVirtualization, float InBudgetScale)
+	{
+		using namespace VoiceAudibility;
+
+		VirtualizedVoices.Reset();
+		RealizedVoices.Reset();
+		RankedVoices.Reset();
+		++UpdateIndex;
+
+		const float Threshold = FMath::Max(VoiceVirtualizeThresholdCVar, 0.0f);
+		const float Hysteresis = FMath::Max(VoiceVirtualizeHysteresisCVar, 1.0f);
+		const int32 ProbeInterval = FMath::Max(VoiceVirtualProbeIntervalCVar, 1);
+		bFadeTransitions = VoiceVirtualizeFadeMsCVar > 0.0f;
+
+		int32 NumPinnedVoices = 0;
+		int32 NumFadingVoices = 0;
+		for (const FMixerVoiceAudibilityInput& Voice : InVoices)
+		{
+			check(Voice.SourceId >= 0 && Voice.SourceId < States.Num());
+			FVoiceState& State = States[Voice.SourceId];
+
+			// A new voice may reuse the id of one that stopped while virtual; it has no decoder to resume.
+			if (Voice.bIsNew || State.LastSeenUpdate != UpdateIndex - 1)
+			{
+				State.HeldEnvelope = 0.0f;
+				State.NumRealUpdates = 0;
+				State.bIsMeasured = false;
+				State.bIsVirtual = false;
+				State.Fade = EMixerVoiceFade::None;
+			}
+			State.LastSeenUpdate = UpdateIndex;
+
+			// Fades last one block. A voice that rendered its fade out stays silent until it goes virtual or fades in below.
+			State.bIsFadedOut = State.Fade == EMixerVoiceFade::Out;
+			State.Fade = EMixerVoiceFade::None;
+
+			// A virtual voice renders nothing, so its held envelope can't tell when it gets louder. Render it again
+			// for the warm-up length every so often, and rank it by what it plays now.
+			if (State.bIsVirtual && ++State.NumVirtualUpdates >= ProbeInterval + Voice.SourceId % ProbeInterval)
+			{
+				SetVirtual(State, Voice.SourceId, false);
+				State.HeldEnvelope = 0.0f;
+				State.bIsMeasured = false;
+				FMixerVoiceCounters::Increment(Counters.NumProbes);
+			}
+
+			if (!State.bIsVirtual)
+			{
+				// While warming up, the envelope may still be rising from the silence before the voice (re)started.
+				State.NumRealUpdates = FMath::Min(State.NumRealUpdates + 1, NumWarmupUpdates + 1);
+				State.HeldEnvelope = State.NumRealUpdates <= NumWarmupUpdates ? FMath::Max(State.HeldEnvelope, Voice.Envelope) : Voice.Envelope;
+				State.bIsMeasured |= State.NumRealUpdates > NumWarmupUpdates;
+			}
+
+			// Voices that haven't been measured yet have nothing to rank by.
+			if (!bInAllowVirtualization || Voice.bAlwaysReal || !State.bIsMeasured)
+			{
+				SetVirtual(State, Voice.SourceId, false);
+				++NumPinnedVoices;
+				continue;
+			}
+
+			const float Level = Voice.Gain * State.HeldEnvelope;
+			const float Score = State.bIsVirtual ? Level : Level * Hysteresis;
+			if (Score < Threshold)
+			{
+				SetVirtual(State, Voice.SourceId, true);
+				NumFadingVoices += State.Fade == EMixerVoiceFade::Out ? 1 : 0;
+				continue;
+			}
+
+			RankedVoices.Add({ Score, Voice.SourceId });
+		}
+
+		// Pinned voices always render, so they take their share of the budget first.
+		int32 NumRealSlots = RankedVoices.Num();
+		if (bInAllowVirtualization && VoiceMaxRealVoicesCVar > 0)
+		{
+			const int32 Budget = FMath::Max(FMath::RoundToInt(VoiceMaxRealVoicesCVar * InBudgetScale), 1);
+			NumRealSlots = FMath::Clamp(Budget - NumPinnedVoices, 0, RankedVoices.Num());
+		}
+
+		if (NumRealSlots < RankedVoices.Num())
+		{
+			// Loudest first; ties go by source id so the choice is stable from block to block.
+			RankedVoices.Sort([](const FRankedVoice& A, const FRankedVoice& B)
+			{
+				return A.Score != B.Score ? A.Score > B.Score : A.SourceId < B.SourceId;
+			});
+		}
+
+		for (int32 RankIndex = 0; RankIndex < RankedVoices.Num(); ++RankIndex)
+		{
+			const int32 SourceId = RankedVoices[RankIndex].SourceId;
+			SetVirtual(States[SourceId], SourceId, RankIndex >= NumRealSlots);
+			NumFadingVoices += RankIndex >= NumRealSlots && States[SourceId].Fade == EMixerVoiceFade::Out ? 1 : 0;
+		}
+
+		const int32 NumRealVoices = NumPinnedVoices + NumRealSlots + NumFadingVoices;
+		const int32 NumVirtualVoices = InVoices.Num() - NumRealVoices;
+		Counters.NumRealVoices.store(NumRealVoices, std::memory_order_relaxed);
+		Counters.NumVirtualVoices.store(NumVirtualVoices, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+namespace Audio
+{
+	/** What the audibility pass knows about a playing voice at the start of a block. */
+	struct FMixerVoiceAudibilityInput
+	{
+		int32 SourceId;
+
+		/** Gain the voice is mixed with: its volume after distance attenuation, times its largest submix send level. */
+		float Gain;
+
+		/** Peak envelope of the voice's recent output. Only read while the voice is real, as a virtual voice renders nothing to measure. */
+		float Envelope;
+
+		/** Set in the first block the voice plays. */
+		bool bIsNew;
+
+		/** Set for voices that must always render, e.g. UI sounds, or procedural voices that can't skip ahead. */
+		bool bAlwaysReal;
+	};
+
+	/** Fade a real voice's output gets in the current block, so it doesn't click when it goes virtual or comes back. */
+	enum class EMixerVoiceFade : uint8
+	{
+		None,
+
+		/** From silence to full level: the voice just became real. */
+		In,
+
+		/** From full level to silence: the voice goes virtual in the next block. */
+		Out
+	};
+
+	/** Counters of the voice audibility pass. Written by the audio render thread, readable from anywhere. */
+	struct FMixerVoiceCounters
+	{
+		/** Voices that rendered in the last block, including those fading out, and voices that were virtual. */
+		std::atomic<int32> NumRealVoices { 0 };
+		std::atomic<int32> NumVirtualVoices { 0 };
+
+		/** Voices that went virtual, and that came back. */
+		std::atomic<uint64> NumVirtualizations { 0 };
+		std::atomic<uint64> NumRealizations { 0 };
+
+		/** Virtual voices that rendered again to re-measure their level. Each probe also counts as a realization. */
+		std::atomic<uint64> NumProbes { 0 };
+
+		/** Increments a counter. Audio render thread only. */
+		static void Increment(std::atomic<uint64>& Counter)
+		{
+			Counter.store(Counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+	};
+
+	/**
+	 * Per-block audibility pass over the playing voices.
+	 *
+	 * Before the sources render, each voice is ranked by its estimated output level: its gain times the
+	 * envelope of its recent output. Voices below au.Voice.VirtualizeThreshold, and the quietest voices
+	 * beyond the au.Voice.MaxRealVoices budget, are virtualized. The source manager skips decoding and
+	 * source processing for them and submixes skip mixing them, while their playback position keeps
+	 * advancing, so they resume in place once they rank as audible again.
+	 *
+	 * A virtual voice is ranked by the envelope it had when it went virtual, with its current gain, so
+	 * attenuation and send changes can bring it back. As that envelope can't rise while nothing renders,
+	 * virtual voices also probe: every au.Voice.VirtualProbeInterval blocks they render for the warm-up
+	 * length and are ranked again by their current output, so a voice that went quiet comes back once it
+	 * plays again. Real voices rank au.Voice.VirtualizeHysteresis times
+	 * louder than they are, so voices close to the threshold or the edge of the budget don't flap. New voices
+	 * stay real for their first blocks, until their envelope reflects their output, and resumed voices keep
+	 * their held envelope until their envelope follower has caught up again.
+	 *
+	 * With au.Voice.VirtualizeFadeMs set, a voice that is to go virtual renders one more block, fading out
+	 * over its first milliseconds, and only goes virtual in the next block if it still ranks inaudible then.
+	 * A voice that becomes real, or stays real after fading out, fades in. Submixes apply the fades to the
+	 * voices' sends (see GetFade).
+	 *
+	 * Update runs on the audio render thread. IsVirtual may be called while that block's submixes render,
+	 * on any render thread, and the counters can be read from anywhere.
+	 */
+	class FMixerVoiceAudibility
+	{
+	public:
+		FMixerVoiceAudibility();
+
+		/** Sizes the per-source state for source ids below InMaxSources, with every voice real. Not while rendering. */
+		void Init(int32 InMaxSources);
+
+		/**
+		 * Ranks this block's voices and decides which are virtual. With bInAllowVirtualization false every voice
+		 * is real. InBudgetScale scales the real voice budget, e.g. by the overload governor's voice scale.
+		 */
+		void Update(TArrayView<const FMixerVoiceAudibilityInput> InVoices, bool bInAllowVirtualization, float InBudgetScale);
+
+		/** Returns true if the voice was virtualized by the last Update. Voices that weren't part of it are real. */
+		bool IsVirtual(int32 InSourceId) const
+		{
+			return InSourceId >= 0 && InSourceId < States.Num() && States[InSourceId].bIsVirtual && States[InSourceId].LastSeenUpdate == UpdateIndex;
+		}
+
+		/** Returns the fade of a real voice in the current block. Voices that weren't part of the last Update don't fade. */
+		EMixerVoiceFade GetFade(int32 InSourceId) const
+		{
+			return InSourceId >= 0 && InSourceId < States.Num() && States[InSourceId].LastSeenUpdate == UpdateIndex ? States[InSourceId].Fade : EMixerVoiceFade::None;
+		}
+
+		/** Returns the number of frames a fade lasts in a block of the given length: au.Voice.VirtualizeFadeMs, at most the whole block. */
+		static int32 GetNumFadeFrames(int32 InNumFrames, float InSampleRate);
+
+		/** Voices that went virtual in the last Update, whose decoders can be parked. */
+		TArrayView<const int32> GetVirtualizedVoices() const { return VirtualizedVoices; }
+
+		/** Voices that became real in the last Update, whose decoders must seek to their playback position and resume. */
+		TArrayView<const int32> GetRealizedVoices() const { return RealizedVoices; }
+
+		const FMixerVoiceCounters& GetCounters() const { return Counters; }
+
+	private:
+		struct FVoiceState
+		{
+			/** Envelope of the voice when it was last real. */
+			float HeldEnvelope;
+
+			/** Update the voice was last part of. */
+			uint32 LastSeenUpdate;
+
+			/** Updates since the voice started or resumed, up to the warm-up length. */
+			int32 NumRealUpdates;
+
+			/** Updates since the voice went virtual or last probed. */
+			int32 NumVirtualUpdates;
+
+			/** Set once the voice has rendered for the warm-up length, so its envelope can be ranked. */
+			bool bIsMeasured;
+
+			bool bIsVirtual;
+
+			/** Set once the voice has rendered its fade out, so it can go virtual without a click. */
+			bool bIsFadedOut;
+
+			/** Fade of the voice in the current block. */
+			EMixerVoiceFade Fade;
+		};
+
+		struct FRankedVoice
+		{
+			float Score;
+			int32 SourceId;
+		};
+
+		/** Makes a voice virtual or real, recording the transition. With fades on, a real voice fades out for a block before it goes virtual. */
+		void SetVirtual(FVoiceState& InState, int32 InSourceId, bool bInIsVirtual);
+
+		TArray<FVoiceState> States;
+
+		/** Scratch of the voices competing for the budget, reserved by Init. */
+		TArray<FRankedVoice> RankedVoices;
+
+		TArray<int32> VirtualizedVoices;
+		TArray<int32> RealizedVoices;
+
+		uint32 UpdateIndex;
+
+		/** Whether transitions fade, from au.Voice.VirtualizeFadeMs at the start of the Update. */
+		bool bFadeTransitions;
+
+		FMixerVoiceCounters Counters;
+	};
+}
@@ -2,13 +2,41 @@
 #define _CONTAINER_QUEUE_H_
 
 #include <atomic>
+#include <cstdint>
+#include <thread>
 namespace common {
 namespace router {
 
+/** Whether this is a ThreadSanitizer build (GCC defines __SANITIZE_THREAD__, Clang has the feature check). */
+#if defined(__SANITIZE_THREAD__)
+	#define QUEUE_TSAN 1
+#elif defined(__has_feature)
+	#if __has_feature(thread_sanitizer)
+		#define QUEUE_TSAN 1
+	#endif
+#endif
+#ifndef QUEUE_TSAN
+	#define QUEUE_TSAN 0
+#endif
+
+#if QUEUE_TSAN
+// Dynamic annotations exported by the ThreadSanitizer runtime.
+extern "C" void AnnotateHappensBefore(const char* File, int Line, const volatile void* Addr);
+extern "C" void AnnotateHappensAfter(const char* File, int Line, const volatile void* Addr);
+
+#define TSAN_SAFE
+#define TSAN_BEFORE(Addr) AnnotateHappensBefore(__FILE__, __LINE__, (const volatile void*)(Addr))
+#define TSAN_AFTER(Addr) AnnotateHappensAfter(__FILE__, __LINE__, (const volatile void*)(Addr))
+#define TSAN_ATOMIC(Type) std::atomic<Type>
+#else
 #define TSAN_SAFE
 #define TSAN_BEFORE(Addr)
 #define TSAN_AFTER(Addr)
 #define TSAN_ATOMIC(Type) Type
+#endif
+
+/** Size of a cache line, used to keep producer and consumer indices on separate lines. */
+#define QUEUE_CACHE_LINE_SIZE 64
 
 /**
  * Enumerates concurrent queue modes.
@@ -22,19 +50,22 @@ enum class EQueueMode
 	Spsc
 };
 
-static inline void* InterlockedExchangePtr(void*volatile* Dest, void* Exchange)
+/**
+ * Rounds the given value up to the next power of two.
+ *
+ * @param Value The value to round (must be in the range [1, 2^31]).
+ * @return The smallest power of two that is greater than or equal to Value.
+ */
+static inline uint32_t RoundUpToPowerOfTwo(uint32_t Value)
 {
-	return __sync_lock_test_and_set(Dest, Exchange);
-}
+	uint32_t Result = 1;
 
-inline void MemoryBarrier() {
-#if defined(__GLIBCXX__)
-  // Work around libstdc++ bug 51038 where atomic_thread_fence was declared but
-  // not defined, leading to the linker complaining about undefined references.
-  __atomic_thread_fence(std::memory_order_seq_cst);
-#else
-  std::atomic_thread_fence(std::memory_order_seq_cst);
-#endif
+	while (Result < Value)
+	{
+		Result <<= 1;
+	}
+
+	return Result;
 }
 
 
@@ -45,23 +76,55 @@ inline void MemoryBarrier() {
  * list that stores copies of the queued items. The template can operate in two modes:
  * Multiple-producers single-consumer (MPSC) and Single-producer single-consumer (SPSC).
  *
- * The queue is thread-safe in both modes. The Dequeue() method ensures thread-safety by
- * writing it in a way that does not depend on possible instruction reordering on the CPU.
- * The Enqueue() method uses an atomic compare-and-swap in multiple-producers scenarios.
+ * The queue is thread-safe in both modes. The Enqueue() method links a new node with a
+ * release store that the consumer acquires before it reads the item, so all accesses are
+ * ordered by the C++ memory model and the queue runs clean under ThreadSanitizer. In
+ * multiple-producers scenarios producers claim the head with an atomic exchange.
+ *
+ * Nodes are taken from a preallocated pool and recycled by the consumer through a
+ * lock-free free list, so steady-state traffic does not touch the global allocator.
+ * The pool only falls back to the heap when it runs dry; such nodes are deleted again
+ * when they are retired instead of being returned to the pool.
  *
  * @param ItemType The type of items stored in the queue.
  * @param Mode The queue mode (single-producer, single-consumer by default).
- * @todo gmp: Implement node pooling.
  */
 template<typename ItemType, EQueueMode Mode = EQueueMode::Spsc>
 class TQueue
 {
 public:
 
-	/** Default constructor. */
-	TQueue()
+	/** Number of nodes preallocated by the default constructor. */
+	static const uint32_t DefaultNodePoolCapacity = 256;
+
+	/**
+	 * Creates and initializes a new queue.
+	 *
+	 * @param InNodePoolCapacity The number of items the queue holds without allocating. One more node is preallocated for the queue's dummy node.
+	 */
+	explicit TQueue(uint32_t InNodePoolCapacity = DefaultNodePoolCapacity)
+		: NodePool(nullptr)
+		, NodePoolCapacity(InNodePoolCapacity > 0 ? InNodePoolCapacity + 1 : 0)
+		, FreeListHead(InvalidNodeIndex)
+		, NumPoolHits(0)
+		, NumPoolMisses(0)
 	{
-		Head = Tail = new TNode();
+		if (NodePoolCapacity > 0)
+		{
+			NodePool = new TNode[NodePoolCapacity];
+
+			// Thread the free list through the pool in index order.
+			for (uint32_t NodeIndex = 0; NodeIndex < NodePoolCapacity; ++NodeIndex)
+			{
+				NodePool[NodeIndex].bPooled = true;
+				NodePool[NodeIndex].NextFree.store(NodeIndex + 1 < NodePoolCapacity ? NodeIndex + 1 : InvalidNodeIndex, std::memory_order_relaxed);
+			}
+
+			FreeListHead.store(0, std::memory_order_relaxed);
+		}
+
+		Tail = AllocateNode();
+		Head.store(Tail, std::memory_order_relaxed);
 	}
 
 	/** Destructor. */
@@ -70,10 +133,15 @@ public:
 		while (Tail != nullptr)
 		{
 			TNode* Node = Tail;
-			Tail = Tail->NextNode;
+			Tail = Tail->NextNode.load(std::memory_order_relaxed);
 
-			delete Node;
+			if (!Node->bPooled)
+			{
+				delete Node;
+			}
 		}
+
+		delete[] NodePool;
 	}
 
 	/**
@@ -86,7 +154,7 @@ public:
 	 */
 	bool Dequeue(ItemType& OutItem)
 	{
-		TNode* Popped = Tail->NextNode;
+		TNode* Popped = Tail->NextNode.load(std::memory_order_acquire);
 
 		if (Popped == nullptr)
 		{
@@ -99,7 +167,7 @@ public:
 		TNode* OldTail = Tail;
 		Tail = Popped;
 		Tail->Item = ItemType();
-		delete OldTail;
+		ReleaseNode(OldTail);
 
 		return true;
 	}
@@ -125,30 +193,31 @@ public:
 	 */
 	bool Enqueue(const ItemType& Item)
 	{
-		TNode* NewNode = new TNode(Item);
+		TNode* NewNode = AllocateNode();
 
 		if (NewNode == nullptr)
 		{
 			return false;
 		}
 
+		NewNode->Item = Item;
+
 		TNode* OldHead;
 
 		if (Mode == EQueueMode::Mpsc)
 		{
-			OldHead = (TNode*)InterlockedExchangePtr((void**)&Head, NewNode);
-			TSAN_BEFORE(&OldHead->NextNode);
-			InterlockedExchangePtr((void**)&OldHead->NextNode, NewNode);
+			OldHead = Head.exchange(NewNode, std::memory_order_acq_rel);
 		}
 		else
 		{
-			OldHead = Head;
-			Head = NewNode;
-			TSAN_BEFORE(&OldHead->NextNode);
-			MemoryBarrier();
-            		OldHead->NextNode = NewNode;
+			OldHead = Head.load(std::memory_order_relaxed);
+			Head.store(NewNode, std::memory_order_relaxed);
 		}
 
+		// Publishes the item to the consumer, which acquires the link before reading it.
+		TSAN_BEFORE(&OldHead->NextNode);
+		OldHead->NextNode.store(NewNode, std::memory_order_release);
+
 		return true;
 	}
 
@@ -162,30 +231,31 @@ public:
 	 */
 	bool Enqueue(ItemType&& Item)
 	{
-		TNode* NewNode = new TNode(std::move(Item));
+		TNode* NewNode = AllocateNode();
 
 		if (NewNode == nullptr)
 		{
 			return false;
 		}
 
+		NewNode->Item = std::move(Item);
+
 		TNode* OldHead;
 
 		if (Mode == EQueueMode::Mpsc)
 		{
-            		OldHead = (TNode*)InterlockedExchangePtr((void**)&Head, NewNode);
-			TSAN_BEFORE(&OldHead->NextNode);
-            		InterlockedExchangePtr((void**)&OldHead->NextNode, NewNode);
+			OldHead = Head.exchange(NewNode, std::memory_order_acq_rel);
 		}
 		else
 		{
-			OldHead = Head;
-			Head = NewNode;
-			TSAN_BEFORE(&OldHead->NextNode);
-			MemoryBarrier();
-			OldHead->NextNode = NewNode;
+			OldHead = Head.load(std::memory_order_relaxed);
+			Head.store(NewNode, std::memory_order_relaxed);
 		}
 
+		// Publishes the item to the consumer, which acquires the link before reading it.
+		TSAN_BEFORE(&OldHead->NextNode);
+		OldHead->NextNode.store(NewNode, std::memory_order_release);
+
 		return true;
 	}
 
@@ -198,7 +268,7 @@ public:
 	 */
 	bool IsEmpty() const
 	{
-		return (Tail->NextNode == nullptr);
+		return (Tail->NextNode.load(std::memory_order_acquire) == nullptr);
 	}
 
 	/**
@@ -211,12 +281,15 @@ public:
 	 */
 	bool Peek(ItemType& OutItem) const
 	{
-		if (Tail->NextNode == nullptr)
+		TNode* Next = Tail->NextNode.load(std::memory_order_acquire);
+
+		if (Next == nullptr)
 		{
 			return false;
 		}
 
-		OutItem = Tail->NextNode->Item;
+		TSAN_AFTER(&Tail->NextNode);
+		OutItem = Next->Item;
 
 		return true;
 	}
@@ -231,12 +304,15 @@ public:
 	 */
 	ItemType* Peek()
 	{
-		if (Tail->NextNode == nullptr)
+		TNode* Next = Tail->NextNode.load(std::memory_order_acquire);
+
+		if (Next == nullptr)
 		{
 			return nullptr;
 		}
 
-		return &Tail->NextNode->Item;
+		TSAN_AFTER(&Tail->NextNode);
+		return &Next->Item;
 	}
 
 	inline const ItemType* Peek() const
@@ -253,7 +329,7 @@ public:
 	 */
 	bool Pop()
 	{
-		TNode* Popped = Tail->NextNode;
+		TNode* Popped = Tail->NextNode.load(std::memory_order_acquire);
 
 		if (Popped == nullptr)
 		{
@@ -265,46 +341,153 @@ public:
 		TNode* OldTail = Tail;
 		Tail = Popped;
 		Tail->Item = ItemType();
-		delete OldTail;
+		ReleaseNode(OldTail);
 
 		return true;
 	}
 
+	/**
+	 * Returns the number of nodes that were served from the node pool.
+	 *
+	 * @return Pool hit count since construction.
+	 * @see GetNumPoolMisses
+	 */
+	uint64_t GetNumPoolHits() const
+	{
+		return NumPoolHits.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * Returns the number of nodes that had to be allocated from the heap because the pool was empty.
+	 *
+	 * @return Pool miss count since construction.
+	 * @see GetNumPoolHits
+	 */
+	uint64_t GetNumPoolMisses() const
+	{
+		return NumPoolMisses.load(std::memory_order_relaxed);
+	}
+
 private:
 
+	/** Marks the end of the node pool's free list. */
+	static const uint32_t InvalidNodeIndex = 0xffffffffU;
+
 	/** Structure for the internal linked list. */
 	struct TNode
 	{
-		/** Holds a pointer to the next node in the list. */
-		TNode* volatile NextNode;
+		/** Holds a pointer to the next node in the list. Released by the producer that links the node, acquired by the consumer. */
+		std::atomic<TNode*> NextNode;
 
 		/** Holds the node's item. */
 		ItemType Item;
 
+		/** Holds the index of the next free node while this node sits in the pool's free list. */
+		std::atomic<uint32_t> NextFree;
+
+		/** Whether this node lives in the preallocated pool (as opposed to the heap). */
+		bool bPooled;
+
 		/** Default constructor. */
 		TNode()
 			: NextNode(nullptr)
+			, NextFree(InvalidNodeIndex)
+			, bPooled(false)
 		{ }
 
 		/** Creates and initializes a new node. */
 		explicit TNode(const ItemType& InItem)
 			: NextNode(nullptr)
 			, Item(InItem)
+			, NextFree(InvalidNodeIndex)
+			, bPooled(false)
 		{ }
 
 		/** Creates and initializes a new node. */
 		explicit TNode(ItemType&& InItem)
 			: NextNode(nullptr)
 			, Item(std::move(InItem))
+			, NextFree(InvalidNodeIndex)
+			, bPooled(false)
 		{ }
 	};
 
-	/** Holds a pointer to the head of the list. */
-	//MS_ALIGN(16) TNode* volatile Head GCC_ALIGN(16);
-	TNode* volatile Head;
+	/**
+	 * Takes a node from the pool, or from the heap if the pool is exhausted.
+	 *
+	 * The free list head packs the node index in its low 32 bits and a modification tag
+	 * in its high 32 bits, which keeps concurrent pops from multiple producers ABA-safe.
+	 *
+	 * @return A node with a default item and no successor.
+	 */
+	TNode* AllocateNode()
+	{
+		uint64_t OldHead = FreeListHead.load(std::memory_order_acquire);
+
+		while ((uint32_t)OldHead != InvalidNodeIndex)
+		{
+			TNode* Node = &NodePool[(uint32_t)OldHead];
+			const uint64_t NewHead = (((OldHead >> 32) + 1) << 32) | Node->NextFree.load(std::memory_order_relaxed);
+
+			if (FreeListHead.compare_exchange_weak(OldHead, NewHead, std::memory_order_acquire, std::memory_order_acquire))
+			{
+				NumPoolHits.fetch_add(1, std::memory_order_relaxed);
+				Node->NextNode.store(nullptr, std::memory_order_relaxed);
+
+				return Node;
+			}
+		}
+
+		NumPoolMisses.fetch_add(1, std::memory_order_relaxed);
+
+		return new TNode();
+	}
+
+	/**
+	 * Returns a retired node to the pool, or deletes it if it came from the heap.
+	 *
+	 * @param Node The node to release. Its item must already have been reset.
+	 */
+	void ReleaseNode(TNode* Node)
+	{
+		if (!Node->bPooled)
+		{
+			delete Node;
+			return;
+		}
+
+		const uint32_t NodeIndex = (uint32_t)(Node - NodePool);
+		uint64_t OldHead = FreeListHead.load(std::memory_order_relaxed);
+		uint64_t NewHead;
+
+		do
+		{
+			Node->NextFree.store((uint32_t)OldHead, std::memory_order_relaxed);
+			NewHead = (((OldHead >> 32) + 1) << 32) | NodeIndex;
+		}
+		while (!FreeListHead.compare_exchange_weak(OldHead, NewHead, std::memory_order_release, std::memory_order_relaxed));
+	}
 
-	/** Holds a pointer to the tail of the list. */
-	TNode* Tail;
+	/** Holds a pointer to the head of the list. Written by the producer(s). */
+	alignas(QUEUE_CACHE_LINE_SIZE) std::atomic<TNode*> Head;
+
+	/** Holds a pointer to the tail of the list. Only touched by the consumer. */
+	alignas(QUEUE_CACHE_LINE_SIZE) TNode* Tail;
+
+	/** Holds the preallocated nodes. */
+	TNode* NodePool;
+
+	/** Holds the number of preallocated nodes. */
+	uint32_t NodePoolCapacity;
+
+	/** Holds the tagged index of the first free pooled node. */
+	std::atomic<uint64_t> FreeListHead;
+
+	/** Counts nodes served from the pool. */
+	std::atomic<uint64_t> NumPoolHits;
+
+	/** Counts nodes that had to be allocated from the heap. */
+	std::atomic<uint64_t> NumPoolMisses;
 	
 private:
 
@@ -314,6 +497,238 @@ private:
 	/** Hidden assignment operator. */
 	TQueue& operator=(const TQueue&) = delete;
 };
+
+/**
+ * Template for bounded queues.
+ *
+ * This template implements a bounded, array-backed lock-free queue that stores copies of
+ * the queued items in a ring. The capacity is rounded up to the next power of two so that
+ * indices can be wrapped with a bit mask, in the same way as TCircularBuffer. Like TQueue
+ * it can operate in MPSC and SPSC modes.
+ *
+ * Unlike TQueue, producers are told when the queue is full instead of growing it, and whole
+ * batches of items can be enqueued or dequeued with a single atomic publish. In MPSC mode
+ * producers first reserve a range of slots and then publish their ranges in reservation
+ * order, so a producer that was preempted between the two steps briefly holds back the
+ * producers that reserved after it.
+ *
+ * @param ItemType The type of items stored in the queue.
+ * @param Mode The queue mode (single-producer, single-consumer by default).
+ */
+template<typename ItemType, EQueueMode Mode = EQueueMode::Spsc>
+class TBoundedQueue
+{
+public:
+
+	/**
+	 * Creates and initializes a new queue.
+	 *
+	 * @param InCapacity The number of items the queue can hold (will be rounded up to the next power of 2).
+	 */
+	explicit TBoundedQueue(uint32_t InCapacity)
+		: Capacity(RoundUpToPowerOfTwo(InCapacity > 0 ? InCapacity : 1))
+		, IndexMask(Capacity - 1)
+		, Items(new ItemType[Capacity])
+		, ReserveIndex(0)
+		, PublishIndex(0)
+		, ConsumeIndex(0)
+	{ }
+
+	/** Destructor. */
+	~TBoundedQueue()
+	{
+		delete[] Items;
+	}
+
+	/**
+	 * Returns the number of items the queue can hold.
+	 *
+	 * @return Queue capacity.
+	 */
+	uint32_t GetCapacity() const
+	{
+		return Capacity;
+	}
+
+	/**
+	 * Adds an item to the head of the queue.
+	 *
+	 * @param Item The item to add.
+	 * @return true if the item was added, false if the queue was full.
+	 * @note To be called only from producer thread(s).
+	 * @see TryEnqueueBatch, Dequeue
+	 */
+	bool TryEnqueue(const ItemType& Item)
+	{
+		return TryEnqueueBatch(&Item, 1);
+	}
+
+	/**
+	 * Adds a batch of items to the head of the queue.
+	 *
+	 * Either all items are added or none are. The whole batch becomes visible to the
+	 * consumer at once.
+	 *
+	 * @param InItems The items to add.
+	 * @param NumItems The number of items to add.
+	 * @return true if the items were added, false if the queue did not have room for all of them.
+	 * @note To be called only from producer thread(s).
+	 * @see TryEnqueue, DequeueBatch
+	 */
+	bool TryEnqueueBatch(const ItemType* InItems, uint32_t NumItems)
+	{
+		if (NumItems == 0)
+		{
+			return true;
+		}
+
+		if (NumItems > Capacity)
+		{
+			return false;
+		}
+
+		uint32_t StartIndex;
+
+		if (Mode == EQueueMode::Mpsc)
+		{
+			StartIndex = ReserveIndex.load(std::memory_order_relaxed);
+
+			do
+			{
+				if (StartIndex + NumItems - ConsumeIndex.load(std::memory_order_acquire) > Capacity)
+				{
+					return false;
+				}
+			}
+			while (!ReserveIndex.compare_exchange_weak(StartIndex, StartIndex + NumItems, std::memory_order_relaxed, std::memory_order_relaxed));
+		}
+		else
+		{
+			StartIndex = PublishIndex.load(std::memory_order_relaxed);
+
+			if (StartIndex + NumItems - ConsumeIndex.load(std::memory_order_acquire) > Capacity)
+			{
+				return false;
+			}
+		}
+
+		for (uint32_t ItemIndex = 0; ItemIndex < NumItems; ++ItemIndex)
+		{
+			Items[(StartIndex + ItemIndex) & IndexMask] = InItems[ItemIndex];
+		}
+
+		if (Mode == EQueueMode::Mpsc)
+		{
+			// Wait for producers that reserved earlier ranges to publish them first.
+			while (PublishIndex.load(std::memory_order_acquire) != StartIndex)
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		TSAN_BEFORE(&PublishIndex);
+		PublishIndex.store(StartIndex + NumItems, std::memory_order_release);
+
+		return true;
+	}
+
+	/**
+	 * Removes and returns the item from the tail of the queue.
+	 *
+	 * @param OutItem Will hold the returned item.
+	 * @return true if an item was returned, false if the queue was empty.
+	 * @note To be called only from consumer thread.
+	 * @see DequeueBatch, TryEnqueue
+	 */
+	bool Dequeue(ItemType& OutItem)
+	{
+		return DequeueBatch(&OutItem, 1) == 1;
+	}
+
+	/**
+	 * Removes up to the given number of items from the tail of the queue.
+	 *
+	 * @param OutItems Will hold the returned items.
+	 * @param MaxItems The maximum number of items to return.
+	 * @return The number of items returned.
+	 * @note To be called only from consumer thread.
+	 * @see Dequeue, TryEnqueueBatch
+	 */
+	uint32_t DequeueBatch(ItemType* OutItems, uint32_t MaxItems)
+	{
+		const uint32_t StartIndex = ConsumeIndex.load(std::memory_order_relaxed);
+		const uint32_t NumAvailable = PublishIndex.load(std::memory_order_acquire) - StartIndex;
+		const uint32_t NumItems = NumAvailable < MaxItems ? NumAvailable : MaxItems;
+
+		if (NumItems == 0)
+		{
+			return 0;
+		}
+
+		TSAN_AFTER(&PublishIndex);
+
+		for (uint32_t ItemIndex = 0; ItemIndex < NumItems; ++ItemIndex)
+		{
+			ItemType& Slot = Items[(StartIndex + ItemIndex) & IndexMask];
+			OutItems[ItemIndex] = std::move(Slot);
+			Slot = ItemType();
+		}
+
+		ConsumeIndex.store(StartIndex + NumItems, std::memory_order_release);
+
+		return NumItems;
+	}
+
+	/**
+	 * Checks whether the queue is empty.
+	 *
+	 * @return true if the queue is empty, false otherwise.
+	 * @note To be called only from consumer thread.
+	 */
+	bool IsEmpty() const
+	{
+		return PublishIndex.load(std::memory_order_acquire) == ConsumeIndex.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * Returns the number of items currently published to the consumer.
+	 *
+	 * @return Number of items in the queue.
+	 * @note Only exact when called from the consumer thread.
+	 */
+	uint32_t Num() const
+	{
+		return PublishIndex.load(std::memory_order_acquire) - ConsumeIndex.load(std::memory_order_acquire);
+	}
+
+private:
+
+	/** Holds the number of slots in the ring (a power of two). */
+	const uint32_t Capacity;
+
+	/** Holds the mask for indexing the ring. */
+	const uint32_t IndexMask;
+
+	/** Holds the ring's slots. */
+	ItemType* Items;
+
+	/** Holds the end of the range reserved by producers (MPSC only). */
+	alignas(QUEUE_CACHE_LINE_SIZE) std::atomic<uint32_t> ReserveIndex;
+
+	/** Holds the end of the range visible to the consumer. */
+	alignas(QUEUE_CACHE_LINE_SIZE) std::atomic<uint32_t> PublishIndex;
+
+	/** Holds the index of the next slot to be consumed. */
+	alignas(QUEUE_CACHE_LINE_SIZE) std::atomic<uint32_t> ConsumeIndex;
+
+private:
+
+	/** Hidden copy constructor. */
+	TBoundedQueue(const TBoundedQueue&) = delete;
+
+	/** Hidden assignment operator. */
+	TBoundedQueue& operator=(const TBoundedQueue&) = delete;
+};
 } //namespace utils 
 } //namespace xverse
 #endif //_CONTAINER_QUEUE_H_
@@ -0,0 +1,342 @@
+#ifndef _CONTAINER_QUEUE_HARNESS_H_
+#define _CONTAINER_QUEUE_HARNESS_H_
+
+#include "concurrent_queue.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace common {
+namespace router {
+
+/**
+ * Throughput and latency of one queue benchmark run.
+ */
+struct FQueueBenchmarkResult
+{
+	/** Number of producer threads. */
+	uint32_t NumProducers = 0;
+
+	/** Number of items that went through the queue. */
+	uint64_t NumItems = 0;
+
+	/** Items dequeued per second, over the whole run. */
+	double ItemsPerSecond = 0.0;
+
+	/** Time per enqueue percentiles (between consecutive items of a producer), in nanoseconds. Includes the retries of a full bounded queue. */
+	double EnqueueP50Ns = 0.0;
+	double EnqueueP99Ns = 0.0;
+	double EnqueueP999Ns = 0.0;
+
+	/** Time from enqueue to dequeue percentiles, in nanoseconds. */
+	double TransitP50Ns = 0.0;
+	double TransitP99Ns = 0.0;
+	double TransitP999Ns = 0.0;
+};
+
+/**
+ * Item passed through the queue by the harness.
+ */
+struct FQueueHarnessItem
+{
+	/** Index of the producer that enqueued the item. */
+	uint32_t Producer = 0;
+
+	/** Position of the item in its producer's sequence, starting at 1. */
+	uint32_t Sequence = 0;
+
+	/** Steady clock time at which the item was enqueued, in nanoseconds. */
+	int64_t EnqueueTimeNs = 0;
+};
+
+namespace QueueHarness {
+
+	inline int64_t NowNs()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	/** Returns the given percentile (0 to 100) of the samples, which are sorted in place. */
+	inline double Percentile(std::vector<int64_t>& Samples, double InPercentile)
+	{
+		if (Samples.empty())
+		{
+			return 0.0;
+		}
+
+		std::sort(Samples.begin(), Samples.end());
+		const size_t Rank = (size_t)(InPercentile / 100.0 * Samples.size() + 0.999999);
+		return (double)Samples[std::min(Samples.size() - 1, Rank > 0 ? Rank - 1 : 0)];
+	}
+
+	/** Enqueue adapters, so the harness runs against every queue variant. */
+	template<typename ItemType, EQueueMode Mode>
+	inline bool TryEnqueue(TQueue<ItemType, Mode>& Queue, const ItemType& Item)
+	{
+		return Queue.Enqueue(Item);
+	}
+
+	template<typename ItemType, EQueueMode Mode>
+	inline bool TryEnqueue(TBoundedQueue<ItemType, Mode>& Queue, const ItemType& Item)
+	{
+		return Queue.TryEnqueue(Item);
+	}
+
+	/** Spins for a random number of iterations, to shake up the interleaving of the threads. */
+	inline void RandomPause(std::minstd_rand& Random, uint32_t MaxSpins)
+	{
+		const uint32_t NumSpins = MaxSpins > 0 ? Random() % MaxSpins : 0;
+		for (volatile uint32_t Spin = 0; Spin < NumSpins; Spin = Spin + 1)
+		{
+		}
+
+		if (NumSpins == 0 && (Random() & 15) == 0)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	/**
+	 * Runs producers against a consumer on the calling thread and checks every dequeued item as it arrives.
+	 *
+	 * @return An empty string on success, or a description of the first violation.
+	 */
+	template<typename QueueType, typename ProducerPauseType, typename ConsumerCheckType>
+	std::string RunProducersAndConsumer(QueueType& Queue, uint32_t NumProducers, uint32_t ItemsPerProducer, ProducerPauseType&& ProducerPause, ConsumerCheckType&& ConsumerCheck)
+	{
+		std::atomic<uint32_t> NumReady(0);
+		std::atomic<bool> bGo(false);
+		std::vector<std::thread> Producers;
+
+		for (uint32_t Producer = 0; Producer < NumProducers; ++Producer)
+		{
+			Producers.emplace_back([&, Producer]()
+			{
+				NumReady.fetch_add(1, std::memory_order_relaxed);
+				while (!bGo.load(std::memory_order_acquire))
+				{
+					std::this_thread::yield();
+				}
+
+				for (uint32_t Sequence = 1; Sequence <= ItemsPerProducer; ++Sequence)
+				{
+					ProducerPause(Producer);
+
+					FQueueHarnessItem Item;
+					Item.Producer = Producer;
+					Item.Sequence = Sequence;
+					Item.EnqueueTimeNs = NowNs();
+
+					while (!TryEnqueue(Queue, Item))
+					{
+						std::this_thread::yield();
+					}
+				}
+			});
+		}
+
+		while (NumReady.load(std::memory_order_relaxed) < NumProducers)
+		{
+			std::this_thread::yield();
+		}
+		bGo.store(true, std::memory_order_release);
+
+		std::string Error;
+		const uint64_t NumItems = (uint64_t)NumProducers * ItemsPerProducer;
+		FQueueHarnessItem Item;
+
+		for (uint64_t NumDequeued = 0; NumDequeued < NumItems; )
+		{
+			if (!Queue.Dequeue(Item))
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			++NumDequeued;
+			if (Error.empty())
+			{
+				Error = ConsumerCheck(Item);
+			}
+		}
+
+		for (std::thread& Thread : Producers)
+		{
+			Thread.join();
+		}
+
+		if (Error.empty() && !Queue.IsEmpty())
+		{
+			Error = "the queue still holds items after every produced item was dequeued";
+		}
+
+		return Error;
+	}
+}
+
+/**
+ * Measures throughput and latency of a queue with the given number of producers and one consumer.
+ *
+ * @param Queue The queue to measure. Its item type must be FQueueHarnessItem, and it must be empty.
+ * @param NumProducers The number of producer threads (use 1 for SPSC queues).
+ * @param ItemsPerProducer The number of items each producer enqueues.
+ * @return The measured throughput and latency percentiles.
+ */
+template<typename QueueType>
+FQueueBenchmarkResult RunQueueBenchmark(QueueType& Queue, uint32_t NumProducers, uint32_t ItemsPerProducer)
+{
+	FQueueBenchmarkResult Result;
+	Result.NumProducers = NumProducers;
+	Result.NumItems = (uint64_t)NumProducers * ItemsPerProducer;
+
+	// Sample every item's transit and each producer's enqueue calls into preallocated storage.
+	std::vector<int64_t> TransitNs;
+	TransitNs.reserve((size_t)Result.NumItems);
+	std::vector<std::vector<int64_t>> EnqueueNs(NumProducers);
+	for (std::vector<int64_t>& Samples : EnqueueNs)
+	{
+		Samples.reserve(ItemsPerProducer);
+	}
+
+	std::vector<int64_t> LastEnqueueEnd(NumProducers, 0);
+
+	const int64_t StartNs = QueueHarness::NowNs();
+
+	QueueHarness::RunProducersAndConsumer(Queue, NumProducers, ItemsPerProducer,
+		[&](uint32_t Producer)
+		{
+			// The previous enqueue of this producer ended when it came back for the next item.
+			const int64_t Now = QueueHarness::NowNs();
+			if (LastEnqueueEnd[Producer] != 0)
+			{
+				EnqueueNs[Producer].push_back(Now - LastEnqueueEnd[Producer]);
+			}
+			LastEnqueueEnd[Producer] = Now;
+		},
+		[&](const FQueueHarnessItem& Item)
+		{
+			TransitNs.push_back(QueueHarness::NowNs() - Item.EnqueueTimeNs);
+			return std::string();
+		});
+
+	const double Seconds = (QueueHarness::NowNs() - StartNs) / 1e9;
+	Result.ItemsPerSecond = Seconds > 0.0 ? Result.NumItems / Seconds : 0.0;
+
+	std::vector<int64_t> AllEnqueueNs;
+	for (const std::vector<int64_t>& Samples : EnqueueNs)
+	{
+		AllEnqueueNs.insert(AllEnqueueNs.end(), Samples.begin(), Samples.end());
+	}
+
+	Result.EnqueueP50Ns = QueueHarness::Percentile(AllEnqueueNs, 50.0);
+	Result.EnqueueP99Ns = QueueHarness::Percentile(AllEnqueueNs, 99.0);
+	Result.EnqueueP999Ns = QueueHarness::Percentile(AllEnqueueNs, 99.9);
+	Result.TransitP50Ns = QueueHarness::Percentile(TransitNs, 50.0);
+	Result.TransitP99Ns = QueueHarness::Percentile(TransitNs, 99.0);
+	Result.TransitP999Ns = QueueHarness::Percentile(TransitNs, 99.9);
+
+	return Result;
+}
+
+/**
+ * Randomized stress test of a queue's ordering guarantees.
+ *
+ * Producers enqueue numbered items with random pauses in between, so the interleavings differ
+ * from run to run. A queue with one consumer is linearizable exactly when the consumer sees every
+ * item once and each producer's items in the order they were enqueued, which is checked for every
+ * item as it is dequeued.
+ *
+ * @param Queue The queue to test. Its item type must be FQueueHarnessItem, and it must be empty.
+ * @param NumProducers The number of producer threads (use 1 for SPSC queues).
+ * @param ItemsPerProducer The number of items each producer enqueues.
+ * @param Seed Seed of the random pauses.
+ * @return An empty string if the queue behaved, or a description of the first violation.
+ */
+template<typename QueueType>
+std::string RunQueueStressTest(QueueType& Queue, uint32_t NumProducers, uint32_t ItemsPerProducer, uint32_t Seed)
+{
+	std::vector<std::minstd_rand> Randoms;
+	for (uint32_t Producer = 0; Producer < NumProducers; ++Producer)
+	{
+		Randoms.emplace_back(Seed * 7919u + Producer + 1);
+	}
+
+	std::vector<uint32_t> LastSequence(NumProducers, 0);
+
+	return QueueHarness::RunProducersAndConsumer(Queue, NumProducers, ItemsPerProducer,
+		[&](uint32_t Producer)
+		{
+			QueueHarness::RandomPause(Randoms[Producer], 64);
+		},
+		[&](const FQueueHarnessItem& Item)
+		{
+			if (Item.Producer >= NumProducers)
+			{
+				return std::string("dequeued an item from unknown producer ") + std::to_string(Item.Producer);
+			}
+
+			const uint32_t Expected = LastSequence[Item.Producer] + 1;
+			if (Item.Sequence != Expected)
+			{
+				return std::string("producer ") + std::to_string(Item.Producer) + ": expected item " + std::to_string(Expected) + ", dequeued item " + std::to_string(Item.Sequence);
+			}
+
+			LastSequence[Item.Producer] = Item.Sequence;
+			return std::string();
+		});
+}
+
+/**
+ * Checks the index arithmetic of a circular buffer (TCircularBuffer or any type with the same interface).
+ *
+ * Indices past the capacity and around the 32 bit wrap must alias the same slot as their masked
+ * value, and GetNextIndex / GetPreviousIndex must step around the ring.
+ *
+ * @param Buffer The buffer to check. Its elements are overwritten.
+ * @return An empty string on success, or a description of the first violation.
+ */
+template<typename BufferType>
+std::string CheckCircularBufferIndexing(BufferType& Buffer)
+{
+	const uint32_t Capacity = Buffer.Capacity();
+
+	if (Capacity == 0 || (Capacity & (Capacity - 1)) != 0)
+	{
+		return "capacity " + std::to_string(Capacity) + " is not a power of two";
+	}
+
+	for (uint32_t Index = 0; Index < Capacity; ++Index)
+	{
+		Buffer[Index] = Index;
+	}
+
+	const uint32_t Probes[] = { 0u, 1u, Capacity - 1, Capacity, Capacity + 1, 2 * Capacity - 1, 0x7fffffffu, 0xfffffffeu, 0xffffffffu };
+
+	for (const uint32_t Index : Probes)
+	{
+		const uint32_t Slot = Index & (Capacity - 1);
+
+		if ((uint32_t)Buffer[Index] != Slot)
+		{
+			return "index " + std::to_string(Index) + " does not alias slot " + std::to_string(Slot);
+		}
+
+		if (Buffer.GetNextIndex(Index) != ((Index + 1) & (Capacity - 1)))
+		{
+			return "next index of " + std::to_string(Index) + " is wrong";
+		}
+
+		if (Buffer.GetPreviousIndex(Index) != ((Index - 1) & (Capacity - 1)))
+		{
+			return "previous index of " + std::to_string(Index) + " is wrong";
+		}
+	}
+
+	return std::string();
+}
+
+} //namespace router
+} //namespace common
+#endif //_CONTAINER_QUEUE_HARNESS_H_
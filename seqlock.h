@@ -0,0 +1,140 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+#include <type_traits>
+
+namespace Audio
+{
+	/**
+	 * Sequence lock for a small, trivially copyable value with a single writer and any number of readers.
+	 *
+	 * The writer never waits. The sequence is odd while a write is in progress; a reader copies the
+	 * value and retries if the sequence was odd or changed while it was copying.
+	 */
+	template <typename ValueType>
+	class TSeqLock
+	{
+		static_assert(std::is_trivially_copyable<ValueType>::value, "TSeqLock copies its value bytewise while it may be written.");
+
+	public:
+		TSeqLock()
+			: Sequence(0)
+			, Value()
+		{
+		}
+
+		/** Writer only. */
+		void Write(const ValueType& InValue)
+		{
+			const uint32 CurrentSequence = Sequence.load(std::memory_order_relaxed);
+			Sequence.store(CurrentSequence + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			FMemory::Memcpy(&Value, &InValue, sizeof(ValueType));
+
+			Sequence.store(CurrentSequence + 2, std::memory_order_release);
+		}
+
+		/** Any thread. */
+		ValueType Read() const
+		{
+			ValueType Result;
+			for (;;)
+			{
+				const uint32 SequenceBefore = Sequence.load(std::memory_order_acquire);
+				if ((SequenceBefore & 1) == 0)
+				{
+					FMemory::Memcpy(&Result, &Value, sizeof(ValueType));
+
+					std::atomic_thread_fence(std::memory_order_acquire);
+					if (Sequence.load(std::memory_order_relaxed) == SequenceBefore)
+					{
+						return Result;
+					}
+				}
+				FPlatformProcess::Yield();
+			}
+		}
+
+	private:
+		std::atomic<uint32> Sequence;
+		ValueType Value;
+	};
+
+	/**
+	 * Double buffer for larger results with a single writer and any number of readers.
+	 *
+	 * The writer fills the buffer that was not published last and publishes it with an index flip, so it
+	 * never waits and a reader is only disturbed if the writer publishes twice while it is reading. Each
+	 * buffer carries its own sequence, which a reader checks after copying out what it needs.
+	 *
+	 * The buffers must be sized before reading and writing start; the writer may change element values
+	 * but must not reallocate them while readers are active.
+	 */
+	template <typename ValueType>
+	class TLockFreeDoubleBuffer
+	{
+	public:
+		TLockFreeDoubleBuffer()
+			: PublishedIndex(0)
+		{
+			Sequences[0].store(0, std::memory_order_relaxed);
+			Sequences[1].store(0, std::memory_order_relaxed);
+		}
+
+		/** Gives direct access to both buffers for sizing them. Only call while there are no readers or writers. */
+		ValueType& GetBufferForInit(int32 InIndex)
+		{
+			return Buffers[InIndex];
+		}
+
+		/** Writer only. Returns the buffer to fill; nothing is visible to readers until EndWrite. */
+		ValueType& BeginWrite()
+		{
+			const int32 WriteIndex = 1 - PublishedIndex.load(std::memory_order_relaxed);
+			Sequences[WriteIndex].store(Sequences[WriteIndex].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			return Buffers[WriteIndex];
+		}
+
+		/** Writer only. Publishes the buffer returned by BeginWrite. */
+		void EndWrite()
+		{
+			const int32 WriteIndex = 1 - PublishedIndex.load(std::memory_order_relaxed);
+			Sequences[WriteIndex].store(Sequences[WriteIndex].load(std::memory_order_relaxed) + 1, std::memory_order_release);
+			PublishedIndex.store(WriteIndex, std::memory_order_release);
+		}
+
+		/**
+		 * Any thread. Calls InReadFunction with the published buffer until it gets a consistent view. The function
+		 * may be called more than once and may see a torn buffer on the calls that are retried, so it must only copy
+		 * out what it needs and must cope with any values (but not sizes) having changed.
+		 */
+		template <typename ReadFunctionType>
+		void Read(ReadFunctionType&& InReadFunction) const
+		{
+			for (;;)
+			{
+				const int32 ReadIndex = PublishedIndex.load(std::memory_order_acquire);
+				const uint32 SequenceBefore = Sequences[ReadIndex].load(std::memory_order_acquire);
+				if ((SequenceBefore & 1) == 0)
+				{
+					InReadFunction(static_cast<const ValueType&>(Buffers[ReadIndex]));
+
+					std::atomic_thread_fence(std::memory_order_acquire);
+					if (Sequences[ReadIndex].load(std::memory_order_relaxed) == SequenceBefore)
+					{
+						return;
+					}
+				}
+				FPlatformProcess::Yield();
+			}
+		}
+
+	private:
+		ValueType Buffers[2];
+		std::atomic<uint32> Sequences[2];
+		std::atomic<int32> PublishedIndex;
+	};
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+namespace Audio
+{
+	/**
+	 * Publishes immutable snapshots from a writer to a single reader without locking the reader.
+	 *
+	 * The writer builds a new snapshot and swaps it in with Publish. The previous snapshot is retired,
+	 * and Reclaim later deletes the retired snapshots on the writer's thread. The reader marks the
+	 * snapshot it uses with a hazard pointer, and Reclaim leaves that one alone, so the reader never
+	 * waits, never allocates and never frees a snapshot.
+	 *
+	 * Writers must be serialized by the caller (Publish, Reclaim and GetLatest are not thread safe
+	 * with respect to each other). Only one thread at a time may read.
+	 */
+	template <typename SnapshotType>
+	class TSnapshotPublisher
+	{
+	public:
+		TSnapshotPublisher()
+			: Current(nullptr)
+			, Hazard(nullptr)
+		{
+		}
+
+		/** The reader must have stopped reading. */
+		~TSnapshotPublisher()
+		{
+			delete Current.load(std::memory_order_relaxed);
+			for (SnapshotType* Snapshot : Retired)
+			{
+				delete Snapshot;
+			}
+		}
+
+		/** Writer only. Takes ownership of the snapshot and retires the previous one. */
+		void Publish(SnapshotType* InSnapshot)
+		{
+			SnapshotType* Previous = Current.exchange(InSnapshot, std::memory_order_seq_cst);
+			if (Previous)
+			{
+				Retired.Add(Previous);
+			}
+
+			Reclaim();
+		}
+
+		/** Writer only. Deletes the retired snapshots the reader is not using. */
+		void Reclaim()
+		{
+			// The reader validates its hazard against Current after publishing it, so a retired
+			// snapshot that isn't its hazard now can't become its hazard later.
+			SnapshotType* InUse = Hazard.load(std::memory_order_seq_cst);
+			for (int32 Index = Retired.Num() - 1; Index >= 0; --Index)
+			{
+				if (Retired[Index] != InUse)
+				{
+					delete Retired[Index];
+					Retired.RemoveAtSwap(Index, 1, false);
+				}
+			}
+		}
+
+		/** Writer only. Returns the latest published snapshot, to build the next one from. */
+		const SnapshotType* GetLatest() const
+		{
+			return Current.load(std::memory_order_relaxed);
+		}
+
+		/** Returns the number of retired snapshots not deleted yet. Writer only. */
+		int32 GetNumRetired() const { return Retired.Num(); }
+
+		/**
+		 * Reader only. Returns the current snapshot, or nullptr if none was published. The snapshot
+		 * stays valid until the next call to Acquire or Release.
+		 */
+		const SnapshotType* Acquire()
+		{
+			SnapshotType* Snapshot = Current.load(std::memory_order_acquire);
+			for (;;)
+			{
+				Hazard.store(Snapshot, std::memory_order_seq_cst);
+
+				SnapshotType* Check = Current.load(std::memory_order_seq_cst);
+				if (Check == Snapshot)
+				{
+					return Snapshot;
+				}
+
+				Snapshot = Check;
+			}
+		}
+
+		/** Reader only. Lets the writer reclaim the snapshot returned by the last Acquire. */
+		void Release()
+		{
+			Hazard.store(nullptr, std::memory_order_release);
+		}
+
+	private:
+		std::atomic<SnapshotType*> Current;
+		std::atomic<SnapshotType*> Hazard;
+
+		/** Retired snapshots awaiting deletion. Writer only. */
+		TArray<SnapshotType*> Retired;
+	};
+}
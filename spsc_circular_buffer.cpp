@@ -0,0 +1,76 @@
+#include "spsc_circular_buffer.h"
+#include "AudioMixerLog.h"
+
+#if PLATFORM_LINUX
+	#include <errno.h>
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+namespace Audio
+{
+	bool FMirroredMemory::IsSupported()
+	{
+		return PLATFORM_LINUX != 0;
+	}
+
+	void* FMirroredMemory::Allocate(SIZE_T& InOutNumBytes)
+	{
+#if PLATFORM_LINUX
+		const SIZE_T PageSize = (SIZE_T)sysconf(_SC_PAGESIZE);
+		SIZE_T NumBytes = PageSize;
+		while (NumBytes < InOutNumBytes)
+		{
+			NumBytes <<= 1;
+		}
+
+		const int32 FileDescriptor = memfd_create("AudioMixerRing", MFD_CLOEXEC);
+		if (FileDescriptor < 0)
+		{
+			UE_LOG(LogAudioMixer, Warning, TEXT("Failed to create the backing file for a mirrored ring buffer (errno %d)."), errno);
+			return nullptr;
+		}
+
+		// Reserve address space for both copies first, so the second mapping can't land on anything else.
+		uint8* Memory = nullptr;
+		if (ftruncate(FileDescriptor, (off_t)NumBytes) == 0)
+		{
+			void* Reserved = mmap(nullptr, NumBytes * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (Reserved != MAP_FAILED)
+			{
+				Memory = static_cast<uint8*>(Reserved);
+				if (mmap(Memory, NumBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, FileDescriptor, 0) == MAP_FAILED
+					|| mmap(Memory + NumBytes, NumBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, FileDescriptor, 0) == MAP_FAILED)
+				{
+					munmap(Memory, NumBytes * 2);
+					Memory = nullptr;
+				}
+			}
+		}
+
+		// The mappings keep the pages alive.
+		close(FileDescriptor);
+
+		if (!Memory)
+		{
+			UE_LOG(LogAudioMixer, Warning, TEXT("Failed to map a mirrored ring buffer of %llu bytes (errno %d)."), (uint64)NumBytes, errno);
+			return nullptr;
+		}
+
+		InOutNumBytes = NumBytes;
+		return Memory;
+#else
+		return nullptr;
+#endif
+	}
+
+	void FMirroredMemory::Free(void* InMemory, SIZE_T NumBytes)
+	{
+#if PLATFORM_LINUX
+		if (InMemory)
+		{
+			munmap(InMemory, NumBytes * 2);
+		}
+#endif
+	}
+}
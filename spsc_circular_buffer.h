@@ -0,0 +1,251 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "circular_buffer.h"
+
+#include <atomic>
+
+namespace Audio
+{
+	/**
+	 * Double-mapped memory for ring buffers: the same physical pages are mapped twice back to back, so any
+	 * span that starts inside the first mapping is contiguous even when it runs past the wrap point.
+	 */
+	struct FMirroredMemory
+	{
+		/** Whether this platform supports mirrored mappings. */
+		static bool IsSupported();
+
+		/**
+		 * Maps a mirrored region. InOutNumBytes is rounded up to a power of two that is at least the page size.
+		 * Returns the start of the first mapping, or nullptr on failure.
+		 */
+		static void* Allocate(SIZE_T& InOutNumBytes);
+
+		/** Unmaps a region returned by Allocate. NumBytes is the size Allocate returned. */
+		static void Free(void* InMemory, SIZE_T NumBytes);
+	};
+
+	/**
+	 * Lock-free single producer, single consumer ring buffer that hands out contiguous spans, so the producer
+	 * can write a block in place and the consumer can read it in place instead of copying through a staging buffer.
+	 *
+	 * Storage is a TCircularBuffer, which rounds the capacity to a power of two and masks indices, or a mirrored
+	 * mapping when one is requested and the platform supports it. The buffer still only holds the capacity that was
+	 * asked for, so the rounding doesn't add latency for producers that fill it until Remainder() runs out. Read and
+	 * write indices run freely and are only masked on access, so Num() is WriteIndex - ReadIndex even after the
+	 * indices wrap around.
+	 *
+	 * Without a mirrored mapping a span stops at the end of the storage, so Acquire* may return fewer
+	 * elements than requested even when enough are available.
+	 */
+	template <typename ElementType>
+	class TSpscCircularBuffer
+	{
+	public:
+		TSpscCircularBuffer()
+			: Data(nullptr)
+			, Capacity(0)
+			, IndexMask(0)
+			, MirroredBytes(0)
+			, ReadIndex(0)
+			, WriteIndex(0)
+		{
+		}
+
+		explicit TSpscCircularBuffer(uint32 InCapacity, bool bInMirrored = false)
+			: TSpscCircularBuffer()
+		{
+			SetCapacity(InCapacity, bInMirrored);
+		}
+
+		~TSpscCircularBuffer()
+		{
+			ReleaseStorage();
+		}
+
+		TSpscCircularBuffer(const TSpscCircularBuffer&) = delete;
+		TSpscCircularBuffer& operator=(const TSpscCircularBuffer&) = delete;
+
+		/**
+		 * Reallocates the storage and empties the buffer. Not thread safe; only call while neither side is running.
+		 *
+		 * @param InCapacity The number of elements the buffer can store. The storage behind it is rounded up to a power of 2.
+		 * @param bInMirrored Whether to back the buffer with a mirrored mapping. Falls back to plain storage when unsupported.
+		 */
+		void SetCapacity(uint32 InCapacity, bool bInMirrored = false)
+		{
+			static_assert((sizeof(ElementType) & (sizeof(ElementType) - 1)) == 0, "Element size must be a power of two so the storage is too.");
+			checkSlow(InCapacity > 0);
+
+			ReleaseStorage();
+
+			if (bInMirrored && FMirroredMemory::IsSupported())
+			{
+				SIZE_T NumBytes = (SIZE_T)FMath::RoundUpToPowerOfTwo(InCapacity) * sizeof(ElementType);
+				Data = static_cast<ElementType*>(FMirroredMemory::Allocate(NumBytes));
+				if (Data)
+				{
+					MirroredBytes = NumBytes;
+					IndexMask = (uint32)(NumBytes / sizeof(ElementType)) - 1;
+				}
+			}
+
+			if (!Data)
+			{
+				Elements = MakeUnique<TCircularBuffer<ElementType>>(InCapacity);
+				Data = &(*Elements)[0];
+				IndexMask = Elements->Capacity() - 1;
+			}
+
+			Capacity = InCapacity;
+			ReadIndex.store(0, std::memory_order_relaxed);
+			WriteIndex.store(0, std::memory_order_relaxed);
+		}
+
+		/** Returns the number of elements the buffer can hold, as passed to SetCapacity. */
+		uint32 GetCapacity() const
+		{
+			return Capacity;
+		}
+
+		/** Whether spans are contiguous across the wrap point. */
+		bool IsMirrored() const
+		{
+			return MirroredBytes > 0;
+		}
+
+		/** Returns the number of elements available to read. */
+		uint32 Num() const
+		{
+			return WriteIndex.load(std::memory_order_acquire) - ReadIndex.load(std::memory_order_acquire);
+		}
+
+		/** Returns the number of elements that can be written. */
+		uint32 Remainder() const
+		{
+			return GetCapacity() - Num();
+		}
+
+		/**
+		 * Producer only. Returns a writable span of at most NumElements, bounded by the free space and, without
+		 * a mirrored mapping, by the end of the storage. Nothing is published until CommitWrite.
+		 */
+		TArrayView<ElementType> AcquireWrite(uint32 NumElements)
+		{
+			const uint32 Write = WriteIndex.load(std::memory_order_relaxed);
+			const uint32 Read = ReadIndex.load(std::memory_order_acquire);
+			const uint32 NumToWrite = FMath::Min(NumElements, GetCapacity() - (Write - Read));
+			return TArrayView<ElementType>(Data + (Write & IndexMask), GetContiguous(Write, NumToWrite));
+		}
+
+		/** Producer only. Publishes NumElements written through the last AcquireWrite. */
+		void CommitWrite(uint32 NumElements)
+		{
+			checkSlow(NumElements <= Remainder());
+			WriteIndex.store(WriteIndex.load(std::memory_order_relaxed) + NumElements, std::memory_order_release);
+		}
+
+		/**
+		 * Consumer only. Returns a readable span of at most NumElements, bounded by the available elements and,
+		 * without a mirrored mapping, by the end of the storage. Nothing is released until CommitRead.
+		 */
+		TArrayView<const ElementType> AcquireRead(uint32 NumElements) const
+		{
+			const uint32 Read = ReadIndex.load(std::memory_order_relaxed);
+			const uint32 Write = WriteIndex.load(std::memory_order_acquire);
+			const uint32 NumToRead = FMath::Min(NumElements, Write - Read);
+			return TArrayView<const ElementType>(Data + (Read & IndexMask), GetContiguous(Read, NumToRead));
+		}
+
+		/** Consumer only. Releases NumElements read through the last AcquireRead back to the producer. */
+		void CommitRead(uint32 NumElements)
+		{
+			checkSlow(NumElements <= Num());
+			ReadIndex.store(ReadIndex.load(std::memory_order_relaxed) + NumElements, std::memory_order_release);
+		}
+
+		/** Producer only. Copies in as many elements as fit and returns how many were pushed. */
+		uint32 Push(const ElementType* InBuffer, uint32 NumElements)
+		{
+			uint32 NumPushed = 0;
+			while (NumPushed < NumElements)
+			{
+				TArrayView<ElementType> Span = AcquireWrite(NumElements - NumPushed);
+				if (Span.Num() == 0)
+				{
+					break;
+				}
+
+				FMemory::Memcpy(Span.GetData(), InBuffer + NumPushed, Span.Num() * sizeof(ElementType));
+				CommitWrite(Span.Num());
+				NumPushed += Span.Num();
+			}
+			return NumPushed;
+		}
+
+		/** Consumer only. Copies out as many elements as are available and returns how many were popped. */
+		uint32 Pop(ElementType* OutBuffer, uint32 NumElements)
+		{
+			uint32 NumPopped = 0;
+			while (NumPopped < NumElements)
+			{
+				TArrayView<const ElementType> Span = AcquireRead(NumElements - NumPopped);
+				if (Span.Num() == 0)
+				{
+					break;
+				}
+
+				FMemory::Memcpy(OutBuffer + NumPopped, Span.GetData(), Span.Num() * sizeof(ElementType));
+				CommitRead(Span.Num());
+				NumPopped += Span.Num();
+			}
+			return NumPopped;
+		}
+
+	private:
+		/** Clamps a span starting at Index to the end of the storage, unless the storage is mirrored. */
+		uint32 GetContiguous(uint32 Index, uint32 NumElements) const
+		{
+			if (IsMirrored())
+			{
+				return NumElements;
+			}
+			return FMath::Min(NumElements, IndexMask + 1 - (Index & IndexMask));
+		}
+
+		void ReleaseStorage()
+		{
+			if (MirroredBytes > 0)
+			{
+				FMirroredMemory::Free(Data, MirroredBytes);
+				MirroredBytes = 0;
+			}
+			Elements.Reset();
+			Data = nullptr;
+			Capacity = 0;
+			IndexMask = 0;
+		}
+
+		/** Plain storage, when not mirrored. */
+		TUniquePtr<TCircularBuffer<ElementType>> Elements;
+
+		/** Start of the storage, plain or mirrored. */
+		ElementType* Data;
+
+		/** Elements the buffer holds, which may be less than the storage. */
+		uint32 Capacity;
+
+		/** Size of the storage - 1; the storage is always a power of two. */
+		uint32 IndexMask;
+
+		/** Size of the first mapping when mirrored, otherwise 0. */
+		SIZE_T MirroredBytes;
+
+		/** Only written by the consumer. Kept on its own cache line so the two sides don't false share. */
+		alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> ReadIndex;
+
+		/** Only written by the producer. */
+		alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> WriteIndex;
+	};
+}